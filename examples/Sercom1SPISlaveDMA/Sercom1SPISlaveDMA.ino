@@ -0,0 +1,64 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave, receives the data with the DMAC into a circular buffer and prints the data received.
+  The CPU is only interrupted when half of the buffer is filled and at the end of each transaction, so the master can use a high SPI clock.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+#define DMA_CHANNEL 0 // DMAC channel used to receive the data
+#define BUFFER_LENGTH 256 // length of the circular buffer, must be even
+
+// initialize variables
+volatile uint8_t buf[BUFFER_LENGTH]; // circular buffer written by the DMAC
+volatile size_t head = 0; // index at which the DMAC writes the next byte
+size_t tail = 0; // index of the next byte to print
+
+void DmaEventReceived(SercomSPISlave::DmaEvent event, size_t position)
+{
+  head = position; // called from interrupt context, so only store the position
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  if (!SPISlave.enableDMA(DMA_CHANNEL, buf, BUFFER_LENGTH, DmaEventReceived))
+  {
+    Serial.println("DMA could not be enabled");
+  }
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  size_t position = head;
+  while (tail != position)
+  {
+    Serial.println(buf[tail]); // Print the data received
+    tail = (tail + 1) % BUFFER_LENGTH;
+  }
+}
@@ -0,0 +1,58 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave that receives the frames into a pool of fixed-size slots, and prints each frame received.
+  Several frames can wait in the pool while one is processed. The memory of the pool is allocated statically, without malloc.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// initialize variables
+SercomSPISlaveFramePoolT<4, 64> pool; // 4 slots of 64 bytes
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enableFramePool(&pool);
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  size_t length;
+  byte* frame = SPISlave.lendFrame(&length); // The oldest frame received, or NULL
+  if (frame != NULL)
+  {
+    Serial.print("Frame of "); Serial.print(length); Serial.println(" bytes:");
+    for (size_t i = 0; i < length; i++)
+    {
+      Serial.println(frame[i]); // Print the data received
+    }
+    SPISlave.returnFrame(frame); // Release the slot, such that a next frame can be received into it
+    Serial.print("Slots used at most: "); Serial.println(pool.HighWaterMark());
+    Serial.print("Frames dropped: "); Serial.println(SPISlave.getStats().frames_dropped);
+  }
+}
@@ -0,0 +1,54 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave and prints each frame received.
+  A frame holds the bytes the master sends from pulling Slave Select low to pulling it high again.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// initialize variables
+byte frame[64]; // initialize a buffer of 64 bytes, to copy each frame to
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enableFraming();
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  while (SPISlave.availableFrames())
+  {
+    size_t length = SPISlave.readFrame(frame, sizeof(frame));
+    Serial.print("Frame of "); Serial.print(length); Serial.println(" bytes:");
+    for (size_t i = 0; (i < length) && (i < sizeof(frame)); i++)
+    {
+      Serial.println(frame[i]); // Print the data received
+    }
+  }
+}
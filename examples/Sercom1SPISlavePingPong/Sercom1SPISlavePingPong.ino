@@ -0,0 +1,59 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave in the ping-pong receive mode, and prints the length and the sum of the bytes of each frame received.
+  The interrupt handler writes each frame straight into one of two buffers, and swaps them when Slave Select goes high. The frames are processed in place, without a copy.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// initialize variables
+byte buffer0[512]; // the two buffers the frames are received into
+byte buffer1[512];
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enablePingPong(buffer0, buffer1, sizeof(buffer0));
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  size_t length;
+  byte* frame = SPISlave.lendFrame(&length);
+  if (frame != NULL)
+  {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+      sum += frame[i]; // Process the frame in place
+    }
+    SPISlave.returnFrame(frame); // Return the buffer, such that the next frame can be received into it
+    Serial.print("Frame of "); Serial.print(length); Serial.print(" bytes, sum "); Serial.println(sum);
+    Serial.print("Frames dropped: "); Serial.println(SPISlave.getStats().frames_dropped);
+  }
+}
@@ -0,0 +1,68 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave as a register map of 16 registers.
+  The master sends a command, with bit 7 set to read and cleared to write, and the address of the first register in bits 6 to 0.
+  It then reads or writes consecutive registers in the same transaction. The slave serves the reads and applies the writes in its interrupt, without code in the loop.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// Registers of the slave
+struct Registers {
+  uint8_t id; // 0x00, read-only
+  uint8_t control; // 0x01, read-write
+  uint8_t setpoint[2]; // 0x02, read-write
+  uint32_t uptime; // 0x04, read-only
+  uint8_t scratch[8]; // 0x08, read-write
+};
+volatile Registers registers = {0x5A, 0, {0, 0}, 0, {0}};
+const uint8_t kWriteMask[sizeof(Registers)] = {0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+volatile bool written = false;
+void RegistersWritten(uint8_t address, uint8_t count) // Called from interrupt context
+{
+  written = true;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enableRegisterMap(&registers, sizeof(Registers), kWriteMask, RegistersWritten);
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  noInterrupts(); // Update the multi-byte register consistently
+  registers.uptime = millis();
+  interrupts();
+  if (written)
+  {
+    written = false;
+    Serial.print("Control: "); Serial.println(registers.control);
+  }
+}
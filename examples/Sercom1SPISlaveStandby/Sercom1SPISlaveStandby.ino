@@ -0,0 +1,51 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave, sleeps in standby until the master sends a frame, and blinks the LED for each frame received.
+  The core wakes when the master pulls Slave Select low, receives the frame, and goes back to standby when Slave Select goes high.
+  Serial over USB does not run in standby, so this example uses the LED instead.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// initialize variables
+byte frame[64]; // initialize a buffer of 64 bytes, to copy each frame to
+
+void setup()
+{
+  pinMode(LED_BUILTIN, OUTPUT);
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enableFraming();
+  SPISlave.enableStandby(SercomSPISlave::kWakeOnSlaveSelect);
+}
+
+void loop()
+{
+  SPISlave.standby(); // Sleep until a transaction ends
+  while (SPISlave.availableFrames())
+  {
+    size_t length = SPISlave.readFrame(frame, sizeof(frame));
+    digitalWrite(LED_BUILTIN, (length > 0) && (frame[0] & 0x1)); // Show the lowest bit of the first byte of the frame
+  }
+}
@@ -0,0 +1,78 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes a SERCOM1 SPI Slave, and prints each frame received with the times at which Slave Select went low and high.
+  The Slave Select edges are captured by TC4 through the Event System, so the timestamps do not depend on the interrupt latency.
+  Every second it prints the histogram of the latency from Slave Select low to the interrupt handler.
+  Connect SS (PA18) also to PA20, which captures the edges.
+*/
+
+#include <SercomSPISlave.h>
+Sercom1SPISlave SPISlave; // to use a different SERCOM, change this line and find and replace all SERCOM1 with the SERCOM of your choice
+
+// initialize variables
+byte frame[64]; // initialize a buffer of 64 bytes, to copy each frame to
+SercomSPISlave::TimestampStorage timestamp_storage; // timestamps of the queued frames and latency histogram
+const uint32_t kTicksPerMicrosecond = F_CPU / 1000000; // TC4 counts at the clock of Generic Clock Generator 0, the CPU clock
+const uint16_t kBinTicks = 8; // width of the bins of the latency histogram
+unsigned long last_print = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  SPISlave.SercomInit(SPISlave.MOSI_Pins::PA16, SPISlave.SCK_Pins::PA17, SPISlave.SS_Pins::PA18, SPISlave.MISO_Pins::PA19);
+  SPISlave.enableFraming();
+  SPISlave.enableTimestamps(SercomPin::PA20, 0, &timestamp_storage, 0, kBinTicks); // capture pin PA20, Event System channel 0, Generic Clock Generator 0
+  Serial.println("SERCOM1 SPI slave initialized");
+}
+
+void loop()
+{
+  while (SPISlave.availableFrames())
+  {
+    size_t length = SPISlave.readFrame(frame, sizeof(frame));
+    SercomSPISlave::Timestamps timestamps = SPISlave.lastFrameTimestamps();
+    Serial.print("Frame of "); Serial.print(length); Serial.print(" bytes");
+    if (timestamps.valid)
+    {
+      Serial.print(", start "); Serial.print(timestamps.start / kTicksPerMicrosecond); Serial.print(" us");
+      Serial.print(", duration "); Serial.print((timestamps.end - timestamps.start) / kTicksPerMicrosecond); Serial.print(" us");
+    }
+    Serial.println();
+  }
+
+  if (millis() - last_print >= 1000)
+  {
+    last_print = millis();
+    SercomSPISlave::Stats stats = SPISlave.getStats();
+    if (stats.latency_count > 0)
+    {
+      Serial.print("Latency in cycles: min "); Serial.print(stats.latency_min); Serial.print(", max "); Serial.println(stats.latency_max);
+      for (uint8_t i = 0; i < SERCOM_SPI_SLAVE_LATENCY_BINS; i++)
+      {
+        Serial.print(i * kBinTicks); Serial.print(": "); Serial.println(timestamp_storage.latency_histogram[i]);
+      }
+    }
+  }
+}
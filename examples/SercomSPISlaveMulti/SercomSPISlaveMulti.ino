@@ -0,0 +1,69 @@
+/*  
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+  Example code for the SercomSPISlave library.
+  This code initializes an SPI slave on each of the four SERCOM left free by the variants of the Arduino Zero and the Arduino MKR boards, and prints the data received by each slave.
+  The pins are selected at compile time, such that a pin that is not connected to the SERCOM does not compile.
+
+  The variant of a board claims the SERCOM of its serial ports: the Arduino Zero uses SERCOM0 for Serial1 and SERCOM5 for the EDBG serial port on PB22 and PB23,
+  the Arduino MKR boards use SERCOM5 for Serial1. Their variants define SERCOM0_Handler and SERCOM5_Handler, which take precedence over the handlers of this library.
+  SERCOM1 to SERCOM4 are free as long as the sketch does not use the SPI and Wire libraries.
+*/
+
+#include <SercomSPISlave.h>
+SercomSPISlaveT<1, SercomPin::PA16, SercomPin::PA17, SercomPin::PA18, SercomPin::PA19> SPISlave1; // MOSI, SCK, SS, MISO
+SercomSPISlaveT<2, SercomPin::PA08, SercomPin::PA09, SercomPin::PA10, SercomPin::PA11> SPISlave2;
+SercomSPISlaveT<3, SercomPin::PA22, SercomPin::PA23, SercomPin::PA20, SercomPin::PA21> SPISlave3;
+SercomSPISlaveT<4, SercomPin::PB08, SercomPin::PB09, SercomPin::PB10, SercomPin::PB11> SPISlave4;
+
+// initialize variables
+byte buf[64]; // initialize a buffer of 64 bytes, to copy the data received to
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("Serial started");
+  bool initialized = SPISlave1.SercomInit();
+  initialized &= SPISlave2.SercomInit();
+  initialized &= SPISlave3.SercomInit();
+  initialized &= SPISlave4.SercomInit();
+  Serial.println(initialized ? "SERCOM1 to SERCOM4 SPI slaves initialized" : "Initialization of the SPI slaves failed");
+}
+
+void loop()
+{
+  // Each slave stores the data received in its own receive buffer. Serve all of them through the table of slaves.
+  for (uint8_t sercom_no = 1; sercom_no <= 4; sercom_no++)
+  {
+    SercomSPISlave* slave = SercomSPISlave::instance(sercom_no);
+    if (slave == NULL)
+    {
+      continue; // SercomInit() failed for this SERCOM
+    }
+    size_t length = slave->read(buf, sizeof(buf));
+    for (size_t i = 0; i < length; i++)
+    {
+      Serial.print("SERCOM"); Serial.print(sercom_no); Serial.print(": ");
+      Serial.println(buf[i]); // Print the data received
+    }
+  }
+}
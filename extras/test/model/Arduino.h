@@ -0,0 +1,74 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Arduino core of the host build in extras/test: the part of the Arduino SAMD core API used by the library, running on the register model in sam.h and sim.h.
+millis() counts the SysTick interrupts of the model, and delay() lets the model run.
+*/
+
+#ifndef ARDUINO_MODEL_H
+#define ARDUINO_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sam.h"
+#include "sim.h"
+
+#define F_CPU 48000000ul
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while ((n < size) && write(buffer[n])) {
+      n++;
+    }
+    return n;
+  }
+  size_t write(const char* str) { return (str == NULL) ? 0 : write((const uint8_t*)str, strlen(str)); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  Stream() : _timeout(1000) {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+ protected:
+  unsigned long _timeout; // Milliseconds to wait for data in readBytes()
+};
+
+#endif
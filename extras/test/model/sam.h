@@ -0,0 +1,725 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Register model of the ATSAMD21 peripherals used by the library, for the host build in extras/test.
+It declares the same types, instances and macros as the CMSIS headers of the Arduino core, such that src/SercomSPISlave.cpp compiles unchanged on Linux.
+Every access to a register goes through sim::RegisterRead() and sim::RegisterWrite(), which apply the side effects of the hardware, see sim.cpp:
+software resets clear themselves, interrupt flags are cleared by writing one, reading DATA clears Receive Complete, and so on.
+The register fields are empty objects overlapping the register at its address, such that a field finds its register from its own address.
+Reference: Atmel-42181G-SAM-D21_Datasheet
+*/
+
+#ifndef SAM_MODEL_H
+#define SAM_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define __I
+#define __O
+#define __IO
+
+namespace sim {
+
+// Peripheral accesses, implemented by the peripheral models in sim.cpp
+uint32_t RegisterRead(const void* reg, uint8_t size); // Value read by the core, with the side effects of a read
+void RegisterWrite(void* reg, uint8_t size, uint32_t value); // Store written by the core, with the side effects of a write
+
+// Value of a register, the reg member of a register. The operands are unsigned long long, as the masks of the macros are unsigned long, which has 64 bits on the host.
+template <typename T>
+class Value {
+ public:
+  operator T() const { return (T)RegisterRead(this, sizeof(T)); }
+  Value& operator=(unsigned long long value) { RegisterWrite(this, sizeof(T), (uint32_t)value); return *this; }
+  Value& operator=(const Value& other) { return *this = (unsigned long long)(T)other; }
+  Value& operator|=(unsigned long long value) { return *this = (T)*this | value; }
+  Value& operator&=(unsigned long long value) { return *this = (T)*this & value; }
+  Value& operator^=(unsigned long long value) { return *this = (T)*this ^ value; }
+};
+
+// Bit field of a register. A write is a read-modify-write of the register, as on the hardware.
+template <typename T, unsigned kPos, unsigned kWidth>
+class Field {
+ public:
+  operator T() const { return (T)((RegisterRead(this, sizeof(T)) >> kPos) & kMask); }
+  Field& operator=(unsigned long long value) {
+    uint32_t reg = RegisterRead(this, sizeof(T));
+    RegisterWrite(this, sizeof(T), (reg & ~(kMask << kPos)) | ((value & kMask) << kPos));
+    return *this;
+  }
+  Field& operator=(const Field& other) { return *this = (uint32_t)(T)other; }
+
+ private:
+  static const uint32_t kMask = (kWidth >= 32) ? 0xFFFFFFFF : ((1u << kWidth) - 1);
+};
+
+// Register with the fields of Bits. sim_raw is the stored value, accessed by the peripheral models and by the tests without side effects.
+template <typename T, typename Bits>
+union Register {
+  Bits bit;
+  Value<T> reg;
+  T sim_raw;
+};
+
+// Register without fields
+template <typename T>
+union Plain {
+  Value<T> reg;
+  T sim_raw;
+};
+
+// Register of the core, accessed without .reg as in the CMSIS core headers
+template <typename T>
+union Core {
+  Value<T> value;
+  T sim_raw;
+  operator T() const { return value; }
+  Core& operator=(unsigned long long v) { value = v; return *this; }
+  Core& operator|=(unsigned long long v) { value |= v; return *this; }
+  Core& operator&=(unsigned long long v) { value &= v; return *this; }
+};
+
+} // namespace sim
+
+#define SIM_FIELD(type, name, pos, width) [[no_unique_address]] sim::Field<type, pos, width> name
+
+// Core //
+
+typedef enum IRQn {
+  NonMaskableInt_IRQn = -14,
+  HardFault_IRQn = -13,
+  SVCall_IRQn = -5,
+  PendSV_IRQn = -2,
+  SysTick_IRQn = -1,
+  PM_IRQn = 0,
+  SYSCTRL_IRQn = 1,
+  WDT_IRQn = 2,
+  RTC_IRQn = 3,
+  EIC_IRQn = 4,
+  NVMCTRL_IRQn = 5,
+  DMAC_IRQn = 6,
+  USB_IRQn = 7,
+  EVSYS_IRQn = 8,
+  SERCOM0_IRQn = 9,
+  SERCOM1_IRQn = 10,
+  SERCOM2_IRQn = 11,
+  SERCOM3_IRQn = 12,
+  SERCOM4_IRQn = 13,
+  SERCOM5_IRQn = 14,
+  TCC0_IRQn = 15,
+  TCC1_IRQn = 16,
+  TCC2_IRQn = 17,
+  TC3_IRQn = 18,
+  TC4_IRQn = 19,
+  TC5_IRQn = 20,
+  TC6_IRQn = 21,
+  TC7_IRQn = 22,
+  ADC_IRQn = 23,
+  AC_IRQn = 24,
+  DAC_IRQn = 25,
+  PTC_IRQn = 26,
+  I2S_IRQn = 27,
+  PERIPH_COUNT_IRQn = 28
+} IRQn_Type;
+
+#define __NVIC_PRIO_BITS 2
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+uint32_t NVIC_GetPriority(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+
+void __enable_irq();
+void __disable_irq();
+uint32_t __get_PRIMASK();
+void __set_PRIMASK(uint32_t primask);
+void __WFI();
+inline void __DMB() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+inline void __DSB() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+inline void __ISB() {}
+
+typedef struct {
+  __I uint32_t CPUID;
+  __IO uint32_t ICSR;
+  __IO uint32_t VTOR;
+  __IO uint32_t AIRCR;
+  __IO uint32_t SCR;
+  __IO uint32_t CCR;
+  uint32_t RESERVED1;
+  __IO uint32_t SHP[2];
+  __IO uint32_t SHCSR;
+} SCB_Type;
+
+#define SCB_SCR_SLEEPDEEP_Pos 2
+#define SCB_SCR_SLEEPDEEP_Msk (1ul << SCB_SCR_SLEEPDEEP_Pos)
+#define SCB_VTOR_TBLOFF_Pos 7
+#define SCB_VTOR_TBLOFF_Msk (0x1FFFFFFul << SCB_VTOR_TBLOFF_Pos)
+
+typedef struct {
+  sim::Core<uint32_t> CTRL;
+  sim::Core<uint32_t> LOAD;
+  sim::Core<uint32_t> VAL; // Counts down at the CPU clock in the model
+  sim::Core<uint32_t> CALIB;
+} SysTick_Type;
+
+// SERCOM SPI //
+
+struct SERCOM_SPI_CTRLA_Bits {
+  SIM_FIELD(uint32_t, SWRST, 0, 1);
+  SIM_FIELD(uint32_t, ENABLE, 1, 1);
+  SIM_FIELD(uint32_t, MODE, 2, 3);
+  SIM_FIELD(uint32_t, RUNSTDBY, 7, 1);
+  SIM_FIELD(uint32_t, IBON, 8, 1);
+  SIM_FIELD(uint32_t, DOPO, 16, 2);
+  SIM_FIELD(uint32_t, DIPO, 20, 2);
+  SIM_FIELD(uint32_t, FORM, 24, 4);
+  SIM_FIELD(uint32_t, CPHA, 28, 1);
+  SIM_FIELD(uint32_t, CPOL, 29, 1);
+  SIM_FIELD(uint32_t, DORD, 30, 1);
+};
+struct SERCOM_SPI_CTRLB_Bits {
+  SIM_FIELD(uint32_t, CHSIZE, 0, 3);
+  SIM_FIELD(uint32_t, PLOADEN, 6, 1);
+  SIM_FIELD(uint32_t, SSDE, 9, 1);
+  SIM_FIELD(uint32_t, MSSEN, 13, 1);
+  SIM_FIELD(uint32_t, AMODE, 14, 2);
+  SIM_FIELD(uint32_t, RXEN, 17, 1);
+};
+struct SERCOM_SPI_INT_Bits {
+  SIM_FIELD(uint8_t, DRE, 0, 1);
+  SIM_FIELD(uint8_t, TXC, 1, 1);
+  SIM_FIELD(uint8_t, RXC, 2, 1);
+  SIM_FIELD(uint8_t, SSL, 3, 1);
+  SIM_FIELD(uint8_t, ERROR, 7, 1);
+};
+struct SERCOM_SPI_STATUS_Bits {
+  SIM_FIELD(uint16_t, BUFOVF, 2, 1);
+};
+struct SERCOM_SPI_SYNCBUSY_Bits {
+  SIM_FIELD(uint32_t, SWRST, 0, 1);
+  SIM_FIELD(uint32_t, ENABLE, 1, 1);
+  SIM_FIELD(uint32_t, CTRLB, 2, 1);
+};
+struct SERCOM_SPI_DATA_Bits {
+  SIM_FIELD(uint32_t, DATA, 0, 9);
+};
+
+typedef sim::Register<uint32_t, SERCOM_SPI_CTRLA_Bits> SERCOM_SPI_CTRLA_Type;
+typedef sim::Register<uint32_t, SERCOM_SPI_CTRLB_Bits> SERCOM_SPI_CTRLB_Type;
+typedef sim::Register<uint8_t, SERCOM_SPI_INT_Bits> SERCOM_SPI_INTENCLR_Type;
+typedef sim::Register<uint8_t, SERCOM_SPI_INT_Bits> SERCOM_SPI_INTENSET_Type;
+typedef sim::Register<uint8_t, SERCOM_SPI_INT_Bits> SERCOM_SPI_INTFLAG_Type;
+typedef sim::Register<uint16_t, SERCOM_SPI_STATUS_Bits> SERCOM_SPI_STATUS_Type;
+typedef sim::Register<uint32_t, SERCOM_SPI_SYNCBUSY_Bits> SERCOM_SPI_SYNCBUSY_Type;
+typedef sim::Register<uint32_t, SERCOM_SPI_DATA_Bits> SERCOM_SPI_DATA_Type;
+
+typedef struct {
+  __IO SERCOM_SPI_CTRLA_Type CTRLA; // Offset 0x00
+  __IO SERCOM_SPI_CTRLB_Type CTRLB; // Offset 0x04
+  uint8_t Reserved1[4];
+  __IO sim::Plain<uint8_t> BAUD; // Offset 0x0C
+  uint8_t Reserved2[7];
+  __IO SERCOM_SPI_INTENCLR_Type INTENCLR; // Offset 0x14
+  uint8_t Reserved3[1];
+  __IO SERCOM_SPI_INTENSET_Type INTENSET; // Offset 0x16
+  uint8_t Reserved4[1];
+  __IO SERCOM_SPI_INTFLAG_Type INTFLAG; // Offset 0x18
+  uint8_t Reserved5[1];
+  __IO SERCOM_SPI_STATUS_Type STATUS; // Offset 0x1A
+  __I SERCOM_SPI_SYNCBUSY_Type SYNCBUSY; // Offset 0x1C
+  uint8_t Reserved6[4];
+  __IO sim::Plain<uint32_t> ADDR; // Offset 0x24
+  __IO SERCOM_SPI_DATA_Type DATA; // Offset 0x28
+  uint8_t Reserved7[4];
+  __IO sim::Plain<uint8_t> DBGCTRL; // Offset 0x30
+  uint8_t Reserved8[15];
+} SercomSpi;
+
+typedef union {
+  SercomSpi SPI;
+} Sercom;
+
+static_assert(sizeof(SercomSpi) == 0x40, "The register layout of the SERCOM model does not match the datasheet.");
+
+#define SERCOM_SPI_CTRLA_SWRST (0x1ul << 0)
+#define SERCOM_SPI_CTRLA_ENABLE (0x1ul << 1)
+#define SERCOM_SPI_CTRLA_MODE_Pos 2
+#define SERCOM_SPI_CTRLA_MODE_Msk (0x7ul << SERCOM_SPI_CTRLA_MODE_Pos)
+#define SERCOM_SPI_CTRLA_MODE(value) (SERCOM_SPI_CTRLA_MODE_Msk & ((value) << SERCOM_SPI_CTRLA_MODE_Pos))
+#define SERCOM_SPI_CTRLA_RUNSTDBY (0x1ul << 7)
+#define SERCOM_SPI_CTRLA_IBON (0x1ul << 8)
+#define SERCOM_SPI_CTRLA_DOPO_Pos 16
+#define SERCOM_SPI_CTRLA_DOPO_Msk (0x3ul << SERCOM_SPI_CTRLA_DOPO_Pos)
+#define SERCOM_SPI_CTRLA_DOPO(value) (SERCOM_SPI_CTRLA_DOPO_Msk & ((value) << SERCOM_SPI_CTRLA_DOPO_Pos))
+#define SERCOM_SPI_CTRLA_DIPO_Pos 20
+#define SERCOM_SPI_CTRLA_DIPO_Msk (0x3ul << SERCOM_SPI_CTRLA_DIPO_Pos)
+#define SERCOM_SPI_CTRLA_DIPO(value) (SERCOM_SPI_CTRLA_DIPO_Msk & ((value) << SERCOM_SPI_CTRLA_DIPO_Pos))
+#define SERCOM_SPI_CTRLA_FORM_Pos 24
+#define SERCOM_SPI_CTRLA_FORM_Msk (0xFul << SERCOM_SPI_CTRLA_FORM_Pos)
+#define SERCOM_SPI_CTRLA_CPHA (0x1ul << 28)
+#define SERCOM_SPI_CTRLA_CPOL (0x1ul << 29)
+#define SERCOM_SPI_CTRLA_DORD (0x1ul << 30)
+#define SERCOM_SPI_CTRLB_CHSIZE_Pos 0
+#define SERCOM_SPI_CTRLB_CHSIZE_Msk (0x7ul << SERCOM_SPI_CTRLB_CHSIZE_Pos)
+#define SERCOM_SPI_CTRLB_CHSIZE(value) (SERCOM_SPI_CTRLB_CHSIZE_Msk & ((value) << SERCOM_SPI_CTRLB_CHSIZE_Pos))
+#define SERCOM_SPI_CTRLB_PLOADEN (0x1ul << 6)
+#define SERCOM_SPI_CTRLB_SSDE (0x1ul << 9)
+#define SERCOM_SPI_CTRLB_MSSEN (0x1ul << 13)
+#define SERCOM_SPI_CTRLB_RXEN (0x1ul << 17)
+#define SERCOM_SPI_INTENCLR_DRE (0x1ul << 0)
+#define SERCOM_SPI_INTENCLR_TXC (0x1ul << 1)
+#define SERCOM_SPI_INTENCLR_RXC (0x1ul << 2)
+#define SERCOM_SPI_INTENCLR_SSL (0x1ul << 3)
+#define SERCOM_SPI_INTENCLR_ERROR (0x1ul << 7)
+#define SERCOM_SPI_INTENSET_DRE (0x1ul << 0)
+#define SERCOM_SPI_INTENSET_TXC (0x1ul << 1)
+#define SERCOM_SPI_INTENSET_RXC (0x1ul << 2)
+#define SERCOM_SPI_INTENSET_SSL (0x1ul << 3)
+#define SERCOM_SPI_INTENSET_ERROR (0x1ul << 7)
+#define SERCOM_SPI_INTFLAG_DRE (0x1ul << 0)
+#define SERCOM_SPI_INTFLAG_TXC (0x1ul << 1)
+#define SERCOM_SPI_INTFLAG_RXC (0x1ul << 2)
+#define SERCOM_SPI_INTFLAG_SSL (0x1ul << 3)
+#define SERCOM_SPI_INTFLAG_ERROR (0x1ul << 7)
+#define SERCOM_SPI_STATUS_BUFOVF (0x1ul << 2)
+
+#define SERCOM_INST_NUM 6
+#define SERCOM0_DMAC_ID_RX 0x01 // The trigger sources of SERCOM0 to SERCOM5 are consecutive, RX and TX alternating
+#define SERCOM0_DMAC_ID_TX 0x02
+
+// PORT //
+
+struct PORT_PMUX_Bits {
+  SIM_FIELD(uint8_t, PMUXE, 0, 4);
+  SIM_FIELD(uint8_t, PMUXO, 4, 4);
+};
+struct PORT_PINCFG_Bits {
+  SIM_FIELD(uint8_t, PMUXEN, 0, 1);
+  SIM_FIELD(uint8_t, INEN, 1, 1);
+  SIM_FIELD(uint8_t, PULLEN, 2, 1);
+  SIM_FIELD(uint8_t, DRVSTR, 6, 1);
+};
+typedef sim::Register<uint8_t, PORT_PMUX_Bits> PORT_PMUX_Type;
+typedef sim::Register<uint8_t, PORT_PINCFG_Bits> PORT_PINCFG_Type;
+
+typedef struct {
+  __IO sim::Plain<uint32_t> DIR; // Offset 0x00
+  __IO sim::Plain<uint32_t> DIRCLR;
+  __IO sim::Plain<uint32_t> DIRSET;
+  __IO sim::Plain<uint32_t> DIRTGL;
+  __IO sim::Plain<uint32_t> OUT;
+  __IO sim::Plain<uint32_t> OUTCLR;
+  __IO sim::Plain<uint32_t> OUTSET;
+  __IO sim::Plain<uint32_t> OUTTGL;
+  __I sim::Plain<uint32_t> IN;
+  __IO sim::Plain<uint32_t> CTRL;
+  __O sim::Plain<uint32_t> WRCONFIG;
+  uint8_t Reserved1[4];
+  __IO PORT_PMUX_Type PMUX[16]; // Offset 0x30
+  __IO PORT_PINCFG_Type PINCFG[32]; // Offset 0x40
+  uint8_t Reserved2[32];
+} PortGroup;
+
+typedef struct {
+  PortGroup Group[2];
+} Port;
+
+static_assert(sizeof(PortGroup) == 0x80, "The register layout of the PORT model does not match the datasheet.");
+
+#define PORT_PINCFG_PMUXEN (0x1ul << 0)
+#define PORT_PINCFG_INEN (0x1ul << 1)
+#define PORT_PINCFG_PULLEN (0x1ul << 2)
+#define PORT_PMUX_PMUXE_Msk (0xFul << 0)
+#define PORT_PMUX_PMUXO_Pos 4
+#define PORT_PMUX_PMUXO_Msk (0xFul << PORT_PMUX_PMUXO_Pos)
+
+// GCLK //
+
+struct GCLK_STATUS_Bits {
+  SIM_FIELD(uint8_t, SYNCBUSY, 7, 1);
+};
+struct GCLK_CLKCTRL_Bits {
+  SIM_FIELD(uint16_t, ID, 0, 6);
+  SIM_FIELD(uint16_t, GEN, 8, 4);
+  SIM_FIELD(uint16_t, CLKEN, 14, 1);
+  SIM_FIELD(uint16_t, WRTLOCK, 15, 1);
+};
+
+typedef struct {
+  __IO sim::Plain<uint8_t> CTRL; // Offset 0x0
+  __I sim::Register<uint8_t, GCLK_STATUS_Bits> STATUS; // Offset 0x1
+  __IO sim::Register<uint16_t, GCLK_CLKCTRL_Bits> CLKCTRL; // Offset 0x2
+  __IO sim::Plain<uint32_t> GENCTRL; // Offset 0x4
+  __IO sim::Plain<uint32_t> GENDIV; // Offset 0x8
+} Gclk;
+
+#define GCLK_STATUS_SYNCBUSY (0x1ul << 7)
+#define GCLK_CLKCTRL_ID_Pos 0
+#define GCLK_CLKCTRL_ID_Msk (0x3Ful << GCLK_CLKCTRL_ID_Pos)
+#define GCLK_CLKCTRL_ID(value) (GCLK_CLKCTRL_ID_Msk & ((value) << GCLK_CLKCTRL_ID_Pos))
+#define GCLK_CLKCTRL_GEN_Pos 8
+#define GCLK_CLKCTRL_GEN_Msk (0xFul << GCLK_CLKCTRL_GEN_Pos)
+#define GCLK_CLKCTRL_GEN(value) (GCLK_CLKCTRL_GEN_Msk & ((value) << GCLK_CLKCTRL_GEN_Pos))
+#define GCLK_CLKCTRL_GEN_GCLK0 GCLK_CLKCTRL_GEN(0)
+#define GCLK_CLKCTRL_CLKEN (0x1ul << 14)
+#define GCLK_GEN_NUM 9
+#define GCM_EIC 0x05
+#define GCM_SERCOM0_CORE 0x14 // The Generic Clock IDs of SERCOM0 to SERCOM5 are consecutive
+#define GCM_TC4_TC5 0x1C
+
+// PM //
+
+typedef struct {
+  __IO sim::Plain<uint8_t> CTRL; // Offset 0x00
+  __IO sim::Plain<uint8_t> SLEEP; // Offset 0x01
+  uint8_t Reserved1[6];
+  __IO sim::Plain<uint8_t> CPUSEL; // Offset 0x08
+  __IO sim::Plain<uint8_t> APBASEL;
+  __IO sim::Plain<uint8_t> APBBSEL;
+  __IO sim::Plain<uint8_t> APBCSEL;
+  uint8_t Reserved2[8];
+  __IO sim::Plain<uint32_t> AHBMASK; // Offset 0x14
+  __IO sim::Plain<uint32_t> APBAMASK; // Offset 0x18
+  __IO sim::Plain<uint32_t> APBBMASK; // Offset 0x1C
+  __IO sim::Plain<uint32_t> APBCMASK; // Offset 0x20
+} Pm;
+
+#define PM_AHBMASK_DMAC (0x1ul << 5)
+#define PM_APBAMASK_EIC (0x1ul << 6)
+#define PM_APBBMASK_DMAC (0x1ul << 4)
+#define PM_APBCMASK_EVSYS (0x1ul << 1)
+#define PM_APBCMASK_SERCOM0 (0x1ul << 2)
+#define PM_APBCMASK_TC4 (0x1ul << 12)
+#define PM_APBCMASK_TC5 (0x1ul << 13)
+
+// NVMCTRL //
+
+struct NVMCTRL_CTRLB_Bits {
+  SIM_FIELD(uint32_t, RWS, 1, 4);
+  SIM_FIELD(uint32_t, MANW, 7, 1);
+  SIM_FIELD(uint32_t, SLEEPPRM, 8, 2);
+  SIM_FIELD(uint32_t, READMODE, 16, 2);
+  SIM_FIELD(uint32_t, CACHEDIS, 18, 1);
+};
+
+typedef struct {
+  __IO sim::Plain<uint16_t> CTRLA; // Offset 0x00
+  uint8_t Reserved1[2];
+  __IO sim::Register<uint32_t, NVMCTRL_CTRLB_Bits> CTRLB; // Offset 0x04
+} Nvmctrl;
+
+#define NVMCTRL_CTRLB_SLEEPPRM_DISABLED_Val 0x3ul
+
+// DMAC //
+
+struct DMAC_CTRL_Bits {
+  SIM_FIELD(uint16_t, SWRST, 0, 1);
+  SIM_FIELD(uint16_t, DMAENABLE, 1, 1);
+  SIM_FIELD(uint16_t, CRCENABLE, 2, 1);
+  SIM_FIELD(uint16_t, LVLEN, 8, 4);
+};
+struct DMAC_CHCTRLA_Bits {
+  SIM_FIELD(uint8_t, SWRST, 0, 1);
+  SIM_FIELD(uint8_t, ENABLE, 1, 1);
+  SIM_FIELD(uint8_t, RUNSTDBY, 6, 1);
+};
+struct DMAC_CHCTRLB_Bits {
+  SIM_FIELD(uint32_t, EVACT, 0, 3);
+  SIM_FIELD(uint32_t, EVIE, 3, 1);
+  SIM_FIELD(uint32_t, EVOE, 4, 1);
+  SIM_FIELD(uint32_t, LVL, 5, 2);
+  SIM_FIELD(uint32_t, TRIGSRC, 8, 6);
+  SIM_FIELD(uint32_t, TRIGACT, 22, 2);
+  SIM_FIELD(uint32_t, CMD, 24, 2);
+};
+struct DMAC_CHINT_Bits {
+  SIM_FIELD(uint8_t, TERR, 0, 1);
+  SIM_FIELD(uint8_t, TCMPL, 1, 1);
+  SIM_FIELD(uint8_t, SUSP, 2, 1);
+};
+struct DMAC_BTCTRL_Bits {
+  SIM_FIELD(uint16_t, VALID, 0, 1);
+  SIM_FIELD(uint16_t, EVOSEL, 1, 2);
+  SIM_FIELD(uint16_t, BLOCKACT, 3, 2);
+  SIM_FIELD(uint16_t, BEATSIZE, 8, 2);
+  SIM_FIELD(uint16_t, SRCINC, 10, 1);
+  SIM_FIELD(uint16_t, DSTINC, 11, 1);
+  SIM_FIELD(uint16_t, STEPSEL, 12, 1);
+  SIM_FIELD(uint16_t, STEPSIZE, 13, 3);
+};
+
+typedef struct {
+  __IO sim::Register<uint16_t, DMAC_CTRL_Bits> CTRL; // Offset 0x00
+  __IO sim::Plain<uint16_t> CRCCTRL; // Offset 0x02
+  __IO sim::Plain<uint32_t> CRCDATAIN; // Offset 0x04
+  __IO sim::Plain<uint32_t> CRCCHKSUM; // Offset 0x08
+  __IO sim::Plain<uint8_t> CRCSTATUS; // Offset 0x0C
+  __IO sim::Plain<uint8_t> DBGCTRL; // Offset 0x0D
+  __IO sim::Plain<uint8_t> QOSCTRL; // Offset 0x0E
+  uint8_t Reserved1[1];
+  __IO sim::Plain<uint32_t> SWTRIGCTRL; // Offset 0x10
+  __IO sim::Plain<uint32_t> PRICTRL0; // Offset 0x14
+  uint8_t Reserved2[8];
+  __IO sim::Plain<uint16_t> INTPEND; // Offset 0x20
+  uint8_t Reserved3[2];
+  __I sim::Plain<uint32_t> INTSTATUS; // Offset 0x24
+  __I sim::Plain<uint32_t> BUSYCH; // Offset 0x28
+  __I sim::Plain<uint32_t> PENDCH; // Offset 0x2C
+  __I sim::Plain<uint32_t> ACTIVE; // Offset 0x30
+  __IO sim::Plain<uint32_t> BASEADDR; // Offset 0x34
+  __IO sim::Plain<uint32_t> WRBADDR; // Offset 0x38
+  uint8_t Reserved4[3];
+  __IO sim::Plain<uint8_t> CHID; // Offset 0x3F
+  __IO sim::Register<uint8_t, DMAC_CHCTRLA_Bits> CHCTRLA; // Offset 0x40
+  uint8_t Reserved5[3];
+  __IO sim::Register<uint32_t, DMAC_CHCTRLB_Bits> CHCTRLB; // Offset 0x44
+  uint8_t Reserved6[4];
+  __IO sim::Register<uint8_t, DMAC_CHINT_Bits> CHINTENCLR; // Offset 0x4C
+  __IO sim::Register<uint8_t, DMAC_CHINT_Bits> CHINTENSET; // Offset 0x4D
+  __IO sim::Register<uint8_t, DMAC_CHINT_Bits> CHINTFLAG; // Offset 0x4E
+  __I sim::Plain<uint8_t> CHSTATUS; // Offset 0x4F
+} Dmac;
+
+typedef struct {
+  __IO sim::Register<uint16_t, DMAC_BTCTRL_Bits> BTCTRL;
+  __IO sim::Plain<uint16_t> BTCNT;
+  __IO sim::Plain<uint32_t> SRCADDR;
+  __IO sim::Plain<uint32_t> DSTADDR;
+  __IO sim::Plain<uint32_t> DESCADDR;
+} DmacDescriptor;
+
+static_assert(sizeof(Dmac) == 0x50, "The register layout of the DMAC model does not match the datasheet.");
+static_assert(sizeof(DmacDescriptor) == 16, "A DMAC descriptor takes 16 bytes.");
+
+#define DMAC_CH_NUM 12
+#define DMAC_CTRL_SWRST (0x1ul << 0)
+#define DMAC_CTRL_DMAENABLE (0x1ul << 1)
+#define DMAC_CTRL_CRCENABLE (0x1ul << 2)
+#define DMAC_CTRL_LVLEN(value) (0xF00ul & ((value) << 8))
+#define DMAC_CRCCTRL_CRCBEATSIZE_BYTE (0x0ul << 0)
+#define DMAC_CRCCTRL_CRCPOLY_CRC16 (0x0ul << 2)
+#define DMAC_CRCCTRL_CRCPOLY_CRC32 (0x1ul << 2)
+#define DMAC_CRCCTRL_CRCPOLY_Msk (0x3ul << 2)
+#define DMAC_CRCCTRL_CRCSRC_Pos 8
+#define DMAC_CRCCTRL_CRCSRC_Msk (0x3Ful << DMAC_CRCCTRL_CRCSRC_Pos)
+#define DMAC_CRCCTRL_CRCSRC(value) (0x3F00ul & ((value) << 8))
+#define DMAC_CHID_ID(value) (0xFul & (value))
+#define DMAC_CHCTRLA_SWRST (0x1ul << 0)
+#define DMAC_CHCTRLA_ENABLE (0x1ul << 1)
+#define DMAC_CHCTRLA_RUNSTDBY (0x1ul << 6)
+#define DMAC_CHCTRLB_LVL_Pos 5
+#define DMAC_CHCTRLB_LVL(value) (0x60ul & ((value) << DMAC_CHCTRLB_LVL_Pos))
+#define DMAC_CHCTRLB_TRIGSRC_Pos 8
+#define DMAC_CHCTRLB_TRIGSRC_Msk (0x3Ful << DMAC_CHCTRLB_TRIGSRC_Pos)
+#define DMAC_CHCTRLB_TRIGSRC(value) (DMAC_CHCTRLB_TRIGSRC_Msk & ((value) << DMAC_CHCTRLB_TRIGSRC_Pos))
+#define DMAC_CHCTRLB_TRIGACT_Pos 22
+#define DMAC_CHCTRLB_TRIGACT_Msk (0x3ul << DMAC_CHCTRLB_TRIGACT_Pos)
+#define DMAC_CHCTRLB_TRIGACT_BLOCK (0x0ul << DMAC_CHCTRLB_TRIGACT_Pos)
+#define DMAC_CHCTRLB_TRIGACT_BEAT (0x2ul << DMAC_CHCTRLB_TRIGACT_Pos)
+#define DMAC_CHCTRLB_TRIGACT_TRANSACTION (0x3ul << DMAC_CHCTRLB_TRIGACT_Pos)
+#define DMAC_CHCTRLB_CMD_Pos 24
+#define DMAC_CHCTRLB_CMD_Msk (0x3ul << DMAC_CHCTRLB_CMD_Pos)
+#define DMAC_CHCTRLB_CMD_NOACT_Val 0x0ul
+#define DMAC_CHCTRLB_CMD_SUSPEND_Val 0x1ul
+#define DMAC_CHCTRLB_CMD_RESUME_Val 0x2ul
+#define DMAC_CHINTENCLR_TERR (0x1ul << 0)
+#define DMAC_CHINTENCLR_TCMPL (0x1ul << 1)
+#define DMAC_CHINTENCLR_SUSP (0x1ul << 2)
+#define DMAC_CHINTENSET_TERR (0x1ul << 0)
+#define DMAC_CHINTENSET_TCMPL (0x1ul << 1)
+#define DMAC_CHINTENSET_SUSP (0x1ul << 2)
+#define DMAC_CHINTFLAG_TERR (0x1ul << 0)
+#define DMAC_CHINTFLAG_TCMPL (0x1ul << 1)
+#define DMAC_CHINTFLAG_SUSP (0x1ul << 2)
+#define DMAC_BTCTRL_VALID (0x1ul << 0)
+#define DMAC_BTCTRL_BLOCKACT_Pos 3
+#define DMAC_BTCTRL_BLOCKACT_Msk (0x3ul << DMAC_BTCTRL_BLOCKACT_Pos)
+#define DMAC_BTCTRL_BLOCKACT_NOACT (0x0ul << DMAC_BTCTRL_BLOCKACT_Pos)
+#define DMAC_BTCTRL_BLOCKACT_INT (0x1ul << DMAC_BTCTRL_BLOCKACT_Pos)
+#define DMAC_BTCTRL_BLOCKACT_SUSPEND (0x2ul << DMAC_BTCTRL_BLOCKACT_Pos)
+#define DMAC_BTCTRL_BLOCKACT_BOTH (0x3ul << DMAC_BTCTRL_BLOCKACT_Pos)
+#define DMAC_BTCTRL_BEATSIZE_Pos 8
+#define DMAC_BTCTRL_BEATSIZE_Msk (0x3ul << DMAC_BTCTRL_BEATSIZE_Pos)
+#define DMAC_BTCTRL_BEATSIZE_BYTE (0x0ul << DMAC_BTCTRL_BEATSIZE_Pos)
+#define DMAC_BTCTRL_BEATSIZE_HWORD (0x1ul << DMAC_BTCTRL_BEATSIZE_Pos)
+#define DMAC_BTCTRL_BEATSIZE_WORD (0x2ul << DMAC_BTCTRL_BEATSIZE_Pos)
+#define DMAC_BTCTRL_SRCINC (0x1ul << 10)
+#define DMAC_BTCTRL_DSTINC (0x1ul << 11)
+
+// TC //
+
+struct TC_CTRLA_Bits {
+  SIM_FIELD(uint16_t, SWRST, 0, 1);
+  SIM_FIELD(uint16_t, ENABLE, 1, 1);
+  SIM_FIELD(uint16_t, MODE, 2, 2);
+  SIM_FIELD(uint16_t, WAVEGEN, 5, 2);
+  SIM_FIELD(uint16_t, PRESCALER, 8, 3);
+  SIM_FIELD(uint16_t, RUNSTDBY, 11, 1);
+  SIM_FIELD(uint16_t, PRESCSYNC, 12, 2);
+};
+struct TC_CTRLC_Bits {
+  SIM_FIELD(uint8_t, INVEN0, 0, 1);
+  SIM_FIELD(uint8_t, INVEN1, 1, 1);
+  SIM_FIELD(uint8_t, CPTEN0, 4, 1);
+  SIM_FIELD(uint8_t, CPTEN1, 5, 1);
+};
+struct TC_INTFLAG_Bits {
+  SIM_FIELD(uint8_t, OVF, 0, 1);
+  SIM_FIELD(uint8_t, ERR, 1, 1);
+  SIM_FIELD(uint8_t, SYNCRDY, 3, 1);
+  SIM_FIELD(uint8_t, MC0, 4, 1);
+  SIM_FIELD(uint8_t, MC1, 5, 1);
+};
+struct TC_STATUS_Bits {
+  SIM_FIELD(uint8_t, STOP, 3, 1);
+  SIM_FIELD(uint8_t, SLAVE, 4, 1);
+  SIM_FIELD(uint8_t, SYNCBUSY, 7, 1);
+};
+
+typedef struct {
+  __IO sim::Register<uint16_t, TC_CTRLA_Bits> CTRLA; // Offset 0x00
+  __IO sim::Plain<uint16_t> READREQ; // Offset 0x02
+  __IO sim::Plain<uint8_t> CTRLBCLR; // Offset 0x04
+  __IO sim::Plain<uint8_t> CTRLBSET; // Offset 0x05
+  __IO sim::Register<uint8_t, TC_CTRLC_Bits> CTRLC; // Offset 0x06
+  uint8_t Reserved1[1];
+  __IO sim::Plain<uint8_t> DBGCTRL; // Offset 0x08
+  uint8_t Reserved2[1];
+  __IO sim::Plain<uint16_t> EVCTRL; // Offset 0x0A
+  __IO sim::Plain<uint8_t> INTENCLR; // Offset 0x0C
+  __IO sim::Plain<uint8_t> INTENSET; // Offset 0x0D
+  __IO sim::Register<uint8_t, TC_INTFLAG_Bits> INTFLAG; // Offset 0x0E
+  __I sim::Register<uint8_t, TC_STATUS_Bits> STATUS; // Offset 0x0F
+  __IO sim::Plain<uint32_t> COUNT; // Offset 0x10
+  uint8_t Reserved3[4];
+  __IO sim::Plain<uint32_t> CC[2]; // Offset 0x18
+} TcCount32;
+
+typedef union {
+  TcCount32 COUNT32;
+} Tc;
+
+#define TC_CTRLA_SWRST (0x1ul << 0)
+#define TC_CTRLA_ENABLE (0x1ul << 1)
+#define TC_CTRLA_MODE_COUNT32 (0x2ul << 2)
+#define TC_CTRLA_PRESCALER_DIV1 (0x0ul << 8)
+#define TC_CTRLA_RUNSTDBY (0x1ul << 11)
+#define TC_READREQ_ADDR(value) (0x1Ful & (value))
+#define TC_READREQ_RREQ (0x1ul << 15)
+#define TC_CTRLC_CPTEN0 (0x1ul << 4)
+#define TC_EVCTRL_EVACT_OFF (0x0ul << 0)
+#define TC_EVCTRL_TCEI (0x1ul << 5)
+#define TC_INTFLAG_ERR (0x1ul << 1)
+#define TC_INTFLAG_MC0 (0x1ul << 4)
+
+// EIC //
+
+struct EIC_CTRL_Bits {
+  SIM_FIELD(uint8_t, SWRST, 0, 1);
+  SIM_FIELD(uint8_t, ENABLE, 1, 1);
+};
+struct EIC_STATUS_Bits {
+  SIM_FIELD(uint8_t, SYNCBUSY, 7, 1);
+};
+
+typedef struct {
+  __IO sim::Register<uint8_t, EIC_CTRL_Bits> CTRL; // Offset 0x00
+  __I sim::Register<uint8_t, EIC_STATUS_Bits> STATUS; // Offset 0x01
+  __IO sim::Plain<uint8_t> NMICTRL; // Offset 0x02
+  __IO sim::Plain<uint8_t> NMIFLAG; // Offset 0x03
+  __IO sim::Plain<uint32_t> EVCTRL; // Offset 0x04
+  __IO sim::Plain<uint32_t> INTENCLR; // Offset 0x08
+  __IO sim::Plain<uint32_t> INTENSET; // Offset 0x0C
+  __IO sim::Plain<uint32_t> INTFLAG; // Offset 0x10
+  __IO sim::Plain<uint32_t> WAKEUP; // Offset 0x14
+  __IO sim::Plain<uint32_t> CONFIG[2]; // Offset 0x18
+} Eic;
+
+#define EIC_CONFIG_SENSE0_BOTH_Val 0x3ul
+
+// EVSYS //
+
+typedef struct {
+  __O sim::Plain<uint8_t> CTRL; // Offset 0x00
+  uint8_t Reserved1[3];
+  __IO sim::Plain<uint32_t> CHANNEL; // Offset 0x04
+  __IO sim::Plain<uint16_t> USER; // Offset 0x08
+} Evsys;
+
+#define EVSYS_CHANNELS 12
+#define EVSYS_CHANNEL_CHANNEL(value) (0xFul & (value))
+#define EVSYS_CHANNEL_EVGEN(value) (0x7F0000ul & ((value) << 16))
+#define EVSYS_CHANNEL_PATH_ASYNCHRONOUS (0x2ul << 24)
+#define EVSYS_USER_USER(value) (0x1Ful & (value))
+#define EVSYS_USER_CHANNEL(value) (0x1F00ul & ((value) << 8))
+#define EVSYS_ID_GEN_EIC_EXTINT_0 0x0C
+#define EVSYS_ID_USER_TC4_EVU 0x13
+
+// Instances //
+
+extern Sercom sim_sercom[SERCOM_INST_NUM];
+extern Port sim_port;
+extern Gclk sim_gclk;
+extern Pm sim_pm;
+extern Nvmctrl sim_nvmctrl;
+extern Dmac sim_dmac;
+extern Tc sim_tc[3];
+extern Eic sim_eic;
+extern Evsys sim_evsys;
+extern SCB_Type sim_scb;
+extern SysTick_Type sim_systick;
+
+#define SERCOM0 (&sim_sercom[0])
+#define SERCOM1 (&sim_sercom[1])
+#define SERCOM2 (&sim_sercom[2])
+#define SERCOM3 (&sim_sercom[3])
+#define SERCOM4 (&sim_sercom[4])
+#define SERCOM5 (&sim_sercom[5])
+#define PORT (&sim_port)
+#define GCLK (&sim_gclk)
+#define PM (&sim_pm)
+#define NVMCTRL (&sim_nvmctrl)
+#define DMAC (&sim_dmac)
+#define TC3 (&sim_tc[0])
+#define TC4 (&sim_tc[1])
+#define TC5 (&sim_tc[2])
+#define EIC (&sim_eic)
+#define EVSYS (&sim_evsys)
+#define SCB (&sim_scb)
+#define SysTick (&sim_systick)
+
+// Interrupt handlers, defined by the library and the core
+extern "C" {
+void DMAC_Handler(void);
+void SERCOM0_Handler(void);
+void SERCOM1_Handler(void);
+void SERCOM2_Handler(void);
+void SERCOM3_Handler(void);
+void SERCOM4_Handler(void);
+void SERCOM5_Handler(void);
+void SysTick_Handler(void);
+}
+
+#endif
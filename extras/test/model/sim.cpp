@@ -0,0 +1,1307 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+#include "sim.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <array>
+#include <queue>
+
+// Peripheral instances. The host build links without PIE, such that these, like the static tables of the library, have 32-bit addresses the DMAC can hold.
+Sercom sim_sercom[SERCOM_INST_NUM];
+Port sim_port;
+Gclk sim_gclk;
+Pm sim_pm;
+Nvmctrl sim_nvmctrl;
+Dmac sim_dmac;
+Tc sim_tc[3];
+Eic sim_eic;
+Evsys sim_evsys;
+SCB_Type sim_scb;
+SysTick_Type sim_systick;
+
+// Vector table in flash, found by relocateVectorTable() through SCB->VTOR
+static uint32_t flash_vectors[16 + PERIPH_COUNT_IRQn];
+
+// Tick of the Arduino core, counted by SysTick_Handler
+static volatile uint32_t core_milliseconds;
+
+extern "C" void SysTick_Handler(void) {
+  core_milliseconds++;
+}
+
+namespace sim {
+namespace {
+
+[[noreturn]] void Fail(const char* message) {
+  fprintf(stderr, "model: %s\n", message);
+  abort();
+}
+
+// Time and events //
+
+struct Event {
+  uint64_t cycle;
+  uint64_t order;
+  std::function<void()> call;
+};
+
+struct EventLater {
+  bool operator()(const Event& a, const Event& b) const {
+    return (a.cycle != b.cycle) ? (a.cycle > b.cycle) : (a.order > b.order);
+  }
+};
+
+std::priority_queue<Event, std::vector<Event>, EventLater> events;
+uint64_t now;
+uint64_t event_order;
+uint64_t systick_next; // Cycle of the next SysTick exception
+CostModel costs;
+Counters counters;
+
+// NVIC //
+
+const int kExceptionCount = 16 + PERIPH_COUNT_IRQn; // Indexed by IRQn + 16
+const uint8_t kThreadPriority = 4; // Lower than any exception
+
+bool nvic_enabled[kExceptionCount];
+bool nvic_pending[kExceptionCount];
+bool nvic_active[kExceptionCount];
+bool nvic_line[kExceptionCount]; // Level of the interrupt line of the peripheral
+uint8_t nvic_priority[kExceptionCount];
+std::vector<int> active_stack; // Exceptions being handled, innermost last
+std::vector<NvicCall> nvic_log;
+bool primask;
+uint64_t handler_start;
+uint32_t back_to_back; // Exceptions taken at thread level without the main loop running in between
+
+// Peripheral state that is not held in registers //
+
+struct SercomState {
+  bool tx_full; // DATA holds a character to transmit
+  uint16_t tx;
+  bool shift_loaded; // The shift register holds the next character to transmit
+  uint16_t shift;
+  bool rx_full; // DATA holds a received character
+  uint16_t rx;
+  bool ss_low;
+  bool active; // The slave takes part in the transaction of the master
+  bool in_char; // A character is being clocked
+  uint16_t miso; // Character on MISO during the character being clocked
+};
+SercomState sercoms[SERCOM_INST_NUM];
+
+struct DmacChannel {
+  uint8_t chctrla;
+  uint32_t chctrlb; // Without CMD, which is not kept
+  uint8_t inten;
+  uint8_t flags;
+  bool suspended;
+  bool ignore_commands;
+  uint16_t btctrl; // Descriptor being transferred
+  uint16_t btcnt;
+  uint16_t remaining;
+  uint32_t srcaddr;
+  uint32_t dstaddr;
+  uint32_t descaddr;
+};
+DmacChannel dmac_channels[DMAC_CH_NUM];
+uint32_t dmac_crc; // Register of the CRC engine of the DMAC
+
+uint16_t gclk_clkctrl[64];
+uint8_t gclk_selected;
+uint64_t tc4_start; // Cycle at which TC4 was enabled
+uint8_t evsys_generator[EVSYS_CHANNELS]; // Event generator of each channel, 0 if none
+uint8_t evsys_user_channel[32]; // Channel + 1 of each event user, 0 if none
+
+// Datasheet I/O multiplexing //
+
+/*
+SERCOM PADs of function C (SERCOM) and D (SERCOM-ALT) of the pins of the SAMD21G and SAMD21J.
+Reference: Atmel-42181G-SAM-D21_Datasheet section 7.1, table 7-1
+*/
+struct PinFunctions {
+  uint8_t pin; // 0 to 31 for PORTA, 32 to 63 for PORTB
+  uint8_t c_sercom; // SERCOM of function C, 0xFF if none
+  uint8_t c_pad;
+  uint8_t d_sercom; // SERCOM of function D, 0xFF if none
+  uint8_t d_pad;
+};
+const uint8_t kNone = 0xFF;
+const PinFunctions kPinFunctions[] = {
+  {0, kNone, 0, 1, 0}, // PA00
+  {1, kNone, 0, 1, 1}, // PA01
+  {4, kNone, 0, 0, 0}, // PA04
+  {5, kNone, 0, 0, 1}, // PA05
+  {6, kNone, 0, 0, 2}, // PA06
+  {7, kNone, 0, 0, 3}, // PA07
+  {8, 0, 0, 2, 0}, // PA08
+  {9, 0, 1, 2, 1}, // PA09
+  {10, 0, 2, 2, 2}, // PA10
+  {11, 0, 3, 2, 3}, // PA11
+  {12, 2, 0, 4, 0}, // PA12
+  {13, 2, 1, 4, 1}, // PA13
+  {14, 2, 2, 4, 2}, // PA14
+  {15, 2, 3, 4, 3}, // PA15
+  {16, 1, 0, 3, 0}, // PA16
+  {17, 1, 1, 3, 1}, // PA17
+  {18, 1, 2, 3, 2}, // PA18
+  {19, 1, 3, 3, 3}, // PA19
+  {20, 5, 2, 3, 2}, // PA20
+  {21, 5, 3, 3, 3}, // PA21
+  {22, 3, 0, 5, 0}, // PA22
+  {23, 3, 1, 5, 1}, // PA23
+  {24, 3, 2, 5, 2}, // PA24
+  {25, 3, 3, 5, 3}, // PA25
+  {30, kNone, 0, 1, 2}, // PA30
+  {31, kNone, 0, 1, 3}, // PA31
+  {32, kNone, 0, 5, 2}, // PB00
+  {33, kNone, 0, 5, 3}, // PB01
+  {34, kNone, 0, 5, 0}, // PB02
+  {35, kNone, 0, 5, 1}, // PB03
+  {40, kNone, 0, 4, 0}, // PB08
+  {41, kNone, 0, 4, 1}, // PB09
+  {42, kNone, 0, 4, 2}, // PB10
+  {43, kNone, 0, 4, 3}, // PB11
+  {44, 4, 0, kNone, 0}, // PB12
+  {45, 4, 1, kNone, 0}, // PB13
+  {46, 4, 2, kNone, 0}, // PB14
+  {47, 4, 3, kNone, 0}, // PB15
+  {48, 5, 0, kNone, 0}, // PB16
+  {49, 5, 1, kNone, 0}, // PB17
+  {54, kNone, 0, 5, 2}, // PB22
+  {55, kNone, 0, 5, 3}, // PB23
+  {62, kNone, 0, 5, 0}, // PB30
+  {63, kNone, 0, 5, 1}, // PB31
+};
+
+const PinFunctions* FindPin(uint8_t pin) {
+  for (size_t i = 0; i < sizeof(kPinFunctions) / sizeof(kPinFunctions[0]); i++) {
+    if (kPinFunctions[i].pin == pin) {
+      return &kPinFunctions[i];
+    }
+  }
+  return NULL;
+}
+
+// External interrupt line of a pin. Reference: Atmel-42181G-SAM-D21_Datasheet section 7.1
+int Extint(uint8_t pin) {
+  switch (pin) {
+    case 8: return -1; // NMI
+    case 24: return 12;
+    case 25: return 13;
+    case 27: return 15;
+    case 28: return 8;
+    case 30: return 10;
+    case 31: return 11;
+    default: return pin % 16;
+  }
+}
+
+// Peripheral function selected on a pin, -1 if the pin is not multiplexed
+int PinMux(uint8_t pin) {
+  PortGroup& group = sim_port.Group[pin / 32];
+  uint8_t index = pin % 32;
+  if (!(group.PINCFG[index].sim_raw & PORT_PINCFG_PMUXEN)) {
+    return -1;
+  }
+  uint8_t pmux = group.PMUX[index / 2].sim_raw;
+  return (index % 2 == 0) ? (pmux & 0xF) : (pmux >> 4);
+}
+
+// Accesses of the memory of the core //
+
+template <typename T>
+T Load(uint32_t address) {
+  T value;
+  memcpy(&value, (const void*)(uintptr_t)address, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void Store(uint32_t address, T value) {
+  memcpy((void*)(uintptr_t)address, &value, sizeof(T));
+}
+
+// NVIC //
+
+int Index(IRQn_Type irq) {
+  int index = (int)irq + 16;
+  if ((index < 0) || (index >= kExceptionCount)) {
+    Fail("IRQ number out of range");
+  }
+  return index;
+}
+
+uint8_t ExecutionPriority() {
+  return active_stack.empty() ? kThreadPriority : nvic_priority[active_stack.back()];
+}
+
+// Set the interrupt line of a peripheral. A high line is latched as pending, except while its exception is active, where only a new rising edge is.
+void SetLine(IRQn_Type irq, bool level) {
+  int index = Index(irq);
+  if (level && (!nvic_active[index] || !nvic_line[index])) {
+    nvic_pending[index] = true;
+  }
+  nvic_line[index] = level;
+}
+
+void UpdateLines();
+
+void (*HandlerOf(int index))() {
+  switch (index - 16) {
+    case SysTick_IRQn: return SysTick_Handler;
+    case DMAC_IRQn: return DMAC_Handler;
+    case SERCOM0_IRQn: return SERCOM0_Handler;
+    case SERCOM1_IRQn: return SERCOM1_Handler;
+    case SERCOM2_IRQn: return SERCOM2_Handler;
+    case SERCOM3_IRQn: return SERCOM3_Handler;
+    case SERCOM4_IRQn: return SERCOM4_Handler;
+    case SERCOM5_IRQn: return SERCOM5_Handler;
+    default: return NULL;
+  }
+}
+
+// Highest priority exception that preempts the running code, -1 if none
+int Preempting() {
+  int best = -1;
+  for (int index = 0; index < kExceptionCount; index++) {
+    bool enabled = nvic_enabled[index] || (index == SysTick_IRQn + 16);
+    if (enabled && nvic_pending[index] && !nvic_active[index] && (nvic_priority[index] < ExecutionPriority()) &&
+        ((best < 0) || (nvic_priority[index] < nvic_priority[best]))) {
+      best = index;
+    }
+  }
+  return best;
+}
+
+void AdvanceTo(uint64_t cycle, bool systick_running = true);
+
+void Advance(uint32_t cycles) {
+  AdvanceTo(now + cycles);
+}
+
+void Take(int index) {
+  void (*handler)() = HandlerOf(index);
+  if (handler == NULL) {
+    Fail("interrupt without a handler in the model");
+  }
+  if (active_stack.empty()) {
+    handler_start = now;
+  }
+  nvic_pending[index] = false;
+  nvic_active[index] = true;
+  active_stack.push_back(index);
+  counters.exceptions++;
+  if (active_stack.size() > counters.max_nesting) {
+    counters.max_nesting = active_stack.size();
+  }
+  Advance(costs.exception_entry + costs.handler_overhead);
+  handler();
+  Advance(costs.exception_exit);
+  active_stack.pop_back();
+  nvic_active[index] = false;
+  if (nvic_line[index]) {
+    nvic_pending[index] = true; // The line is still high on return
+  }
+  if (active_stack.empty()) {
+    counters.handler_cycles += now - handler_start;
+  }
+}
+
+// Take the exceptions that preempt the running code
+void CheckInterrupts() {
+  if (primask) {
+    return;
+  }
+  int index;
+  while ((index = Preempting()) >= 0) {
+    if (active_stack.empty() && (++back_to_back > 1000000)) {
+      Fail("interrupt storm: the main loop has not run for a million exceptions");
+    }
+    Take(index);
+  }
+  if (active_stack.empty()) {
+    back_to_back = 0;
+  }
+}
+
+// SERCOM //
+
+bool SercomEnabled(uint8_t n) {
+  return sim_sercom[n].SPI.CTRLA.sim_raw & SERCOM_SPI_CTRLA_ENABLE;
+}
+
+uint8_t SercomFlags(uint8_t n) {
+  SercomSpi& spi = sim_sercom[n].SPI;
+  uint8_t flags = spi.INTFLAG.sim_raw & (SERCOM_SPI_INTFLAG_TXC | SERCOM_SPI_INTFLAG_SSL | SERCOM_SPI_INTFLAG_ERROR);
+  if (SercomEnabled(n) && !sercoms[n].tx_full) {
+    flags |= SERCOM_SPI_INTFLAG_DRE;
+  }
+  if (sercoms[n].rx_full) {
+    flags |= SERCOM_SPI_INTFLAG_RXC;
+  }
+  return flags;
+}
+
+uint16_t CharMask(uint8_t n) {
+  return ((sim_sercom[n].SPI.CTRLB.sim_raw & SERCOM_SPI_CTRLB_CHSIZE_Msk) == 1) ? 0x1FF : 0xFF;
+}
+
+// Move the character in DATA to the shift register, when the shift register is free. While Slave Select is high, only with preload.
+void SercomLoadShift(uint8_t n) {
+  SercomState& s = sercoms[n];
+  bool preload = sim_sercom[n].SPI.CTRLB.sim_raw & SERCOM_SPI_CTRLB_PLOADEN;
+  if (!s.shift_loaded && s.tx_full && SercomEnabled(n) && (s.ss_low ? !s.in_char : preload)) {
+    s.shift = s.tx;
+    s.shift_loaded = true;
+    s.tx_full = false;
+  }
+}
+
+void SercomReset(uint8_t n) {
+  memset((void*)&sim_sercom[n], 0, sizeof(Sercom));
+  bool ss_low = sercoms[n].ss_low;
+  memset(&sercoms[n], 0, sizeof(SercomState));
+  sercoms[n].ss_low = ss_low;
+}
+
+// The four pins of the master are routed to the PADs selected by DIPO and DOPO
+bool SercomConnected(uint8_t n, const uint8_t* pins) {
+  uint32_t ctrla = sim_sercom[n].SPI.CTRLA.sim_raw;
+  if (!(ctrla & SERCOM_SPI_CTRLA_ENABLE) || ((ctrla & SERCOM_SPI_CTRLA_MODE_Msk) != SERCOM_SPI_CTRLA_MODE(2))) {
+    return false;
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    if ((SercomFunction(n, pins[i]) == 0) || (PinMux(pins[i]) != SercomFunction(n, pins[i]))) {
+      return false;
+    }
+  }
+  static const int8_t kDopoPads[4][3] = {{0, 1, 2}, {2, 3, 1}, {3, 1, 2}, {0, 3, 1}}; // MISO, SCK, SS. Reference: Atmel-42181G-SAM-D21_Datasheet page 493
+  uint32_t dopo = (ctrla & SERCOM_SPI_CTRLA_DOPO_Msk) >> SERCOM_SPI_CTRLA_DOPO_Pos;
+  uint32_t dipo = (ctrla & SERCOM_SPI_CTRLA_DIPO_Msk) >> SERCOM_SPI_CTRLA_DIPO_Pos;
+  return (SercomPad(n, pins[0]) == (int)dipo) && (SercomPad(n, pins[3]) == kDopoPads[dopo][0]) &&
+         (SercomPad(n, pins[1]) == kDopoPads[dopo][1]) && (SercomPad(n, pins[2]) == kDopoPads[dopo][2]);
+}
+
+uint32_t SercomRead(uint8_t n, size_t offset) {
+  SercomSpi& spi = sim_sercom[n].SPI;
+  SercomState& s = sercoms[n];
+  switch (offset) {
+    case 0x14:
+    case 0x16:
+      return spi.INTENSET.sim_raw;
+    case 0x18:
+      return SercomFlags(n);
+    case 0x1C:
+      return 0; // Synchronization is immediate
+    case 0x28:
+      if (s.rx_full) {
+        s.rx_full = false;
+      }
+      return s.rx;
+    default:
+      return 0xFFFFFFFF; // Read from the stored value
+  }
+}
+
+void SercomWrite(uint8_t n, size_t offset, uint32_t value) {
+  SercomSpi& spi = sim_sercom[n].SPI;
+  SercomState& s = sercoms[n];
+  switch (offset) {
+    case 0x00: {
+      if (value & SERCOM_SPI_CTRLA_SWRST) {
+        SercomReset(n);
+        return;
+      }
+      uint32_t old = spi.CTRLA.sim_raw;
+      if (old & SERCOM_SPI_CTRLA_ENABLE) {
+        value = (old & ~SERCOM_SPI_CTRLA_ENABLE) | (value & SERCOM_SPI_CTRLA_ENABLE); // Enable-protected
+      }
+      spi.CTRLA.sim_raw = value;
+      if ((old & SERCOM_SPI_CTRLA_ENABLE) && !(value & SERCOM_SPI_CTRLA_ENABLE)) {
+        // Disabling discards the characters in DATA and in the shift register
+        s.tx_full = false;
+        s.shift_loaded = false;
+        s.rx_full = false;
+        s.active = false;
+        s.in_char = false;
+      }
+      break;
+    }
+    case 0x04:
+      if (SercomEnabled(n)) {
+        value = (spi.CTRLB.sim_raw & ~SERCOM_SPI_CTRLB_RXEN) | (value & SERCOM_SPI_CTRLB_RXEN); // Only RXEN is not enable-protected
+      }
+      spi.CTRLB.sim_raw = value;
+      break;
+    case 0x14:
+      spi.INTENSET.sim_raw &= ~value;
+      spi.INTENCLR.sim_raw = spi.INTENSET.sim_raw;
+      break;
+    case 0x16:
+      spi.INTENSET.sim_raw |= value;
+      spi.INTENCLR.sim_raw = spi.INTENSET.sim_raw;
+      break;
+    case 0x18:
+      spi.INTFLAG.sim_raw &= ~(value & (SERCOM_SPI_INTFLAG_TXC | SERCOM_SPI_INTFLAG_SSL | SERCOM_SPI_INTFLAG_ERROR));
+      break;
+    case 0x1A:
+      spi.STATUS.sim_raw &= ~(value & SERCOM_SPI_STATUS_BUFOVF);
+      break;
+    case 0x1C:
+      break; // Read-only
+    case 0x28:
+      if (SercomEnabled(n)) {
+        s.tx = value & CharMask(n);
+        s.tx_full = true;
+        SercomLoadShift(n);
+      }
+      break;
+    default:
+      break; // Stored as written
+  }
+}
+
+// SPI bus, called from the events of SpiMaster
+void SercomSlaveSelect(uint8_t n, const uint8_t* pins, bool low) {
+  SercomState& s = sercoms[n];
+  SercomSpi& spi = sim_sercom[n].SPI;
+  s.ss_low = low;
+  if (low) {
+    s.active = SercomConnected(n, pins);
+    s.in_char = false;
+    if (s.active && (spi.CTRLB.sim_raw & SERCOM_SPI_CTRLB_SSDE)) {
+      spi.INTFLAG.sim_raw |= SERCOM_SPI_INTFLAG_SSL;
+    }
+  } else if (s.active) {
+    spi.INTFLAG.sim_raw |= SERCOM_SPI_INTFLAG_TXC; // In slave mode, Transmit Complete is set when Slave Select goes high. Reference: Atmel-42181G-SAM-D21_Datasheet page 503
+    s.active = false;
+    s.in_char = false;
+  }
+  SercomLoadShift(n);
+}
+
+void SercomCharStart(uint8_t n) {
+  SercomState& s = sercoms[n];
+  if (!s.active) {
+    return;
+  }
+  SercomLoadShift(n);
+  s.in_char = true;
+  s.miso = s.shift_loaded ? s.shift : kUndefined; // Underrun if nothing was loaded in time
+  s.shift_loaded = false;
+}
+
+uint16_t SercomCharEnd(uint8_t n, uint16_t mosi) {
+  SercomState& s = sercoms[n];
+  SercomSpi& spi = sim_sercom[n].SPI;
+  if (!s.active) {
+    return kUndefined;
+  }
+  s.in_char = false;
+  if (spi.CTRLB.sim_raw & SERCOM_SPI_CTRLB_RXEN) {
+    if (s.rx_full) {
+      spi.STATUS.sim_raw |= SERCOM_SPI_STATUS_BUFOVF; // The character is lost
+      spi.INTFLAG.sim_raw |= SERCOM_SPI_INTFLAG_ERROR; // Immediately, as CTRLA.IBON is set by the library
+    } else {
+      s.rx = mosi & CharMask(n);
+      s.rx_full = true;
+    }
+  }
+  SercomLoadShift(n);
+  return s.miso;
+}
+
+// DMAC //
+
+DmacChannel& SelectedChannel() {
+  return dmac_channels[sim_dmac.CHID.sim_raw % DMAC_CH_NUM];
+}
+
+uint8_t Channel(const DmacChannel& channel) {
+  return &channel - dmac_channels;
+}
+
+void DmacWriteBack(DmacChannel& channel) {
+  uint32_t address = sim_dmac.WRBADDR.sim_raw + 16 * Channel(channel);
+  Store<uint16_t>(address, channel.btctrl);
+  Store<uint16_t>(address + 2, channel.remaining);
+  Store<uint32_t>(address + 4, channel.srcaddr);
+  Store<uint32_t>(address + 8, channel.dstaddr);
+  Store<uint32_t>(address + 12, channel.descaddr);
+}
+
+void DmacDisable(DmacChannel& channel) {
+  channel.chctrla &= ~DMAC_CHCTRLA_ENABLE;
+  channel.suspended = false;
+  DmacWriteBack(channel);
+}
+
+// Fetch a descriptor. An invalid descriptor is a transfer error, which disables the channel.
+void DmacFetch(DmacChannel& channel, uint32_t address) {
+  channel.btctrl = Load<uint16_t>(address);
+  channel.btcnt = Load<uint16_t>(address + 2);
+  channel.srcaddr = Load<uint32_t>(address + 4);
+  channel.dstaddr = Load<uint32_t>(address + 8);
+  channel.descaddr = Load<uint32_t>(address + 12);
+  channel.remaining = channel.btcnt;
+  if (!(channel.btctrl & DMAC_BTCTRL_VALID)) {
+    channel.flags |= DMAC_CHINTFLAG_TERR;
+    DmacDisable(channel);
+  }
+}
+
+/*
+The CRC engine of the DMAC updates the checksum with each byte transferred by the channel selected in CRCCTRL.CRCSRC, starting from the value written to CRCCHKSUM before CRCENABLE.
+CRC-16 is the CCITT polynomial, not reflected. CRC-32 is the reflected IEEE 802.3 polynomial, and its checksum reads complemented.
+Reference: Atmel-42181G-SAM-D21_Datasheet section 19.6.3.7
+*/
+void DmacCrcUpdate(const DmacChannel& channel, uint8_t data) {
+  uint32_t source = (sim_dmac.CRCCTRL.sim_raw & DMAC_CRCCTRL_CRCSRC_Msk) >> DMAC_CRCCTRL_CRCSRC_Pos;
+  if (!(sim_dmac.CTRL.sim_raw & DMAC_CTRL_CRCENABLE) || (source != 0x20u + Channel(channel))) {
+    return;
+  }
+  if ((sim_dmac.CRCCTRL.sim_raw & DMAC_CRCCTRL_CRCPOLY_Msk) == DMAC_CRCCTRL_CRCPOLY_CRC32) {
+    dmac_crc ^= data;
+    for (uint8_t i = 0; i < 8; i++) {
+      dmac_crc = (dmac_crc & 1) ? ((dmac_crc >> 1) ^ 0xEDB88320) : (dmac_crc >> 1);
+    }
+    sim_dmac.CRCCHKSUM.sim_raw = ~dmac_crc;
+  } else {
+    dmac_crc ^= (uint32_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      dmac_crc = ((dmac_crc & 0x8000) ? ((dmac_crc << 1) ^ 0x1021) : (dmac_crc << 1)) & 0xFFFF;
+    }
+    sim_dmac.CRCCHKSUM.sim_raw = dmac_crc;
+  }
+}
+
+// Transfer one beat of a channel that is triggered
+void DmacBeat(DmacChannel& channel, bool receive, uint8_t n) {
+  uint32_t size = 1u << ((channel.btctrl & DMAC_BTCTRL_BEATSIZE_Msk) >> DMAC_BTCTRL_BEATSIZE_Pos);
+  if (receive) {
+    uint16_t data = sercoms[n].rx;
+    sercoms[n].rx_full = false;
+    uint32_t address = channel.dstaddr - ((channel.btctrl & DMAC_BTCTRL_DSTINC) ? channel.remaining * size : 0);
+    (size == 1) ? Store<uint8_t>(address, data) : Store<uint16_t>(address, data);
+    DmacCrcUpdate(channel, (uint8_t)data);
+  } else {
+    uint32_t address = channel.srcaddr - ((channel.btctrl & DMAC_BTCTRL_SRCINC) ? channel.remaining * size : 0);
+    sercoms[n].tx = ((size == 1) ? Load<uint8_t>(address) : Load<uint16_t>(address)) & CharMask(n);
+    sercoms[n].tx_full = true;
+    SercomLoadShift(n);
+  }
+  if (--channel.remaining == 0) {
+    uint32_t blockact = channel.btctrl & DMAC_BTCTRL_BLOCKACT_Msk;
+    if ((blockact == DMAC_BTCTRL_BLOCKACT_INT) || (blockact == DMAC_BTCTRL_BLOCKACT_BOTH)) {
+      channel.flags |= DMAC_CHINTFLAG_TCMPL;
+    }
+    if (channel.descaddr != 0) {
+      DmacFetch(channel, channel.descaddr);
+    } else {
+      DmacDisable(channel);
+    }
+  }
+}
+
+// Serve the triggers of the DMAC channels until none is pending
+void DmacSettle() {
+  if (!(sim_dmac.CTRL.sim_raw & DMAC_CTRL_DMAENABLE)) {
+    return;
+  }
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (DmacChannel& channel : dmac_channels) {
+      if (!(channel.chctrla & DMAC_CHCTRLA_ENABLE) || channel.suspended) {
+        continue;
+      }
+      uint32_t trigger = (channel.chctrlb & DMAC_CHCTRLB_TRIGSRC_Msk) >> DMAC_CHCTRLB_TRIGSRC_Pos;
+      if ((trigger < SERCOM0_DMAC_ID_RX) || (trigger >= SERCOM0_DMAC_ID_RX + 2 * SERCOM_INST_NUM)) {
+        continue;
+      }
+      uint8_t n = (trigger - SERCOM0_DMAC_ID_RX) / 2;
+      bool receive = ((trigger - SERCOM0_DMAC_ID_RX) % 2) == 0;
+      bool triggered = receive ? sercoms[n].rx_full : (SercomFlags(n) & SERCOM_SPI_INTFLAG_DRE);
+      if (triggered) {
+        DmacBeat(channel, receive, n);
+        progress = true;
+      }
+    }
+  }
+}
+
+uint32_t DmacRead(size_t offset) {
+  DmacChannel& channel = SelectedChannel();
+  switch (offset) {
+    case 0x00:
+      return sim_dmac.CTRL.sim_raw;
+    case 0x24: {
+      uint32_t pending = 0;
+      for (uint8_t i = 0; i < DMAC_CH_NUM; i++) {
+        if (dmac_channels[i].flags & dmac_channels[i].inten) {
+          pending |= 1ul << i;
+        }
+      }
+      return pending;
+    }
+    case 0x40:
+      return channel.chctrla;
+    case 0x44:
+      return channel.chctrlb;
+    case 0x4C:
+    case 0x4D:
+      return channel.inten;
+    case 0x4E:
+      return channel.flags;
+    case 0x4F:
+      return ((channel.chctrla & DMAC_CHCTRLA_ENABLE) && !channel.suspended) ? 0x2 : 0x0; // BUSY
+    default:
+      return 0xFFFFFFFF;
+  }
+}
+
+void DmacWrite(size_t offset, uint32_t value) {
+  DmacChannel& channel = SelectedChannel();
+  switch (offset) {
+    case 0x00:
+      if (value & DMAC_CTRL_SWRST) {
+        memset((void*)&sim_dmac, 0, sizeof(sim_dmac));
+        dmac_crc = 0;
+        for (DmacChannel& c : dmac_channels) {
+          bool ignore = c.ignore_commands;
+          memset(&c, 0, sizeof(c));
+          c.ignore_commands = ignore;
+        }
+      } else {
+        if ((value & DMAC_CTRL_CRCENABLE) && !(sim_dmac.CTRL.sim_raw & DMAC_CTRL_CRCENABLE)) {
+          dmac_crc = sim_dmac.CRCCHKSUM.sim_raw; // Initial value
+        }
+        sim_dmac.CTRL.sim_raw = value;
+      }
+      break;
+    case 0x40:
+      if (value & DMAC_CHCTRLA_SWRST) {
+        if (!(channel.chctrla & DMAC_CHCTRLA_ENABLE)) {
+          bool ignore = channel.ignore_commands;
+          memset(&channel, 0, sizeof(channel));
+          channel.ignore_commands = ignore;
+        }
+      } else if ((value & DMAC_CHCTRLA_ENABLE) && !(channel.chctrla & DMAC_CHCTRLA_ENABLE)) {
+        channel.chctrla = value;
+        DmacFetch(channel, sim_dmac.BASEADDR.sim_raw + 16 * Channel(channel));
+      } else if (!(value & DMAC_CHCTRLA_ENABLE) && (channel.chctrla & DMAC_CHCTRLA_ENABLE)) {
+        channel.chctrla = value;
+        DmacDisable(channel);
+      } else {
+        channel.chctrla = value;
+      }
+      break;
+    case 0x44: {
+      uint32_t command = (value & DMAC_CHCTRLB_CMD_Msk) >> DMAC_CHCTRLB_CMD_Pos;
+      channel.chctrlb = value & ~DMAC_CHCTRLB_CMD_Msk;
+      if (channel.ignore_commands || !(channel.chctrla & DMAC_CHCTRLA_ENABLE)) {
+        break; // A command to a disabled channel has no effect
+      }
+      if (command == DMAC_CHCTRLB_CMD_SUSPEND_Val) {
+        channel.suspended = true;
+        channel.flags |= DMAC_CHINTFLAG_SUSP;
+        DmacWriteBack(channel);
+      } else if (command == DMAC_CHCTRLB_CMD_RESUME_Val) {
+        channel.suspended = false;
+      }
+      break;
+    }
+    case 0x4C:
+      channel.inten &= ~value;
+      break;
+    case 0x4D:
+      channel.inten |= value;
+      break;
+    case 0x4E:
+      channel.flags &= ~value;
+      break;
+    default:
+      break;
+  }
+}
+
+// TC4, EIC and EVSYS //
+
+TcCount32& Tc4() {
+  return sim_tc[1].COUNT32;
+}
+
+uint32_t Tc4Count() {
+  return (Tc4().CTRLA.sim_raw & TC_CTRLA_ENABLE) ? (uint32_t)(now - tc4_start) : Tc4().COUNT.sim_raw; // GCLK0 at the CPU clock, prescaler 1
+}
+
+void TcWrite(uint8_t tc, size_t offset, uint32_t value) {
+  TcCount32& count = sim_tc[tc].COUNT32;
+  switch (offset) {
+    case 0x00:
+      if (value & TC_CTRLA_SWRST) {
+        memset((void*)&sim_tc[tc], 0, sizeof(Tc));
+      } else {
+        if ((tc == 1) && (value & TC_CTRLA_ENABLE) && !(count.CTRLA.sim_raw & TC_CTRLA_ENABLE)) {
+          tc4_start = now - count.COUNT.sim_raw;
+        }
+        count.CTRLA.sim_raw = value;
+      }
+      break;
+    case 0x02:
+      count.READREQ.sim_raw = value;
+      if ((tc == 1) && (value & TC_READREQ_RREQ) && ((value & 0x1F) == 0x10)) {
+        count.COUNT.sim_raw = Tc4Count();
+      }
+      break;
+    case 0x0E:
+      count.INTFLAG.sim_raw &= ~value;
+      break;
+    default:
+      break;
+  }
+}
+
+// Edge on a pin, routed to the capture of TC4 through the EIC and the Event System
+void PinEdge(uint8_t pin) {
+  int extint = Extint(pin);
+  if ((extint < 0) || !(sim_eic.CTRL.sim_raw & 0x2) || (PinMux(pin) != 0) || !(sim_eic.EVCTRL.sim_raw & (1ul << extint))) {
+    return;
+  }
+  uint32_t sense = (sim_eic.CONFIG[extint / 8].sim_raw >> (4 * (extint % 8))) & 0x7;
+  if (sense != EIC_CONFIG_SENSE0_BOTH_Val) {
+    return; // The tests only use both edges
+  }
+  uint8_t channel = evsys_user_channel[EVSYS_ID_USER_TC4_EVU];
+  if ((channel == 0) || (evsys_generator[channel - 1] != EVSYS_ID_GEN_EIC_EXTINT_0 + extint)) {
+    return;
+  }
+  TcCount32& tc4 = Tc4();
+  if ((tc4.CTRLA.sim_raw & TC_CTRLA_ENABLE) && (tc4.EVCTRL.sim_raw & TC_EVCTRL_TCEI) && (tc4.CTRLC.sim_raw & TC_CTRLC_CPTEN0)) {
+    if (tc4.INTFLAG.sim_raw & TC_INTFLAG_MC0) {
+      tc4.INTFLAG.sim_raw |= TC_INTFLAG_ERR; // The previous capture was not read
+    }
+    tc4.CC[0].sim_raw = Tc4Count();
+    tc4.INTFLAG.sim_raw |= TC_INTFLAG_MC0;
+  }
+}
+
+// Interrupt lines //
+
+void UpdateLines() {
+  DmacSettle();
+  for (uint8_t n = 0; n < SERCOM_INST_NUM; n++) {
+    SetLine((IRQn_Type)(SERCOM0_IRQn + n), SercomFlags(n) & sim_sercom[n].SPI.INTENSET.sim_raw);
+  }
+  bool dmac = false;
+  for (const DmacChannel& channel : dmac_channels) {
+    dmac = dmac || (channel.flags & channel.inten);
+  }
+  SetLine(DMAC_IRQn, dmac);
+}
+
+// Time //
+
+void AdvanceTo(uint64_t cycle, bool systick_running) {
+  while (true) {
+    bool systick = systick_running && (sim_systick.CTRL.sim_raw & 0x1) && (systick_next <= cycle) &&
+                   (events.empty() || (systick_next < events.top().cycle));
+    if (systick) {
+      now = systick_next;
+      systick_next += sim_systick.LOAD.sim_raw + 1;
+      if (sim_systick.CTRL.sim_raw & 0x2) {
+        nvic_pending[SysTick_IRQn + 16] = true;
+      }
+    } else if (!events.empty() && (events.top().cycle <= cycle)) {
+      Event event = events.top();
+      events.pop();
+      if (event.cycle > now) {
+        now = event.cycle;
+      }
+      event.call();
+      UpdateLines();
+    } else {
+      break;
+    }
+  }
+  if (cycle > now) {
+    now = cycle;
+  }
+}
+
+// Register accesses //
+
+enum Peripheral { kMemory, kSercom, kPort, kGclk, kPm, kNvmctrl, kDmac, kTc, kEic, kEvsys, kSysTick };
+
+template <typename T>
+bool Within(const void* address, const T& instance, size_t* offset) {
+  uintptr_t a = (uintptr_t)address;
+  uintptr_t base = (uintptr_t)&instance;
+  if ((a >= base) && (a < base + sizeof(T))) {
+    *offset = a - base;
+    return true;
+  }
+  return false;
+}
+
+Peripheral Locate(const void* address, size_t* offset, uint8_t* instance) {
+  *instance = 0;
+  for (uint8_t n = 0; n < SERCOM_INST_NUM; n++) {
+    if (Within(address, sim_sercom[n], offset)) {
+      *instance = n;
+      return kSercom;
+    }
+  }
+  for (uint8_t n = 0; n < 3; n++) {
+    if (Within(address, sim_tc[n], offset)) {
+      *instance = n;
+      return kTc;
+    }
+  }
+  if (Within(address, sim_port, offset)) return kPort;
+  if (Within(address, sim_gclk, offset)) return kGclk;
+  if (Within(address, sim_pm, offset)) return kPm;
+  if (Within(address, sim_nvmctrl, offset)) return kNvmctrl;
+  if (Within(address, sim_dmac, offset)) return kDmac;
+  if (Within(address, sim_eic, offset)) return kEic;
+  if (Within(address, sim_evsys, offset)) return kEvsys;
+  if (Within(address, sim_systick, offset)) return kSysTick;
+  return kMemory;
+}
+
+uint32_t RawRead(const void* address, uint8_t size) {
+  uint32_t value = 0;
+  memcpy(&value, address, size);
+  return value;
+}
+
+void RawWrite(void* address, uint8_t size, uint32_t value) {
+  memcpy(address, &value, size);
+}
+
+} // namespace
+
+uint32_t RegisterRead(const void* reg, uint8_t size) {
+  size_t offset;
+  uint8_t instance;
+  Peripheral peripheral = Locate(reg, &offset, &instance);
+  uint32_t value = 0xFFFFFFFF;
+  switch (peripheral) {
+    case kSercom:
+      value = SercomRead(instance, offset);
+      break;
+    case kDmac:
+      value = DmacRead(offset);
+      break;
+    case kGclk:
+      if (offset == 0x2) {
+        value = gclk_clkctrl[gclk_selected];
+      }
+      break;
+    case kSysTick:
+      if (offset == 0x8) {
+        uint64_t left = (systick_next > now) ? systick_next - now : 1;
+        value = (uint32_t)(left - 1);
+      }
+      break;
+    default:
+      break;
+  }
+  if (value == 0xFFFFFFFF) {
+    value = RawRead(reg, size);
+  }
+  Advance((peripheral == kMemory) ? costs.memory_access : costs.peripheral_access);
+  UpdateLines();
+  CheckInterrupts();
+  return (size == 4) ? value : (value & ((1ul << (8 * size)) - 1));
+}
+
+void RegisterWrite(void* reg, uint8_t size, uint32_t value) {
+  size_t offset;
+  uint8_t instance;
+  Peripheral peripheral = Locate(reg, &offset, &instance);
+  bool stored = false;
+  switch (peripheral) {
+    case kSercom:
+      if ((offset == 0x00) || (offset == 0x04) || (offset == 0x14) || (offset == 0x16) || (offset == 0x18) || (offset == 0x1A) || (offset == 0x1C) || (offset == 0x28)) {
+        SercomWrite(instance, offset, value);
+        stored = true;
+      }
+      break;
+    case kDmac:
+      if ((offset == 0x00) || (offset >= 0x40)) {
+        DmacWrite(offset, value);
+        stored = true;
+      }
+      break;
+    case kTc:
+      if ((offset == 0x00) || (offset == 0x02) || (offset == 0x0E)) {
+        TcWrite(instance, offset, value);
+        stored = true;
+      }
+      break;
+    case kGclk:
+      if (offset == 0x2) {
+        gclk_selected = value & 0x3F;
+        gclk_clkctrl[gclk_selected] = value;
+      }
+      break;
+    case kEic:
+      if ((offset == 0x00) && (value & 0x1)) {
+        memset((void*)&sim_eic, 0, sizeof(sim_eic)); // Software reset
+        stored = true;
+      }
+      break;
+    case kEvsys:
+      if (offset == 0x04) {
+        evsys_generator[value & 0xF] = (value >> 16) & 0x7F;
+      } else if (offset == 0x08) {
+        evsys_user_channel[value & 0x1F] = (value >> 8) & 0x1F;
+      }
+      break;
+    default:
+      break;
+  }
+  if (!stored) {
+    RawWrite(reg, size, value);
+  }
+  Advance((peripheral == kMemory) ? costs.memory_access : costs.peripheral_access);
+  UpdateLines();
+  CheckInterrupts();
+}
+
+// Public functions //
+
+void Reset() {
+  memset((void*)sim_sercom, 0, sizeof(sim_sercom));
+  memset((void*)&sim_port, 0, sizeof(sim_port));
+  memset((void*)&sim_gclk, 0, sizeof(sim_gclk));
+  memset((void*)&sim_pm, 0, sizeof(sim_pm));
+  memset((void*)&sim_nvmctrl, 0, sizeof(sim_nvmctrl));
+  memset((void*)&sim_dmac, 0, sizeof(sim_dmac));
+  dmac_crc = 0;
+  memset((void*)sim_tc, 0, sizeof(sim_tc));
+  memset((void*)&sim_eic, 0, sizeof(sim_eic));
+  memset((void*)&sim_evsys, 0, sizeof(sim_evsys));
+  memset((void*)&sim_scb, 0, sizeof(sim_scb));
+  memset((void*)&sim_systick, 0, sizeof(sim_systick));
+  memset(sercoms, 0, sizeof(sercoms));
+  memset(dmac_channels, 0, sizeof(dmac_channels));
+  memset(gclk_clkctrl, 0, sizeof(gclk_clkctrl));
+  memset(evsys_generator, 0, sizeof(evsys_generator));
+  memset(evsys_user_channel, 0, sizeof(evsys_user_channel));
+  gclk_selected = 0;
+  tc4_start = 0;
+  events = decltype(events)();
+  now = 0;
+  event_order = 0;
+  memset(&counters, 0, sizeof(counters));
+  costs.peripheral_access = 6;
+  costs.memory_access = 2;
+  costs.exception_entry = 15;
+  costs.exception_exit = 15;
+  costs.handler_overhead = 40;
+  memset(nvic_enabled, 0, sizeof(nvic_enabled));
+  memset(nvic_pending, 0, sizeof(nvic_pending));
+  memset(nvic_active, 0, sizeof(nvic_active));
+  memset(nvic_line, 0, sizeof(nvic_line));
+  memset(nvic_priority, 0, sizeof(nvic_priority));
+  active_stack.clear();
+  nvic_log.clear();
+  primask = false;
+  back_to_back = 0;
+
+  // Initialization of the Arduino core: SysTick interrupt every millisecond at priority 2, and the vector table in flash
+  sim_scb.VTOR = (uint32_t)(uintptr_t)flash_vectors;
+  sim_systick.LOAD.sim_raw = kCpuFrequency / 1000 - 1;
+  sim_systick.CTRL.sim_raw = 0x7;
+  systick_next = kCpuFrequency / 1000;
+  nvic_priority[SysTick_IRQn + 16] = 2;
+  core_milliseconds = 0;
+}
+
+CostModel& Costs() {
+  return costs;
+}
+
+const Counters& Stats() {
+  return counters;
+}
+
+uint64_t Now() {
+  return now;
+}
+
+void Run(uint64_t cycles) {
+  RunUntil(now + cycles);
+}
+
+void RunUntil(uint64_t cycle) {
+  while (true) {
+    UpdateLines();
+    CheckInterrupts();
+    if (now >= cycle) {
+      break;
+    }
+    uint64_t next = cycle;
+    if (!events.empty() && (events.top().cycle < next)) {
+      next = events.top().cycle;
+    }
+    if ((sim_systick.CTRL.sim_raw & 0x1) && (systick_next < next)) {
+      next = systick_next;
+    }
+    AdvanceTo((next > now) ? next : now + 1);
+  }
+}
+
+void Schedule(uint64_t cycle, std::function<void()> event) {
+  Event e;
+  e.cycle = cycle;
+  e.order = event_order++;
+  e.call = event;
+  events.push(e);
+}
+
+bool IrqEnabled(IRQn_Type irq) {
+  return nvic_enabled[Index(irq)];
+}
+
+bool InHandler() {
+  return !active_stack.empty();
+}
+
+const std::vector<NvicCall>& NvicLog() {
+  return nvic_log;
+}
+
+void ClearNvicLog() {
+  nvic_log.clear();
+}
+
+uint16_t GclkClkctrl(uint8_t id) {
+  return gclk_clkctrl[id & 0x3F];
+}
+
+std::vector<uint8_t> PeripheralSnapshot() {
+  std::vector<uint8_t> snapshot;
+  const uint8_t* regions[] = {(const uint8_t*)sim_sercom, (const uint8_t*)&sim_port, (const uint8_t*)&sim_gclk, (const uint8_t*)&sim_pm, (const uint8_t*)&sim_nvmctrl,
+                              (const uint8_t*)&sim_dmac, (const uint8_t*)sim_tc, (const uint8_t*)&sim_eic, (const uint8_t*)&sim_evsys};
+  const size_t sizes[] = {sizeof(sim_sercom), sizeof(sim_port), sizeof(sim_gclk), sizeof(sim_pm), sizeof(sim_nvmctrl), sizeof(sim_dmac), sizeof(sim_tc), sizeof(sim_eic), sizeof(sim_evsys)};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    snapshot.insert(snapshot.end(), regions[i], regions[i] + sizes[i]);
+  }
+  for (int index = 0; index < kExceptionCount; index++) {
+    snapshot.push_back(nvic_enabled[index]);
+    snapshot.push_back(nvic_priority[index]);
+  }
+  snapshot.insert(snapshot.end(), (const uint8_t*)gclk_clkctrl, (const uint8_t*)gclk_clkctrl + sizeof(gclk_clkctrl));
+  return snapshot;
+}
+
+uint8_t SercomFunction(uint8_t sercom_no, uint8_t pin) {
+  const PinFunctions* functions = FindPin(pin);
+  if (functions == NULL) {
+    return 0;
+  }
+  return (functions->c_sercom == sercom_no) ? 0x2 : (functions->d_sercom == sercom_no) ? 0x3 : 0;
+}
+
+int SercomPad(uint8_t sercom_no, uint8_t pin) {
+  const PinFunctions* functions = FindPin(pin);
+  if (functions == NULL) {
+    return -1;
+  }
+  return (functions->c_sercom == sercom_no) ? functions->c_pad : (functions->d_sercom == sercom_no) ? functions->d_pad : -1;
+}
+
+void DmacIgnoreCommands(uint8_t channel, bool ignore) {
+  dmac_channels[channel].ignore_commands = ignore;
+}
+
+// SPI master //
+
+SpiMaster::SpiMaster(uint8_t sercom_no, uint8_t mosi_pin, uint8_t sck_pin, uint8_t ss_pin, uint8_t miso_pin)
+    : sercom_no_(sercom_no), pins_{mosi_pin, sck_pin, ss_pin, miso_pin}, mirror_pin_(-1) {}
+
+std::shared_ptr<Transaction> SpiMaster::Transfer(uint64_t start, const std::vector<uint16_t>& mosi, double sck_frequency, uint8_t char_bits, uint32_t setup_cycles, uint32_t gap_cycles) {
+  std::shared_ptr<Transaction> transaction = std::make_shared<Transaction>();
+  transaction->ss_low = start;
+  transaction->mosi = mosi;
+  transaction->connected = false;
+  double char_cycles = char_bits * (double)kCpuFrequency / sck_frequency;
+  uint8_t n = sercom_no_;
+  std::array<uint8_t, 4> pins = {{pins_[0], pins_[1], pins_[2], pins_[3]}}; // Copied, such that the events do not refer to the master
+  int mirror = mirror_pin_;
+
+  Schedule(start, [=]() {
+    SercomSlaveSelect(n, pins.data(), true);
+    transaction->connected = sercoms[n].active;
+    if (mirror >= 0) {
+      PinEdge(mirror);
+    }
+  });
+  double t = start + setup_cycles;
+  for (size_t i = 0; i < mosi.size(); i++) {
+    uint64_t char_start = (uint64_t)(t + 0.5);
+    uint64_t char_end = (uint64_t)(t + char_cycles + 0.5);
+    uint16_t data = mosi[i];
+    Schedule(char_start, [=]() { SercomCharStart(n); });
+    Schedule(char_end, [=]() { transaction->miso.push_back(SercomCharEnd(n, data)); });
+    t += char_cycles + gap_cycles;
+  }
+  transaction->ss_high = (uint64_t)(t - gap_cycles + 0.5) + setup_cycles;
+  Schedule(transaction->ss_high, [=]() {
+    SercomSlaveSelect(n, pins.data(), false);
+    if (mirror >= 0) {
+      PinEdge(mirror);
+    }
+  });
+  return transaction;
+}
+
+} // namespace sim
+
+// Core //
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+  sim::nvic_log.push_back({sim::NvicCall::kEnable, irq, 0});
+  sim::nvic_enabled[sim::Index(irq)] = true;
+  sim::Advance(sim::costs.peripheral_access);
+  sim::CheckInterrupts();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq) {
+  sim::nvic_log.push_back({sim::NvicCall::kDisable, irq, 0});
+  sim::nvic_enabled[sim::Index(irq)] = false;
+  sim::Advance(sim::costs.peripheral_access);
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+  sim::nvic_log.push_back({sim::NvicCall::kSetPriority, irq, priority});
+  sim::nvic_priority[sim::Index(irq)] = priority & 0x3;
+  sim::Advance(sim::costs.peripheral_access);
+  sim::CheckInterrupts();
+}
+
+uint32_t NVIC_GetPriority(IRQn_Type irq) {
+  return sim::nvic_priority[sim::Index(irq)];
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+  sim::nvic_pending[sim::Index(irq)] = true;
+  sim::Advance(sim::costs.peripheral_access);
+  sim::CheckInterrupts();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+  sim::nvic_pending[sim::Index(irq)] = false;
+  sim::Advance(sim::costs.peripheral_access);
+  sim::UpdateLines(); // A line that is still high makes the interrupt pending again
+  sim::CheckInterrupts();
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq) {
+  return sim::nvic_pending[sim::Index(irq)];
+}
+
+void __enable_irq() {
+  sim::primask = false;
+  sim::Advance(1);
+  sim::CheckInterrupts();
+}
+
+void __disable_irq() {
+  sim::primask = true;
+  sim::Advance(1);
+}
+
+uint32_t __get_PRIMASK() {
+  return sim::primask;
+}
+
+void __set_PRIMASK(uint32_t primask) {
+  sim::primask = primask & 0x1;
+  sim::Advance(1);
+  sim::CheckInterrupts();
+}
+
+void __WFI() {
+  /*
+  WFI returns when an interrupt is pending that would preempt the running code if PRIMASK were clear.
+  In standby (SCR.SLEEPDEEP) the CPU clock stops, so SysTick does not count and the core only wakes on the interrupts of the peripherals.
+  */
+  bool standby = sim_scb.SCR & SCB_SCR_SLEEPDEEP_Msk;
+  sim::UpdateLines();
+  while (true) {
+    bool primask = sim::primask;
+    sim::primask = false;
+    bool wake = sim::Preempting() >= 0;
+    sim::primask = primask;
+    if (wake) {
+      break;
+    }
+    uint64_t next = UINT64_MAX;
+    if (!sim::events.empty()) {
+      next = sim::events.top().cycle;
+    }
+    if (!standby && (sim_systick.CTRL.sim_raw & 0x1) && (sim::systick_next < next)) {
+      next = sim::systick_next;
+    }
+    if (next == UINT64_MAX) {
+      sim::Fail("WFI never wakes: no interrupt is pending and no event is scheduled");
+    }
+    uint64_t start = sim::now;
+    sim::AdvanceTo((next > sim::now) ? next : sim::now, !standby);
+    if (standby) {
+      sim::systick_next += sim::now - start; // SysTick was stopped
+    }
+    sim::UpdateLines();
+  }
+  if (standby) {
+    sim::counters.standby_wakes++;
+  } else {
+    sim::counters.idle_wakes++;
+  }
+}
+
+// Arduino core //
+
+unsigned long millis() {
+  sim::Advance(sim::costs.peripheral_access);
+  sim::CheckInterrupts();
+  return core_milliseconds;
+}
+
+unsigned long micros() {
+  sim::Advance(sim::costs.peripheral_access);
+  sim::CheckInterrupts();
+  return (unsigned long)(sim::now / (sim::kCpuFrequency / 1000000));
+}
+
+void delay(unsigned long ms) {
+  sim::Run((uint64_t)ms * (sim::kCpuFrequency / 1000));
+}
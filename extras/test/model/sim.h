@@ -0,0 +1,148 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Simulation of the ATSAMD21 around the library, for the host tests in extras/test.
+
+Time is counted in CPU cycles at 48 MHz. It advances only when the core executes: each access to a peripheral register or to a DMAC descriptor costs the cycles of the CostModel,
+an exception costs its entry and exit, and Run() lets the main loop idle while the peripherals progress. The code of the library between register accesses takes no time,
+so the cycle counts are an estimate that follows the number of register accesses and interrupts, not a measurement of the hardware.
+
+The peripherals advance at the events of the event queue, for instance the characters clocked by an SpiMaster, and the NVIC takes an interrupt at the first register access,
+or the first cycle of Run(), at which it is enabled, pending, of higher priority than the running code, and PRIMASK is clear.
+*/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "sam.h"
+
+namespace sim {
+
+static const uint32_t kCpuFrequency = 48000000; // CPU clock of the Arduino core, which also clocks Generic Clock Generator 0
+static const uint16_t kUndefined = 0xFFFF; // Character on MISO that the slave did not load, for instance after an underrun
+
+// Cycles charged for the work of the core
+struct CostModel {
+  uint32_t peripheral_access; // Load or store to a peripheral register through the AHB-APB bridge, with the instructions around it
+  uint32_t memory_access; // Load or store to a DMAC descriptor in SRAM
+  uint32_t exception_entry; // Interrupt latency of the Cortex-M0+: stacking and vector fetch
+  uint32_t exception_exit; // Unstacking
+  uint32_t handler_overhead; // Prologue, epilogue and dispatch of a handler, and the code between its register accesses
+};
+
+// Counters of the core since Reset()
+struct Counters {
+  uint64_t handler_cycles; // Cycles spent in exceptions, including entry and exit
+  uint32_t exceptions; // Number of exceptions taken
+  uint32_t idle_wakes; // WFI returns from idle sleep (SCR.SLEEPDEEP clear)
+  uint32_t standby_wakes; // WFI returns from standby (SCR.SLEEPDEEP set)
+  uint32_t max_nesting; // Deepest nesting of exceptions
+};
+
+// Call of the NVIC functions, in the order of the calls
+struct NvicCall {
+  enum Kind { kEnable, kDisable, kSetPriority } kind;
+  IRQn_Type irq;
+  uint32_t priority;
+};
+
+// Power-on reset of the model, followed by the initialization of the Arduino core: SysTick every millisecond at priority 2
+void Reset();
+
+CostModel& Costs(); // Cost model, reset to the defaults by Reset()
+const Counters& Stats();
+uint64_t Now(); // CPU cycles since Reset()
+
+// Let the main loop idle for a number of cycles, serving interrupts. The idle loop takes no cycles of its own.
+void Run(uint64_t cycles);
+void RunUntil(uint64_t cycle);
+
+// Call event at cycle, from the peripherals. Events at the same cycle are called in the order they are scheduled.
+void Schedule(uint64_t cycle, std::function<void()> event);
+
+// Inspection of the NVIC
+bool IrqEnabled(IRQn_Type irq);
+bool InHandler(); // true while an exception is active
+const std::vector<NvicCall>& NvicLog();
+void ClearNvicLog();
+
+// Last value written to GCLK->CLKCTRL for a Generic Clock ID, 0 if none
+uint16_t GclkClkctrl(uint8_t id);
+
+// Snapshot of all peripheral registers, to check that a call left them unchanged
+std::vector<uint8_t> PeripheralSnapshot();
+
+// Peripheral function of a pin connected to a PAD of a SERCOM, 0 if the pin is not connected. Reference: Atmel-42181G-SAM-D21_Datasheet section 7.1, functions C and D
+uint8_t SercomFunction(uint8_t sercom_no, uint8_t pin);
+int SercomPad(uint8_t sercom_no, uint8_t pin); // PAD of the SERCOM on a pin, -1 if the pin is not connected
+
+// Fault injection: the DMAC ignores the commands of a channel, such that a suspend is never acknowledged
+void DmacIgnoreCommands(uint8_t channel, bool ignore);
+
+// Transaction clocked by an SpiMaster
+struct Transaction {
+  uint64_t ss_low; // Cycle at which Slave Select goes low
+  uint64_t ss_high; // Cycle at which Slave Select goes high
+  std::vector<uint16_t> mosi; // Characters transmitted by the master
+  std::vector<uint16_t> miso; // Characters received by the master, kUndefined for a character the slave did not load
+  bool connected; // false if the pins were not routed to the SERCOM at Slave Select low, such that the slave saw nothing
+};
+
+/**
+ * @brief SPI master driving the pins of a SERCOM of the model, in SPI mode 0.
+ *
+ * The slave sees the transaction only if its four pins are routed to the PADs of its DIPO and DOPO and the SERCOM is enabled with its receiver.
+ */
+class SpiMaster {
+ public:
+  SpiMaster(uint8_t sercom_no, uint8_t mosi_pin, uint8_t sck_pin, uint8_t ss_pin, uint8_t miso_pin);
+
+  /**
+   * @brief Schedule a transaction
+   *
+   * @param[in] start Cycle at which Slave Select goes low
+   * @param[in] mosi Characters to transmit
+   * @param[in] sck_frequency Frequency of SCK in Hz
+   * @param[in] char_bits 8 or 9
+   * @param[in] setup_cycles Cycles from Slave Select low to the first SCK edge, and from the last SCK edge to Slave Select high
+   * @param[in] gap_cycles Cycles between characters
+   *
+   * @return Transaction, filled in as the characters are clocked. ss_high is known on return.
+   */
+  std::shared_ptr<Transaction> Transfer(uint64_t start, const std::vector<uint16_t>& mosi, double sck_frequency, uint8_t char_bits = 8, uint32_t setup_cycles = 48, uint32_t gap_cycles = 0);
+
+  // Mirror Slave Select on a second pin, for the timestamps of the slave on its capture pin
+  void MirrorSlaveSelect(uint8_t pin) { mirror_pin_ = pin; }
+
+ private:
+  uint8_t sercom_no_;
+  uint8_t pins_[4]; // MOSI, SCK, SS, MISO
+  int mirror_pin_;
+};
+
+} // namespace sim
+
+#endif
@@ -0,0 +1,57 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Checks of the host tests in extras/test. Each test is an executable that returns 0 if all its checks pass, run by CTest.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+// Record a failure if condition is false, and continue with the test
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      test_failures++; \
+    } \
+  } while (0)
+
+// Record a failure if actual differs from expected, printing both as unsigned integers
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    unsigned long long test_expected = (unsigned long long)(expected); \
+    unsigned long long test_actual = (unsigned long long)(actual); \
+    if (test_expected != test_actual) { \
+      fprintf(stderr, "%s:%d: CHECK_EQUAL(%s, %s) failed: expected 0x%llx, actual 0x%llx\n", __FILE__, __LINE__, #expected, #actual, test_expected, test_actual); \
+      test_failures++; \
+    } \
+  } while (0)
+
+// Result of the test, returned from main()
+#define TEST_RESULT() \
+  ((test_failures == 0) ? (printf("%s: passed\n", __FILE__), 0) : (fprintf(stderr, "%s: %d checks failed\n", __FILE__, test_failures), 1))
+
+#endif
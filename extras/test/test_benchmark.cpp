@@ -0,0 +1,148 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Benchmark of the slave against the simulated master, run as a regression gate.
+
+For each interrupt profile and frame size, a binary search finds the highest SCK frequency at which a burst of frames is received without overflows or drops,
+and with every byte intact. At that frequency the benchmark reports the bytes per second received and the share of the CPU left to the main loop.
+The cycle counts follow the CostModel of the simulation, not the hardware, so the gate catches changes of the number of register accesses and interrupts per character.
+The floors below are set somewhat under the results of the model, and must only be lowered with a reason.
+*/
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+volatile uint8_t dma_buffer[512];
+uint8_t rx_frame[256];
+
+const uint16_t kFrames = 20; // Transactions per run
+const uint32_t kGapCycles = 20 * 48; // Time between transactions, 20 us
+const uint32_t kMinFrequency = 100000;
+const uint32_t kMaxFrequency = 24000000; // Half the frequency of the Generic Clock of the SERCOM
+
+struct Result {
+  bool ok; // No overflows or drops, and every byte received intact
+  double bytes_per_second;
+  double headroom; // Share of the cycles not spent in exceptions
+  uint32_t isr_max_cycles;
+};
+
+Result Run(SercomSPISlave::InterruptProfile profile, uint16_t frame_size, uint32_t sck_frequency) {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, profile));
+  if (profile == SercomSPISlave::kDmaAssisted) {
+    CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer)));
+  }
+  slave.resetStats();
+  std::vector<uint16_t> mosi(frame_size);
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  bool intact = true;
+  size_t dma_position = 0;
+  uint64_t start = sim::Now() + 1000;
+  uint64_t next = start;
+  for (uint16_t i = 0; i < kFrames; i++) {
+    for (uint16_t j = 0; j < frame_size; j++) {
+      mosi[j] = (uint8_t)(i * 7 + j);
+    }
+    std::shared_ptr<sim::Transaction> transaction = master.Transfer(next, mosi, sck_frequency);
+    sim::RunUntil(transaction->ss_high + kGapCycles / 2);
+    // The main loop takes the frame during the gap
+    if (profile == SercomSPISlave::kDmaAssisted) {
+      for (uint16_t j = 0; j < frame_size; j++) {
+        intact = intact && (dma_buffer[(dma_position + j) % sizeof(dma_buffer)] == mosi[j]);
+      }
+      dma_position = (dma_position + frame_size) % sizeof(dma_buffer);
+    } else {
+      size_t length = slave.read(rx_frame, sizeof(rx_frame));
+      intact = intact && (length == frame_size);
+      for (size_t j = 0; j < length; j++) {
+        intact = intact && (rx_frame[j] == mosi[j]);
+      }
+    }
+    next = transaction->ss_high + kGapCycles;
+  }
+  sim::RunUntil(next);
+  SercomSPISlave::Stats stats = slave.getStats();
+  slave.disableDMA();
+  double seconds = (double)(next - start) / sim::kCpuFrequency;
+  Result result;
+  result.ok = intact && (stats.overflows == 0) && (stats.drops == 0) && (stats.chars_received == (uint32_t)kFrames * frame_size);
+  result.bytes_per_second = stats.chars_received / seconds;
+  result.headroom = 1.0 - (double)sim::Stats().handler_cycles / (next - start);
+  result.isr_max_cycles = stats.isr_max_cycles;
+  return result;
+}
+
+// Highest SCK frequency, within 1%, at which the slave receives every frame
+uint32_t MaxFrequency(SercomSPISlave::InterruptProfile profile, uint16_t frame_size) {
+  if (!Run(profile, frame_size, kMinFrequency).ok) {
+    return 0;
+  }
+  if (Run(profile, frame_size, kMaxFrequency).ok) {
+    return kMaxFrequency;
+  }
+  uint32_t low = kMinFrequency;
+  uint32_t high = kMaxFrequency;
+  while (high - low > low / 100) {
+    uint32_t middle = low + (high - low) / 2;
+    if (Run(profile, frame_size, middle).ok) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+int main() {
+  struct Case {
+    SercomSPISlave::InterruptProfile profile;
+    const char* name;
+    uint16_t frame_size;
+    uint32_t floor; // Regression gate: lowest accepted maximum SCK frequency in Hz
+  };
+  const Case cases[] = {
+      {SercomSPISlave::kFullDuplex, "kFullDuplex", 4, 3800000},
+      {SercomSPISlave::kFullDuplex, "kFullDuplex", 32, 3400000},
+      {SercomSPISlave::kFullDuplex, "kFullDuplex", 128, 2600000},
+      {SercomSPISlave::kReceiveOnly, "kReceiveOnly", 4, 3800000},
+      {SercomSPISlave::kReceiveOnly, "kReceiveOnly", 32, 3400000},
+      {SercomSPISlave::kReceiveOnly, "kReceiveOnly", 128, 2600000},
+      {SercomSPISlave::kDmaAssisted, "kDmaAssisted", 4, 21000000},
+      {SercomSPISlave::kDmaAssisted, "kDmaAssisted", 32, 21000000},
+      {SercomSPISlave::kDmaAssisted, "kDmaAssisted", 128, 21000000},
+  };
+  printf("profile, frame bytes, max SCK Hz, bytes/s, headroom %%, ISR max cycles, maxSckFrequency() Hz\n");
+  for (const Case& c : cases) {
+    uint32_t frequency = MaxFrequency(c.profile, c.frame_size);
+    Result result = Run(c.profile, c.frame_size, frequency);
+    printf("%s, %u, %u, %.0f, %.1f, %u, %u\n", c.name, c.frame_size, frequency, result.bytes_per_second, 100 * result.headroom, result.isr_max_cycles,
+           SercomSPISlave::maxSckFrequency((c.profile == SercomSPISlave::kDmaAssisted) ? 0 : result.isr_max_cycles));
+    CHECK(frequency >= c.floor);
+  }
+  return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the CRC: the check values of the CRC catalogue, and the verdict of enableCrc() on the frames received by the slave,
+with and without the DMA receive path.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+volatile uint8_t dma_buffer[32];
+const SercomSPISlaveCrc crc8(8, 0x07, 0x00, false, 0x00);
+const SercomSPISlaveCrc crc16(16, 0x1021, 0xFFFF, false, 0x0000);
+const SercomSPISlaveCrc crc32(32, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF);
+const uint8_t check[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+// Message followed by its CRC, as transmitted by the master
+std::vector<uint16_t> WithCrc(const SercomSPISlaveCrc& crc, const std::vector<uint16_t>& message) {
+  uint8_t bytes[32];
+  for (size_t i = 0; i < message.size(); i++) {
+    bytes[i] = message[i];
+  }
+  size_t length = crc.Append(bytes, message.size());
+  return std::vector<uint16_t>(bytes, bytes + length);
+}
+
+void Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+// Check values of the CRC catalogue, over the ASCII digits 1 to 9
+void CheckCatalogue() {
+  CHECK_EQUAL(0xF4, crc8.Compute(check, sizeof(check)));
+  CHECK_EQUAL(0x29B1, crc16.Compute(check, sizeof(check)));
+  CHECK_EQUAL(0xCBF43926, crc32.Compute(check, sizeof(check)));
+
+  // The CRC is transmitted most significant byte first if not reflected, least significant byte first if reflected
+  uint8_t bytes[4];
+  crc16.ToBytes(0x29B1, bytes);
+  CHECK_EQUAL(0x29, bytes[0]);
+  CHECK_EQUAL(0xB1, bytes[1]);
+  crc32.ToBytes(0xCBF43926, bytes);
+  CHECK_EQUAL(0x26, bytes[0]);
+  CHECK_EQUAL(0xCB, bytes[3]);
+  CHECK_EQUAL(0x29B1, crc16.FromBytes(0x29B1));
+  CHECK_EQUAL(0xCBF43926, crc32.FromBytes(0x2639F4CB));
+}
+
+// The verdict of each frame is delivered by readFrame(), and the frames of which the CRC does not match are counted
+void CheckReadFrame() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  CHECK(slave.enableCrc(&crc16));
+  slave.enableFraming();
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  Transfer(master, WithCrc(crc16, {'1', '2', '3', '4', '5', '6', '7', '8', '9'}));
+  std::vector<uint16_t> corrupted = WithCrc(crc16, {1, 2, 3});
+  corrupted[1] ^= 0x10;
+  Transfer(master, corrupted);
+  Transfer(master, {0x55}); // Not longer than the CRC
+
+  uint8_t frame[16];
+  bool crc_valid = false;
+  uint32_t crc = 0;
+  CHECK_EQUAL(11, slave.readFrame(frame, sizeof(frame), &crc_valid, &crc));
+  CHECK(crc_valid);
+  CHECK_EQUAL(0x29B1, crc);
+  CHECK_EQUAL(5, slave.readFrame(frame, sizeof(frame), &crc_valid, &crc));
+  CHECK(!crc_valid);
+  CHECK_EQUAL(1, slave.readFrame(frame, sizeof(frame), &crc_valid));
+  CHECK(!crc_valid);
+  CHECK_EQUAL(2, slave.getStats().crc_errors);
+
+  // Without enableCrc(), the verdict is false and nothing is counted
+  slave.disableCrc();
+  slave.resetStats();
+  Transfer(master, WithCrc(crc16, {1, 2, 3}));
+  CHECK_EQUAL(5, slave.readFrame(frame, sizeof(frame), &crc_valid));
+  CHECK(!crc_valid);
+  CHECK_EQUAL(0, slave.getStats().crc_errors);
+}
+
+// With the DMA receive path, the CRC is updated per block on the DMA events
+void CheckDma() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted));
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer)));
+  CHECK(slave.enableCrc(&crc32));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  uint32_t crc = 0;
+  Transfer(master, WithCrc(crc32, {'1', '2', '3', '4', '5', '6', '7', '8', '9', 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20}));
+  CHECK(slave.lastTransactionCrc(&crc));
+  Transfer(master, WithCrc(crc32, {'1', '2', '3', '4', '5', '6', '7', '8', '9'})); // Across the end of the circular buffer
+  CHECK(slave.lastTransactionCrc(&crc));
+  CHECK_EQUAL(0xCBF43926, crc);
+  std::vector<uint16_t> corrupted = WithCrc(crc32, {1, 2, 3, 4});
+  corrupted.back() ^= 0x01;
+  Transfer(master, corrupted);
+  CHECK(!slave.lastTransactionCrc());
+  CHECK_EQUAL(1, slave.getStats().crc_errors);
+  slave.disableDMA();
+}
+
+int main() {
+  CheckCatalogue();
+  CheckReadFrame();
+  CheckDma();
+  return TEST_RESULT();
+}
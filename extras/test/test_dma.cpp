@@ -0,0 +1,179 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the DMA receive path: reception into the circular buffer, dmaPosition() when the DMAC does not suspend the channel,
+sharing the descriptor tables of a DMAC configured before the library, and the priority of the DMAC interrupt.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+Sercom2SPISlave slave2;
+volatile uint8_t dma_buffer[16];
+volatile uint8_t dma_buffer2[16];
+size_t last_position = 0;
+int transaction_ends = 0;
+
+// Descriptor tables of another user of the DMAC
+__attribute__((__aligned__(16))) DmacDescriptor other_descriptors[DMAC_CH_NUM];
+__attribute__((__aligned__(16))) DmacDescriptor other_writeback[DMAC_CH_NUM];
+
+void OnDmaEvent(SercomSPISlave::DmaEvent event, size_t position) {
+  if (event == SercomSPISlave::kDmaTransactionEnd) {
+    transaction_ends++;
+    last_position = position;
+  }
+}
+
+void Init() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted));
+  transaction_ends = 0;
+}
+
+void Receive(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 2000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+// The DMAC writes the characters into the circular buffer, across the end of the buffer
+void CheckReceive() {
+  Init();
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  CHECK(sim_dmac.BASEADDR.sim_raw != 0);
+  Receive(master, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  CHECK_EQUAL(1, transaction_ends);
+  CHECK_EQUAL(10, last_position);
+  CHECK_EQUAL(10, slave.dmaPosition());
+  Receive(master, {11, 12, 13, 14, 15, 16, 17, 18});
+  CHECK_EQUAL(2, transaction_ends);
+  CHECK_EQUAL(2, last_position);
+  CHECK_EQUAL(17, dma_buffer[0]);
+  CHECK_EQUAL(18, dma_buffer[1]);
+  CHECK_EQUAL(16, dma_buffer[15]);
+  CHECK_EQUAL(18, slave.getStats().chars_received);
+  slave.disableDMA();
+}
+
+// A channel that does not suspend does not hang dmaPosition() or the end of a transaction
+void CheckSuspendTimeout() {
+  Init();
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  Receive(master, {1, 2, 3});
+  sim::DmacIgnoreCommands(0, true);
+  uint64_t start = sim::Now();
+  CHECK_EQUAL(SercomSPISlave::kDmaPositionError, slave.dmaPosition());
+  CHECK(sim::Now() - start < 48 * 100); // Less than 100 us
+  Receive(master, {4, 5});
+  CHECK_EQUAL(2, transaction_ends);
+  CHECK_EQUAL(2, slave.getStats().transactions);
+  sim::DmacIgnoreCommands(0, false);
+  CHECK_EQUAL(5, slave.dmaPosition()); // The channel kept receiving
+  slave.disableDMA();
+}
+
+// A DMAC configured before the library keeps its tables and its channels
+void CheckSharedTables() {
+  Init();
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+  DMAC->BASEADDR.reg = (uint32_t)(uintptr_t)other_descriptors;
+  DMAC->WRBADDR.reg = (uint32_t)(uintptr_t)other_writeback;
+  DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0x1);
+  other_descriptors[5].BTCTRL.reg = DMAC_BTCTRL_VALID;
+  other_descriptors[5].BTCNT.reg = 0x1234;
+
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  CHECK_EQUAL((uint32_t)(uintptr_t)other_descriptors, sim_dmac.BASEADDR.sim_raw);
+  CHECK_EQUAL((uint32_t)(uintptr_t)other_writeback, sim_dmac.WRBADDR.sim_raw);
+  CHECK_EQUAL(0x1234, other_descriptors[5].BTCNT.sim_raw);
+  CHECK(other_descriptors[0].BTCTRL.sim_raw & DMAC_BTCTRL_VALID);
+  Receive(master, {1, 2, 3});
+  CHECK_EQUAL(3, last_position);
+  CHECK_EQUAL(3, slave.dmaPosition());
+  CHECK_EQUAL(3, dma_buffer[2]);
+  slave.disableDMA();
+
+  // After a reset of the DMAC, the library installs its own tables again
+  Init();
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  CHECK(sim_dmac.BASEADDR.sim_raw != (uint32_t)(uintptr_t)other_descriptors);
+  Receive(master, {1, 2});
+  CHECK_EQUAL(2, slave.dmaPosition());
+  slave.disableDMA();
+}
+
+// The DMAC interrupt takes the highest priority of the slaves using the DMAC, set before it is enabled
+void CheckPriority() {
+  typedef Sercom1SPISlave::Pins P1;
+  typedef Sercom2SPISlave::Pins P2;
+  sim::Reset();
+  CHECK(slave.SercomInit(P1::PA16, P1::PA17, P1::PA18, P1::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted, 3));
+  sim::ClearNvicLog();
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  CHECK_EQUAL(3, NVIC_GetPriority(DMAC_IRQn));
+  const std::vector<sim::NvicCall>& log = sim::NvicLog();
+  bool priority_set = false;
+  for (const sim::NvicCall& call : log) {
+    if ((call.irq == DMAC_IRQn) && (call.kind == sim::NvicCall::kSetPriority)) {
+      priority_set = true;
+    }
+    if ((call.irq == DMAC_IRQn) && (call.kind == sim::NvicCall::kEnable)) {
+      CHECK(priority_set);
+    }
+  }
+  CHECK(sim::IrqEnabled(DMAC_IRQn));
+
+  CHECK(slave2.SercomInit(P2::PA08, P2::PA09, P2::PA10, P2::PA11, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted, 1));
+  CHECK(slave2.enableDMA(1, dma_buffer2, sizeof(dma_buffer2), NULL));
+  CHECK_EQUAL(1, NVIC_GetPriority(DMAC_IRQn));
+  slave.disableDMA();
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent)); // A slave of a lower priority does not lower it
+  CHECK_EQUAL(1, NVIC_GetPriority(DMAC_IRQn));
+
+  // Both slaves receive, with their DMA events served between their transactions
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  sim::SpiMaster master2(2, 8, 9, 10, 11);
+  master2.Transfer(sim::Now() + 1003, {21, 22, 23, 24, 25, 26, 27, 28, 29}, 1000000);
+  Receive(master, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  CHECK_EQUAL(9, slave.dmaPosition());
+  CHECK_EQUAL(9, slave2.dmaPosition());
+  CHECK_EQUAL(9, dma_buffer[8]);
+  CHECK_EQUAL(29, dma_buffer2[8]);
+  slave.disableDMA();
+  slave2.disableDMA();
+}
+
+int main() {
+  CheckReceive();
+  CheckSuspendTimeout();
+  CheckSharedTables();
+  CheckPriority();
+  return TEST_RESULT();
+}
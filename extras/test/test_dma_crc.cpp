@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of enableDmaCrc(): the CRC engine of the DMAC checks the residue of each transaction of the DMA receive path,
+for a good and a corrupted transaction, with CRC-16 and CRC-32.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+volatile uint8_t dma_buffer[32];
+const SercomSPISlaveCrc crc16(16, 0x1021, 0xFFFF, false, 0x0000); // CRC of the engine with kDmaCrc16
+const SercomSPISlaveCrc crc32(32, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF); // CRC of the engine with kDmaCrc32
+int verdicts = 0;
+bool last_valid = false;
+
+void OnDmaEvent(SercomSPISlave::DmaEvent event, size_t position) {
+  if (event == SercomSPISlave::kDmaTransactionEnd) {
+    verdicts++;
+    last_valid = slave.lastTransactionCrc();
+  }
+}
+
+// Message followed by its CRC, as transmitted by the master
+std::vector<uint16_t> WithCrc(const SercomSPISlaveCrc& crc, const std::vector<uint16_t>& message) {
+  uint8_t bytes[32];
+  for (size_t i = 0; i < message.size(); i++) {
+    bytes[i] = message[i];
+  }
+  size_t length = crc.Append(bytes, message.size());
+  return std::vector<uint16_t>(bytes, bytes + length);
+}
+
+void Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 2000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+void CheckPolynomial(SercomSPISlave::DmaCrc polynomial, const SercomSPISlaveCrc& crc) {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  verdicts = 0;
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted));
+  CHECK(!slave.enableDmaCrc(polynomial)); // The DMA receive path is not enabled
+  CHECK(slave.enableDMA(0, dma_buffer, sizeof(dma_buffer), OnDmaEvent));
+  CHECK(slave.enableDmaCrc(polynomial));
+  CHECK(!slave.enableCrc(&crc)); // enableCrc() and enableDmaCrc() exclude each other
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+
+  Transfer(master, WithCrc(crc, {'1', '2', '3', '4', '5', '6', '7', '8', '9'}));
+  CHECK_EQUAL(1, verdicts);
+  CHECK(last_valid);
+
+  // A corrupted byte, across the end of the circular buffer
+  std::vector<uint16_t> corrupted = WithCrc(crc, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20});
+  corrupted[5] ^= 0x80;
+  Transfer(master, corrupted);
+  CHECK_EQUAL(2, verdicts);
+  CHECK(!last_valid);
+  CHECK_EQUAL(1, slave.getStats().crc_errors);
+
+  // The checksum is restarted between transactions
+  Transfer(master, WithCrc(crc, {0xA5, 0x5A}));
+  CHECK_EQUAL(3, verdicts);
+  CHECK(last_valid);
+  CHECK_EQUAL(1, slave.getStats().crc_errors);
+
+  // A transaction not longer than the CRC fails
+  Transfer(master, std::vector<uint16_t>(crc.Bytes(), 0));
+  CHECK(!last_valid);
+  CHECK_EQUAL(2, slave.getStats().crc_errors);
+  slave.disableDmaCrc();
+  CHECK_EQUAL(0, sim_dmac.CTRL.sim_raw & DMAC_CTRL_CRCENABLE);
+  slave.disableDMA();
+}
+
+int main() {
+  CheckPolynomial(SercomSPISlave::kDmaCrc16, crc16);
+  CheckPolynomial(SercomSPISlave::kDmaCrc32, crc32);
+  return TEST_RESULT();
+}
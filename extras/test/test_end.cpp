@@ -0,0 +1,105 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of end() and begin(): the functions that rewrite the configuration of a stopped slave leave the SERCOM, its interrupt and its pins disabled,
+and begin() resumes the slave with the new configuration.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+SercomSPISlave::TimestampStorage storage;
+const uint8_t pins[4] = {16, 17, 18, 19};
+uint8_t response[2] = {0x31, 0x32}; // The DMAC of the model reaches only the global memory of the test
+
+bool PinsConnected() {
+  for (uint8_t i = 0; i < 4; i++) {
+    if (!(sim_port.Group[0].PINCFG[pins[i]].sim_raw & PORT_PINCFG_PMUXEN)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CheckStopped() {
+  CHECK(!(sim_sercom[1].SPI.CTRLA.sim_raw & SERCOM_SPI_CTRLA_ENABLE));
+  CHECK(!sim::IrqEnabled(SERCOM1_IRQn));
+  CHECK(!PinsConnected());
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  CHECK(slave.begin()); // Already running
+  slave.end();
+  CheckStopped();
+
+  CHECK(slave.setMode(1, 1, 0));
+  CheckStopped();
+  CHECK_EQUAL(SERCOM_SPI_CTRLA_CPOL | SERCOM_SPI_CTRLA_CPHA, sim_sercom[1].SPI.CTRLA.sim_raw & (SERCOM_SPI_CTRLA_CPOL | SERCOM_SPI_CTRLA_CPHA));
+  CHECK(slave.setMode(0, 0, 0));
+  CHECK(slave.setCharSize(SercomSPISlave::kCharSize8));
+  slave.enableStandby(SercomSPISlave::kWakeOnTransactionEnd);
+  CHECK(slave.enableTimestamps(SercomPin::PA20, 0, &storage));
+  slave.enableFraming();
+  CheckStopped();
+  CHECK(sim_sercom[1].SPI.CTRLB.sim_raw & SERCOM_SPI_CTRLB_SSDE);
+
+  // The master clocks a transaction the stopped slave does not see
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  master.MirrorSlaveSelect(20);
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {1, 2, 3}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK(!transaction->connected);
+  CHECK_EQUAL(0, slave.availableFrames());
+
+  CHECK(slave.begin());
+  CHECK(sim_sercom[1].SPI.CTRLA.sim_raw & SERCOM_SPI_CTRLA_ENABLE);
+  CHECK(sim::IrqEnabled(SERCOM1_IRQn));
+  CHECK(PinsConnected());
+  slave.write((uint8_t)0xA5);
+  transaction = master.Transfer(sim::Now() + 1000, {4, 5, 6}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK(transaction->connected);
+  CHECK_EQUAL(0xA5, transaction->miso[0]);
+  uint8_t frame[4];
+  CHECK_EQUAL(3, slave.readFrame(frame, sizeof(frame)));
+  CHECK_EQUAL(4, frame[0]);
+  CHECK(slave.lastFrameTimestamps().valid);
+
+  // The DMA transmit path of a stopped slave is restarted by begin()
+  SercomSPISlave::Segment segment = {response, sizeof(response)};
+  CHECK(slave.enableTxDMA(1));
+  slave.end();
+  CHECK(slave.setResponseSegments(&segment, 1));
+  CheckStopped();
+  CHECK(slave.begin());
+  transaction = master.Transfer(sim::Now() + 1000, {7, 8}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  std::vector<uint16_t> expected = {0x31, 0x32};
+  CHECK(expected == transaction->miso);
+  return TEST_RESULT();
+}
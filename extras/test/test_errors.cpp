@@ -0,0 +1,75 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the recovery from buffer overflows: a transaction that overflows is dropped, and the next transaction is delivered.
+The overflow is caused by a critical section of the application that masks the interrupts for the whole transaction,
+such that Receive Complete, Error and Transmit Complete are served by the same call of IrqHandler().
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+uint32_t error_callbacks = 0;
+
+void OnError(uint32_t overflows) {
+  error_callbacks = overflows;
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  slave.enableFraming();
+  slave.setErrorCallback(OnError);
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+
+  // The first character stays in DATA, and the second one overflows
+  std::shared_ptr<sim::Transaction> overflowed = master.Transfer(sim::Now() + 1000, {1, 2, 3}, 1000000);
+  __disable_irq();
+  sim::RunUntil(overflowed->ss_high + 100);
+  __enable_irq();
+  sim::Run(5000);
+  SercomSPISlave::Stats stats = slave.getStats();
+  CHECK(stats.overflows > 0);
+  CHECK_EQUAL(stats.overflows, error_callbacks);
+  CHECK_EQUAL(1, stats.transactions);
+  CHECK_EQUAL(1, stats.frames_dropped);
+  CHECK_EQUAL(0, slave.availableFrames());
+  CHECK_EQUAL(0, slave.available());
+
+  // The next transaction is received completely
+  std::shared_ptr<sim::Transaction> next = master.Transfer(sim::Now() + 1000, {7, 8, 9}, 1000000);
+  sim::RunUntil(next->ss_high + 5000);
+  stats = slave.getStats();
+  CHECK_EQUAL(2, stats.transactions);
+  CHECK_EQUAL(1, stats.frames_dropped);
+  CHECK_EQUAL(1, slave.availableFrames());
+  uint8_t frame[8] = {0};
+  CHECK_EQUAL(3, slave.readFrame(frame, sizeof(frame)));
+  CHECK_EQUAL(7, frame[0]);
+  CHECK_EQUAL(8, frame[1]);
+  CHECK_EQUAL(9, frame[2]);
+  return TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the frame pool: the order of the free and ready lists, the high-water mark, the rejection of a slot returned twice or not lent,
+and the frames received into the pool by the slave.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+SercomSPISlaveFramePoolT<3, 4> pool;
+uint8_t foreign[4];
+
+void Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+int main() {
+  // The free slots are claimed in order after Clear(), and a released slot is claimed first
+  CHECK_EQUAL(3, pool.Free());
+  CHECK_EQUAL(0, pool.Claim());
+  CHECK_EQUAL(1, pool.Claim());
+  CHECK_EQUAL(2, pool.Claim());
+  CHECK_EQUAL(-1, pool.Claim());
+  CHECK_EQUAL(3, pool.HighWaterMark());
+  CHECK(pool.Release(1));
+  CHECK(pool.Release(0));
+  CHECK(!pool.Release(0)); // Released twice
+  CHECK_EQUAL(2, pool.Free());
+  CHECK_EQUAL(0, pool.Claim());
+  CHECK_EQUAL(1, pool.Claim());
+
+  // The ready frames are taken in the order they were committed
+  pool.Commit(2, 3);
+  pool.Commit(0, 1);
+  CHECK_EQUAL(2, pool.Available());
+  uint16_t length = 0;
+  CHECK_EQUAL(2, pool.Take(&length));
+  CHECK_EQUAL(3, length);
+  CHECK_EQUAL(0, pool.Take(&length));
+  CHECK_EQUAL(1, length);
+  CHECK_EQUAL(-1, pool.Take(&length));
+  CHECK(!pool.Return(1)); // Claimed, not lent
+  CHECK(!pool.Release(2)); // Lent, not claimed
+  CHECK(pool.Return(2));
+  CHECK(pool.Return(0));
+  CHECK(!pool.Return(0)); // Returned twice
+  CHECK(pool.Release(1));
+  CHECK_EQUAL(3, pool.Free());
+  CHECK_EQUAL(3, pool.HighWaterMark());
+  pool.ResetHighWaterMark();
+  CHECK_EQUAL(0, pool.HighWaterMark());
+  CHECK_EQUAL(-1, pool.SlotOf(pool.Slot(0) + 1));
+  CHECK_EQUAL(-1, pool.SlotOf(foreign));
+  pool.Clear();
+
+  // Frames received by the slave
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  CHECK(slave.enableFramePool(&pool));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  Transfer(master, {1, 2});
+  Transfer(master, {3, 4, 5});
+  size_t frame_length = 0;
+  uint8_t* first = slave.lendFrame(&frame_length);
+  CHECK(first == pool.Slot(0));
+  CHECK_EQUAL(2, frame_length);
+  CHECK_EQUAL(1, first[0]);
+  uint8_t* second = slave.lendFrame(&frame_length); // Several frames are lent at the same time
+  CHECK(second == pool.Slot(1));
+  CHECK_EQUAL(3, frame_length);
+  CHECK_EQUAL(5, second[2]);
+  CHECK(slave.lendFrame() == NULL);
+
+  // Returning a buffer twice, or a buffer that is not a lent slot, is rejected
+  CHECK(slave.returnFrame(first));
+  CHECK(!slave.returnFrame(first));
+  CHECK(!slave.returnFrame(foreign));
+  CHECK(!slave.returnFrame(second + 1));
+  CHECK(!slave.returnFrame(pool.Slot(2))); // Free
+  CHECK_EQUAL(2, pool.Free());
+
+  // A slot that was never lent, such as the one claimed by the receive path during a transaction, is not returned
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {6, 7, 8}, 1000000);
+  sim::RunUntil(transaction->ss_low + 600); // The first character has claimed slot 0
+  CHECK_EQUAL(1, pool.Free());
+  CHECK(!slave.returnFrame(pool.Slot(0)));
+  sim::RunUntil(transaction->ss_high + 5000);
+  uint8_t* third = slave.lendFrame(&frame_length);
+  CHECK(third == pool.Slot(0));
+  CHECK_EQUAL(3, frame_length);
+  CHECK_EQUAL(6, third[0]);
+
+  // With no slot free, a frame is dropped
+  Transfer(master, {9});
+  CHECK_EQUAL(0, pool.Free());
+  Transfer(master, {10});
+  CHECK_EQUAL(1, slave.getStats().frames_dropped);
+  CHECK_EQUAL(3, pool.HighWaterMark());
+  uint8_t* fourth = slave.lendFrame(&frame_length);
+  CHECK(fourth == pool.Slot(2));
+  CHECK_EQUAL(9, fourth[0]);
+  CHECK(slave.returnFrame(second));
+  CHECK(slave.returnFrame(third));
+  CHECK(slave.returnFrame(fourth));
+  CHECK_EQUAL(3, pool.Free());
+
+  // A frame that does not fit in a slot is dropped, and its slot freed
+  Transfer(master, {11, 12, 13, 14, 15});
+  CHECK_EQUAL(2, slave.getStats().frames_dropped);
+  CHECK_EQUAL(3, pool.Free());
+  CHECK(slave.lendFrame() == NULL);
+  return TEST_RESULT();
+}
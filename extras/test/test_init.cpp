@@ -0,0 +1,206 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of SercomInit(): for every combination of four distinct pins of each SERCOM, SercomInit() succeeds exactly when the datasheet can route the PADs,
+and then sets CTRLA, CTRLB, INTENSET, the PORT multiplexing, the Generic Clock and the NVIC. A combination it rejects leaves every register unchanged.
+The expected values are derived from the datasheet tables in sim.cpp, not from the pin table of the library.
+*/
+
+#include <Arduino.h>
+
+#include <vector>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom0SPISlave slave0;
+Sercom1SPISlave slave1;
+Sercom2SPISlave slave2;
+Sercom3SPISlave slave3;
+Sercom4SPISlave slave4;
+Sercom5SPISlave slave5;
+SercomSPISlaveT<1, SercomPin::PA16, SercomPin::PA17, SercomPin::PA18, SercomPin::PA19> slave_t;
+
+struct Expected {
+  int dipo; // -1 if the combination cannot be routed
+  int dopo;
+};
+
+// DIPO and DOPO of a combination of pins. Reference: Atmel-42181G-SAM-D21_Datasheet page 493
+Expected Route(uint8_t sercom_no, const uint8_t* pins) {
+  static const int kDopoPads[4][3] = {{0, 1, 2}, {2, 3, 1}, {3, 1, 2}, {0, 3, 1}}; // MISO, SCK, SS
+  int mosi = sim::SercomPad(sercom_no, pins[0]);
+  int sck = sim::SercomPad(sercom_no, pins[1]);
+  int ss = sim::SercomPad(sercom_no, pins[2]);
+  int miso = sim::SercomPad(sercom_no, pins[3]);
+  for (int dopo = 0; dopo < 4; dopo++) {
+    if ((miso == kDopoPads[dopo][0]) && (sck == kDopoPads[dopo][1]) && (ss == kDopoPads[dopo][2]) && (mosi >= 0) && (mosi != miso) && (mosi != sck) && (mosi != ss)) {
+      return {mosi, dopo};
+    }
+  }
+  return {-1, -1};
+}
+
+uint8_t PinFunction(uint8_t pin) {
+  PortGroup& group = sim_port.Group[pin / 32];
+  uint8_t pmux = group.PMUX[(pin % 32) / 2].sim_raw;
+  return ((pin % 2) == 0) ? (pmux & 0xF) : (pmux >> 4);
+}
+
+// Index of the first call of kind for irq in the NVIC log, -1 if none
+int NvicCallIndex(sim::NvicCall::Kind kind, IRQn_Type irq) {
+  const std::vector<sim::NvicCall>& log = sim::NvicLog();
+  for (size_t i = 0; i < log.size(); i++) {
+    if ((log[i].kind == kind) && (log[i].irq == irq)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Registers after a successful SercomInit()
+void CheckInitialized(uint8_t sercom_no, const uint8_t* pins, Expected route, uint8_t char_size, uint8_t interrupts, uint8_t priority, uint8_t generator) {
+  SercomSpi& spi = sim_sercom[sercom_no].SPI;
+  CHECK_EQUAL(SERCOM_SPI_CTRLA_ENABLE | SERCOM_SPI_CTRLA_MODE(2) | SERCOM_SPI_CTRLA_RUNSTDBY | SERCOM_SPI_CTRLA_IBON | SERCOM_SPI_CTRLA_DOPO(route.dopo) | SERCOM_SPI_CTRLA_DIPO(route.dipo), spi.CTRLA.sim_raw);
+  CHECK_EQUAL(SERCOM_SPI_CTRLB_CHSIZE(char_size) | SERCOM_SPI_CTRLB_PLOADEN | SERCOM_SPI_CTRLB_SSDE | SERCOM_SPI_CTRLB_RXEN, spi.CTRLB.sim_raw);
+  CHECK_EQUAL(interrupts, spi.INTENSET.sim_raw);
+  for (uint8_t i = 0; i < 4; i++) {
+    CHECK(sim_port.Group[pins[i] / 32].PINCFG[pins[i] % 32].sim_raw & PORT_PINCFG_PMUXEN);
+    CHECK_EQUAL(sim::SercomFunction(sercom_no, pins[i]), PinFunction(pins[i]));
+  }
+  CHECK_EQUAL(GCLK_CLKCTRL_ID(GCM_SERCOM0_CORE + sercom_no) | GCLK_CLKCTRL_GEN(generator) | GCLK_CLKCTRL_CLKEN, sim::GclkClkctrl(GCM_SERCOM0_CORE + sercom_no));
+  CHECK(sim::IrqEnabled((IRQn_Type)(SERCOM0_IRQn + sercom_no)));
+  CHECK_EQUAL(priority, NVIC_GetPriority((IRQn_Type)(SERCOM0_IRQn + sercom_no)));
+  // The priority is set before the interrupt is enabled
+  int set_priority = NvicCallIndex(sim::NvicCall::kSetPriority, (IRQn_Type)(SERCOM0_IRQn + sercom_no));
+  CHECK(set_priority >= 0);
+  CHECK(set_priority < NvicCallIndex(sim::NvicCall::kEnable, (IRQn_Type)(SERCOM0_IRQn + sercom_no)));
+}
+
+// Every combination of four distinct pins of a SERCOM
+template <typename Slave>
+void CheckAllCombinations(Slave& slave, uint8_t sercom_no, const std::vector<typename Slave::Pins>& pins) {
+  uint32_t accepted = 0;
+  for (auto mosi : pins) {
+    for (auto sck : pins) {
+      for (auto ss : pins) {
+        for (auto miso : pins) {
+          const uint8_t tuple[4] = {(uint8_t)mosi, (uint8_t)sck, (uint8_t)ss, (uint8_t)miso};
+          if ((mosi == sck) || (mosi == ss) || (mosi == miso) || (sck == ss) || (sck == miso) || (ss == miso)) {
+            continue;
+          }
+          sim::Reset();
+          Expected route = Route(sercom_no, tuple);
+          std::vector<uint8_t> before = sim::PeripheralSnapshot();
+          bool result = slave.SercomInit(mosi, sck, ss, miso);
+          CHECK_EQUAL(route.dipo >= 0, result);
+          if (result) {
+            accepted++;
+            CheckInitialized(sercom_no, tuple, route, 0, SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR, 2, 0);
+          } else {
+            CHECK(before == sim::PeripheralSnapshot());
+          }
+        }
+      }
+    }
+  }
+  CHECK(accepted > 0);
+}
+
+// A pin used for two signals is rejected
+void CheckRepeatedPin() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  std::vector<uint8_t> before = sim::PeripheralSnapshot();
+  CHECK(!slave1.SercomInit(P::PA16, P::PA16, P::PA18, P::PA19));
+  CHECK(!slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA18));
+  CHECK(before == sim::PeripheralSnapshot());
+}
+
+// The pins named as in earlier releases, through the unscoped enumerators and the enums of each function
+void CheckUnscopedPins() {
+  sim::Reset();
+  CHECK(slave1.SercomInit(Sercom1SPISlave::PA16, Sercom1SPISlave::PA17, Sercom1SPISlave::PA18, Sercom1SPISlave::PA19));
+  sim::Reset();
+  CHECK(slave1.SercomInit(slave1.MOSI_Pins::PA16, slave1.SCK_Pins::PA17, slave1.SS_Pins::PA18, slave1.MISO_Pins::PA19));
+}
+
+// Character size, interrupt profile, priority and Generic Clock Generator
+void CheckOptions() {
+  typedef Sercom1SPISlave::Pins P;
+  const uint8_t pins[4] = {16, 17, 18, 19};
+  Expected route = Route(1, pins);
+  CHECK_EQUAL(0, route.dipo);
+  CHECK_EQUAL(2, route.dopo);
+
+  sim::Reset();
+  CHECK(slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize9));
+  CheckInitialized(1, pins, route, 1, SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR, 2, 0);
+
+  sim::Reset();
+  CHECK(slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kDmaAssisted));
+  CheckInitialized(1, pins, route, 0, SERCOM_SPI_INTENSET_TXC, 2, 0);
+
+  sim::Reset();
+  CHECK(slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kReceiveOnly, 0, 3));
+  CheckInitialized(1, pins, route, 0, SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR, 0, 3);
+
+  // Out of range
+  sim::Reset();
+  std::vector<uint8_t> before = sim::PeripheralSnapshot();
+  CHECK(!slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kFullDuplex, 4));
+  CHECK(!slave1.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19, SercomSPISlave::kCharSize8, SercomSPISlave::kFullDuplex, 2, GCLK_GEN_NUM));
+  CHECK(before == sim::PeripheralSnapshot());
+}
+
+// The templated slave writes the same registers as SercomInit() with the same pins
+void CheckTemplate() {
+  const uint8_t pins[4] = {16, 17, 18, 19};
+  sim::Reset();
+  CHECK(slave_t.SercomInit());
+  CheckInitialized(1, pins, Route(1, pins), 0, SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR, 2, 0);
+
+  sim::Reset();
+  std::vector<uint8_t> before = sim::PeripheralSnapshot();
+  CHECK(!slave_t.SercomInit(SercomSPISlave::kCharSize8, SercomSPISlave::kFullDuplex, 4));
+  CHECK(before == sim::PeripheralSnapshot());
+}
+
+int main() {
+  typedef Sercom0SPISlave::Pins P0;
+  typedef Sercom1SPISlave::Pins P1;
+  typedef Sercom2SPISlave::Pins P2;
+  typedef Sercom3SPISlave::Pins P3;
+  typedef Sercom4SPISlave::Pins P4;
+  typedef Sercom5SPISlave::Pins P5;
+  CheckAllCombinations(slave0, 0, {P0::PA04, P0::PA05, P0::PA06, P0::PA07, P0::PA08, P0::PA09, P0::PA10, P0::PA11});
+  CheckAllCombinations(slave1, 1, {P1::PA00, P1::PA01, P1::PA16, P1::PA17, P1::PA18, P1::PA19, P1::PA30, P1::PA31});
+  CheckAllCombinations(slave2, 2, {P2::PA08, P2::PA09, P2::PA10, P2::PA11, P2::PA12, P2::PA13, P2::PA14, P2::PA15});
+  CheckAllCombinations(slave3, 3, {P3::PA16, P3::PA17, P3::PA18, P3::PA19, P3::PA20, P3::PA21, P3::PA22, P3::PA23, P3::PA24, P3::PA25});
+  CheckAllCombinations(slave4, 4, {P4::PA12, P4::PA13, P4::PA14, P4::PA15, P4::PB08, P4::PB09, P4::PB10, P4::PB11, P4::PB12, P4::PB13, P4::PB14, P4::PB15});
+  CheckAllCombinations(slave5, 5, {P5::PA20, P5::PA21, P5::PA22, P5::PA23, P5::PA24, P5::PA25, P5::PB00, P5::PB01, P5::PB02, P5::PB03, P5::PB16, P5::PB17, P5::PB22, P5::PB23, P5::PB30, P5::PB31});
+  CheckRepeatedPin();
+  CheckUnscopedPins();
+  CheckOptions();
+  CheckTemplate();
+  return TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of slaves on all six SERCOM at the same time: the pins of the example SercomSPISlaveMulti on SERCOM1 to SERCOM4, and pins of SERCOM0 and SERCOM5,
+with the six masters clocking overlapping transactions.
+Each slave must receive and transmit its own characters, and instance() must return it.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+SercomSPISlaveT<0, SercomPin::PA04, SercomPin::PA05, SercomPin::PA06, SercomPin::PA07> slave0; // MOSI, SCK, SS, MISO
+SercomSPISlaveT<1, SercomPin::PA16, SercomPin::PA17, SercomPin::PA18, SercomPin::PA19> slave1;
+SercomSPISlaveT<2, SercomPin::PA08, SercomPin::PA09, SercomPin::PA10, SercomPin::PA11> slave2;
+SercomSPISlaveT<3, SercomPin::PA22, SercomPin::PA23, SercomPin::PA20, SercomPin::PA21> slave3;
+SercomSPISlaveT<4, SercomPin::PB08, SercomPin::PB09, SercomPin::PB10, SercomPin::PB11> slave4;
+SercomSPISlaveT<5, SercomPin::PB02, SercomPin::PB03, SercomPin::PB00, SercomPin::PB01> slave5;
+
+int main() {
+  sim::Reset();
+  CHECK(slave0.SercomInit());
+  CHECK(slave1.SercomInit());
+  CHECK(slave2.SercomInit());
+  CHECK(slave3.SercomInit());
+  CHECK(slave4.SercomInit());
+  CHECK(slave5.SercomInit());
+  SercomSPISlave* slaves[] = {&slave0, &slave1, &slave2, &slave3, &slave4, &slave5};
+  CHECK(SercomSPISlave::instance(SERCOM_INST_NUM) == NULL);
+
+  sim::SpiMaster masters[] = {sim::SpiMaster(0, 4, 5, 6, 7), sim::SpiMaster(1, 16, 17, 18, 19), sim::SpiMaster(2, 8, 9, 10, 11), sim::SpiMaster(3, 22, 23, 20, 21), sim::SpiMaster(4, 40, 41, 42, 43), sim::SpiMaster(5, 34, 35, 32, 33)};
+  std::shared_ptr<sim::Transaction> transactions[6];
+  uint64_t end = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    uint8_t n = i;
+    CHECK(SercomSPISlave::instance(n) == slaves[i]);
+    for (uint8_t j = 0; j < 8; j++) {
+      slaves[i]->write((uint8_t)(0x80 + 0x10 * n + j)); // Response of the slave
+    }
+    std::vector<uint16_t> mosi;
+    for (uint8_t j = 0; j < 8; j++) {
+      mosi.push_back(0x10 * n + j);
+    }
+    // Transactions start a few cycles apart, such that the characters of the six SERCOM end close to each other.
+    // The six handlers then run back to back for each character, which takes longer than a character at 500 kHz, so SCK is 250 kHz.
+    transactions[i] = masters[i].Transfer(2000 + 7 * i, mosi, 250000);
+    end = std::max(end, transactions[i]->ss_high);
+  }
+  sim::RunUntil(end + 5000);
+
+  for (uint8_t i = 0; i < 6; i++) {
+    uint8_t n = i;
+    CHECK(transactions[i]->connected);
+    uint8_t buffer[16];
+    size_t length = SercomSPISlave::instance(n)->read(buffer, sizeof(buffer));
+    CHECK_EQUAL(8, length);
+    for (uint8_t j = 0; j < length; j++) {
+      CHECK_EQUAL(0x10 * n + j, buffer[j]);
+      CHECK_EQUAL(0x80 + 0x10 * n + j, transactions[i]->miso[j]);
+    }
+    SercomSPISlave::Stats stats = slaves[i]->getStats();
+    CHECK_EQUAL(0, stats.overflows);
+    CHECK_EQUAL(1, stats.transactions);
+    CHECK_EQUAL(8, stats.chars_received);
+  }
+  CHECK(sim::Stats().max_nesting == 1); // The SERCOM interrupts have the same priority, so they do not preempt each other
+  return TEST_RESULT();
+}
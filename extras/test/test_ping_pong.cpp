@@ -0,0 +1,111 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the ping-pong receive mode: the frames are handed out in the two buffers in turn, only one buffer is lent at a time,
+and a frame received while the application holds the other buffer is dropped and overwritten by the next one.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+uint8_t buffer0[4];
+uint8_t buffer1[4];
+size_t last_length = 0;
+
+void OnFrame(size_t length) {
+  last_length = length;
+}
+
+void Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  CHECK(!slave.enablePingPong(buffer0, buffer0, sizeof(buffer0))); // The buffers must differ
+  CHECK(!slave.enablePingPong(buffer0, NULL, sizeof(buffer0)));
+  CHECK(slave.enablePingPong(buffer0, buffer1, sizeof(buffer0), OnFrame));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  size_t length = 0;
+  CHECK(slave.lendFrame(&length) == NULL); // No frame yet
+
+  // The first frame is written into buffer0, and handed to the application
+  Transfer(master, {1, 2, 3});
+  CHECK_EQUAL(3, last_length);
+  CHECK(slave.lendFrame(&length) == buffer0);
+  CHECK_EQUAL(3, length);
+  CHECK_EQUAL(1, buffer0[0]);
+  CHECK_EQUAL(3, buffer0[2]);
+  CHECK(slave.lendFrame() == NULL); // Only one buffer is lent at a time
+
+  // While buffer0 is lent, the next frame is written into buffer1, but dropped: the application still holds the other buffer
+  Transfer(master, {4, 5});
+  CHECK_EQUAL(1, slave.getStats().frames_dropped);
+  CHECK(slave.lendFrame() == NULL);
+  CHECK_EQUAL(1, buffer0[0]); // The lent buffer is not written
+
+  // Only the lent buffer is returned, and only once
+  CHECK(!slave.returnFrame(buffer1));
+  CHECK(!slave.returnFrame(NULL));
+  CHECK(slave.returnFrame(buffer0));
+  CHECK(!slave.returnFrame(buffer0));
+
+  // The dropped frame is overwritten by the next one, in buffer1
+  Transfer(master, {6, 7, 8, 9});
+  CHECK(slave.lendFrame(&length) == buffer1);
+  CHECK_EQUAL(4, length);
+  CHECK_EQUAL(6, buffer1[0]);
+  CHECK_EQUAL(9, buffer1[3]);
+  CHECK(slave.returnFrame(buffer1));
+
+  // A frame that has not been taken also holds the other buffer
+  Transfer(master, {10});
+  Transfer(master, {11});
+  CHECK_EQUAL(2, slave.getStats().frames_dropped);
+  CHECK(slave.lendFrame(&length) == buffer0);
+  CHECK_EQUAL(1, length);
+  CHECK_EQUAL(10, buffer0[0]);
+  CHECK(slave.returnFrame(buffer0));
+
+  // A frame that does not fit in a buffer is dropped
+  Transfer(master, {12, 13, 14, 15, 16});
+  CHECK_EQUAL(3, slave.getStats().frames_dropped);
+  CHECK(slave.lendFrame() == NULL);
+  Transfer(master, {17});
+  CHECK(slave.lendFrame(&length) == buffer1);
+  CHECK_EQUAL(17, buffer1[0]);
+  CHECK(slave.returnFrame(buffer1));
+
+  // Nothing is received into the receive buffer
+  CHECK_EQUAL(0, slave.available());
+  slave.disablePingPong();
+  CHECK(slave.lendFrame() == NULL);
+  Transfer(master, {18});
+  CHECK_EQUAL(1, slave.available());
+  return TEST_RESULT();
+}
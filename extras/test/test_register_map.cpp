@@ -0,0 +1,87 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the register map protocol: a read that the master stops before the end of the map does not shift the next read,
+and a write changes only the bits set in the write mask.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+volatile uint8_t registers[4] = {0x10, 0x11, 0x12, 0x13};
+const uint8_t write_mask[4] = {0x00, 0xFF, 0x0F, 0x00};
+uint8_t written_first = 0xFF;
+uint8_t written_count = 0;
+
+void OnWrite(uint8_t address, uint8_t count) {
+  written_first = address;
+  written_count = count;
+}
+
+std::shared_ptr<sim::Transaction> Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  // The gap leaves the slave the time to load the first register after the command
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 1000000, 8, 48, 500);
+  sim::RunUntil(transaction->ss_high + 5000);
+  return transaction;
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  CHECK(slave.enableRegisterMap(registers, sizeof(registers), write_mask, OnWrite));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+
+  // Short reads leave registers preloaded in the SERCOM, which must not be transmitted by the next read
+  for (uint8_t i = 0; i < 3; i++) {
+    std::shared_ptr<sim::Transaction> transaction = Transfer(master, {0x80, 0, 0});
+    CHECK_EQUAL(0x10, transaction->miso[1]);
+    CHECK_EQUAL(0x11, transaction->miso[2]);
+  }
+  std::shared_ptr<sim::Transaction> transaction = Transfer(master, {0x82, 0});
+  CHECK_EQUAL(0x12, transaction->miso[1]);
+
+  // A write changes only the bits of the mask, and reports the registers it wrote
+  transaction = Transfer(master, {0x00, 0xAA, 0xBB, 0xCC, 0xDD});
+  CHECK_EQUAL(0x10, registers[0]);
+  CHECK_EQUAL(0xBB, registers[1]);
+  CHECK_EQUAL(0x1C, registers[2]);
+  CHECK_EQUAL(0x13, registers[3]);
+  CHECK_EQUAL(0, written_first);
+  CHECK_EQUAL(4, written_count);
+
+  // A write beyond the end of the map is ignored
+  transaction = Transfer(master, {0x03, 0xEE, 0xEE});
+  CHECK_EQUAL(0x13, registers[3]);
+  CHECK_EQUAL(3, written_first);
+  CHECK_EQUAL(1, written_count);
+
+  // The registers written are read back
+  transaction = Transfer(master, {0x80, 0, 0, 0, 0});
+  std::vector<uint16_t> expected = {0x10, 0xBB, 0x1C, 0x13};
+  CHECK(expected == std::vector<uint16_t>(transaction->miso.begin() + 1, transaction->miso.end()));
+  CHECK_EQUAL(0, slave.getStats().overflows);
+  return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of setResponse() and setResponse16(): replacing or clearing the response discards the characters preloaded from the previous one,
+such that each transaction transmits the current response from its start.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+uint8_t response_a[4] = {0xA0, 0xA1, 0xA2, 0xA3};
+uint8_t response_b[4] = {0xB0, 0xB1, 0xB2, 0xB3};
+uint16_t response_9bit[2] = {0x1A5, 0x05A};
+
+std::vector<uint16_t> Transfer(sim::SpiMaster& master, size_t length) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, std::vector<uint16_t>(length, 0), 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  return transaction->miso;
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+
+  slave.setResponse(response_a, sizeof(response_a));
+  std::vector<uint16_t> expected_a = {0xA0, 0xA1, 0xA2, 0xA3};
+  CHECK(expected_a == Transfer(master, 4));
+
+  // Replacing the response
+  slave.setResponse(response_b, sizeof(response_b));
+  std::vector<uint16_t> expected_b = {0xB0, 0xB1, 0xB2, 0xB3};
+  CHECK(expected_b == Transfer(master, 4));
+  CHECK(expected_b == Transfer(master, 4));
+
+  // Updating the contents of the response, and setting it again
+  response_b[0] = 0xC0;
+  response_b[1] = 0xC1;
+  slave.setResponse(response_b, sizeof(response_b));
+  std::vector<uint16_t> expected_c = {0xC0, 0xC1, 0xB2, 0xB3};
+  CHECK(expected_c == Transfer(master, 4));
+
+  // Clearing the response: the characters queued with write() follow
+  slave.write((uint8_t)0x55);
+  slave.write((uint8_t)0x66);
+  slave.setResponse(NULL, 0);
+  std::vector<uint16_t> miso = Transfer(master, 2);
+  CHECK_EQUAL(0x55, miso[0]);
+  CHECK_EQUAL(0x66, miso[1]);
+
+  // Replacing the response during a transaction takes effect in the next one
+  slave.setResponse(response_a, sizeof(response_a));
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {0, 0, 0, 0}, 1000000);
+  sim::RunUntil(transaction->ss_low + 1000);
+  slave.setResponse(response_b, sizeof(response_b));
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK_EQUAL(0xA0, transaction->miso[0]);
+  CHECK(expected_c == Transfer(master, 4));
+  CHECK_EQUAL(0, slave.getStats().overflows);
+
+  // 9-bit response
+  CHECK(slave.setCharSize(SercomSPISlave::kCharSize9));
+  slave.setResponse16(response_9bit, 2);
+  transaction = master.Transfer(sim::Now() + 1000, {0, 0}, 1000000, 9);
+  sim::RunUntil(transaction->ss_high + 5000);
+  std::vector<uint16_t> expected_9bit = {0x1A5, 0x05A};
+  CHECK(expected_9bit == transaction->miso);
+  return TEST_RESULT();
+}
@@ -0,0 +1,73 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the sleep between transactions: enableStandby() with the SERCOM interrupt masked, and the wake-ups counted by standby().
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  slave.write((uint8_t)0xA5);
+  sim::Run(1000);
+
+  // The SERCOM interrupt is masked while CTRLB is rewritten
+  sim::ClearNvicLog();
+  slave.enableStandby(SercomSPISlave::kWakeOnSlaveSelect);
+  CHECK(sim_sercom[1].SPI.CTRLB.sim_raw & SERCOM_SPI_CTRLB_SSDE);
+  CHECK(sim_sercom[1].SPI.INTENSET.sim_raw & SERCOM_SPI_INTENSET_SSL);
+  CHECK(sim_sercom[1].SPI.CTRLA.sim_raw & SERCOM_SPI_CTRLA_ENABLE);
+  const std::vector<sim::NvicCall>& log = sim::NvicLog();
+  CHECK_EQUAL(2, log.size());
+  CHECK(log[0].kind == sim::NvicCall::kDisable);
+  CHECK(log[1].kind == sim::NvicCall::kEnable);
+  CHECK(sim::IrqEnabled(SERCOM1_IRQn));
+  CHECK_EQUAL(NVMCTRL_CTRLB_SLEEPPRM_DISABLED_Val, NVMCTRL->CTRLB.bit.SLEEPPRM);
+
+  // A transaction of 5 ms: the core sleeps in standby until Slave Select low, then in idle, where SysTick wakes it every millisecond
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 48000, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, 16000);
+  slave.standby();
+  CHECK(sim::Now() >= transaction->ss_high);
+  CHECK_EQUAL(0xA5, transaction->miso[0]); // The character preloaded before enableStandby() is transmitted
+  CHECK(sim::Stats().idle_wakes >= 5);
+  CHECK(sim::Stats().standby_wakes >= 1);
+  CHECK_EQUAL(sim::Stats().standby_wakes, slave.getStats().wakeups);
+  CHECK_EQUAL(10, slave.available());
+
+  // Enabling it again with the same wake source does not disable the SERCOM, which would discard the preloaded character
+  slave.write((uint8_t)0x5A);
+  sim::Run(1000);
+  slave.enableStandby(SercomSPISlave::kWakeOnSlaveSelect);
+  transaction = master.Transfer(sim::Now() + 1000, {1}, 1000000);
+  slave.standby();
+  CHECK_EQUAL(0x5A, transaction->miso[0]);
+  CHECK_EQUAL(sim::Stats().standby_wakes, slave.getStats().wakeups);
+  return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the Stream interface: readBytes() copies the received bytes across the end of the receive buffer, waits for bytes that arrive during the call,
+and returns a short count on timeout. write(buffer, length) queues what fits, as reported by availableForWrite().
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+char data[SERCOM_SPI_SLAVE_RX_BUFFER_SIZE];
+
+std::vector<uint16_t> Sequence(uint16_t first, size_t length) {
+  std::vector<uint16_t> mosi(length);
+  for (size_t i = 0; i < length; i++) {
+    mosi[i] = (uint8_t)(first + i);
+  }
+  return mosi;
+}
+
+void Transfer(sim::SpiMaster& master, const std::vector<uint16_t>& mosi) {
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, mosi, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+}
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  slave.setTimeout(2);
+
+  // Move the ends of the receive buffer close to its end, such that the next bytes wrap around
+  Transfer(master, Sequence(0, 200));
+  CHECK_EQUAL(200, slave.readBytes(data, 200));
+  Transfer(master, Sequence(100, 100));
+  CHECK_EQUAL(100, slave.available());
+  CHECK_EQUAL(100, slave.readBytes(data, 100));
+  bool intact = true;
+  for (size_t i = 0; i < 100; i++) {
+    intact = intact && ((uint8_t)data[i] == (uint8_t)(100 + i));
+  }
+  CHECK(intact);
+
+  // Bytes that arrive while readBytes() waits are copied
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, Sequence(7, 8), 1000000);
+  CHECK_EQUAL(8, slave.readBytes(data, 8));
+  CHECK_EQUAL(7, data[0]);
+  CHECK_EQUAL(14, data[7]);
+  sim::RunUntil(transaction->ss_high + 5000);
+
+  // Fewer bytes than requested: the count is short after the timeout
+  Transfer(master, Sequence(20, 4));
+  unsigned long start = millis();
+  CHECK_EQUAL(4, slave.readBytes(data, 10));
+  CHECK(millis() - start >= 2);
+  CHECK_EQUAL(20, data[0]);
+  CHECK_EQUAL(23, data[3]);
+  start = millis();
+  CHECK_EQUAL(0, slave.readBytes(data, 1));
+  CHECK(millis() - start >= 2);
+
+  // write(buffer, length) queues what fits in the transmit buffer
+  CHECK_EQUAL(SERCOM_SPI_SLAVE_TX_BUFFER_SIZE, slave.availableForWrite());
+  uint8_t reply[SERCOM_SPI_SLAVE_TX_BUFFER_SIZE + 8];
+  for (size_t i = 0; i < sizeof(reply); i++) {
+    reply[i] = 0x80 + i;
+  }
+  CHECK_EQUAL(SERCOM_SPI_SLAVE_TX_BUFFER_SIZE, slave.write(reply, sizeof(reply)));
+  CHECK(slave.availableForWrite() < 8); // The first bytes may already be loaded into the SERCOM
+  transaction = master.Transfer(sim::Now() + 1000, Sequence(0, SERCOM_SPI_SLAVE_TX_BUFFER_SIZE), 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK(std::vector<uint16_t>(reply, reply + SERCOM_SPI_SLAVE_TX_BUFFER_SIZE) == transaction->miso);
+  CHECK_EQUAL(SERCOM_SPI_SLAVE_TX_BUFFER_SIZE, slave.availableForWrite());
+  return TEST_RESULT();
+}
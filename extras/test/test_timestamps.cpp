@@ -0,0 +1,106 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the Slave Select timestamps: the arguments accepted by enableTimestamps(), the SERCOM interrupt masked while CTRLB is rewritten,
+the timestamps captured by TC4 from a second pin connected to SS, and the frame timestamps and latency histogram kept in the storage of the application.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+SercomSPISlave::TimestampStorage storage;
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+
+  // A pin of the slave cannot be the capture pin
+  std::vector<uint8_t> before = sim::PeripheralSnapshot();
+  CHECK(!slave.enableTimestamps(SercomPin::PA18, 0, &storage));
+  CHECK(!slave.enableTimestamps(SercomPin::PA16, 0, &storage));
+  CHECK(!slave.enableTimestamps(SercomPin::PA20, EVSYS_CHANNELS, &storage));
+  CHECK(!slave.enableTimestamps(SercomPin::PA20, 0, NULL));
+  CHECK(before == sim::PeripheralSnapshot());
+
+  slave.write((uint8_t)0xA5);
+  sim::Run(1000);
+  sim::ClearNvicLog();
+  CHECK(slave.enableTimestamps(SercomPin::PA20, 0, &storage, 0, 8));
+  CHECK(sim_sercom[1].SPI.CTRLB.sim_raw & SERCOM_SPI_CTRLB_SSDE);
+  CHECK(sim_sercom[1].SPI.INTENSET.sim_raw & SERCOM_SPI_INTENSET_SSL);
+  // The SERCOM interrupt is masked from the start of the update of the slave to the end of the rewrite of CTRLB
+  const std::vector<sim::NvicCall>& log = sim::NvicLog();
+  CHECK_EQUAL(2, log.size());
+  CHECK(log[0].kind == sim::NvicCall::kDisable);
+  CHECK(log[1].kind == sim::NvicCall::kEnable);
+  CHECK(sim::IrqEnabled(SERCOM1_IRQn));
+
+  // TC4 counts at 48 MHz: the timestamps are the Slave Select edges of the master
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  master.MirrorSlaveSelect(20);
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {1, 2, 3, 4}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK_EQUAL(0xA5, transaction->miso[0]); // Rewriting CTRLB restarted the transmit path
+  SercomSPISlave::Timestamps timestamps = slave.lastTransactionTimestamps();
+  CHECK(timestamps.valid);
+  CHECK_EQUAL(transaction->ss_high - transaction->ss_low, timestamps.end - timestamps.start);
+  SercomSPISlave::Stats stats = slave.getStats();
+  CHECK_EQUAL(1, stats.latency_count);
+  CHECK(stats.latency_min > 0);
+  CHECK_EQUAL(1, storage.latency_histogram[stats.latency_min / 8]);
+
+  // The frame queued before enableTimestamps() has no timestamps, the next frames have theirs
+  slave.disableTimestamps();
+  slave.enableFraming();
+  transaction = master.Transfer(sim::Now() + 1000, {1, 2}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  CHECK(slave.enableTimestamps(SercomPin::PA20, 0, &storage, 0, 8));
+  CHECK_EQUAL(0, storage.latency_histogram[stats.latency_min / 8]); // Cleared
+  std::shared_ptr<sim::Transaction> second = master.Transfer(sim::Now() + 1000, {3, 4, 5}, 1000000);
+  std::shared_ptr<sim::Transaction> third = master.Transfer(second->ss_high + 2000, {6}, 1000000);
+  sim::RunUntil(third->ss_high + 5000);
+  uint8_t frame[8];
+  CHECK_EQUAL(3, slave.availableFrames());
+  CHECK_EQUAL(2, slave.readFrame(frame, sizeof(frame)));
+  CHECK(!slave.lastFrameTimestamps().valid);
+  CHECK_EQUAL(3, slave.readFrame(frame, sizeof(frame)));
+  CHECK(slave.lastFrameTimestamps().valid);
+  CHECK_EQUAL(second->ss_high - second->ss_low, slave.lastFrameTimestamps().end - slave.lastFrameTimestamps().start);
+  CHECK_EQUAL(1, slave.readFrame(frame, sizeof(frame)));
+  CHECK_EQUAL(third->ss_high - third->ss_low, slave.lastFrameTimestamps().end - slave.lastFrameTimestamps().start);
+  CHECK_EQUAL(2, slave.getStats().latency_count - stats.latency_count);
+  uint32_t histogram_count = 0;
+  for (uint8_t i = 0; i < SERCOM_SPI_SLAVE_LATENCY_BINS; i++) {
+    histogram_count += storage.latency_histogram[i];
+  }
+  CHECK_EQUAL(2, histogram_count);
+
+  // resetStats() also clears the histogram
+  slave.resetStats();
+  CHECK_EQUAL(0, storage.latency_histogram[stats.latency_min / 8]);
+  slave.disableTimestamps();
+  return TEST_RESULT();
+}
@@ -0,0 +1,67 @@
+/*
+  Copyright (C) 2022 lenvm
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  For the GNU General Public License see https://www.gnu.org/licenses/
+
+  Contact Information
+  -------------------
+  lenvm
+  GitHub   : https://github.com/lenvm
+*/
+
+/*
+Tests of the DMA transmit path: a response gathered from several segments, linked through descriptors provided by the application.
+*/
+
+#include <Arduino.h>
+
+#include "SercomSPISlave.h"
+#include "test.h"
+
+Sercom1SPISlave slave;
+uint8_t status[2] = {0x11, 0x12};
+uint8_t empty[1] = {0xEE};
+uint8_t measurement[3] = {0x21, 0x22, 0x23};
+__attribute__((__aligned__(16))) DmacDescriptor descriptors[2];
+
+int main() {
+  typedef Sercom1SPISlave::Pins P;
+  sim::Reset();
+  CHECK(slave.SercomInit(P::PA16, P::PA17, P::PA18, P::PA19));
+  SercomSPISlave::Segment segments[] = {{status, sizeof(status)}, {empty, 0}, {measurement, sizeof(measurement)}};
+  CHECK(!slave.setResponseSegments(segments, 3, descriptors)); // The DMA transmit path is not enabled
+  CHECK(slave.enableTxDMA(1));
+
+  // Two segments need a descriptor of the application, aligned to 16 bytes
+  CHECK(!slave.setResponseSegments(segments, 3));
+  CHECK(!slave.setResponseSegments(segments, 3, (DmacDescriptor*)((uintptr_t)descriptors + 4)));
+  CHECK(slave.setResponseSegments(segments, 3, descriptors));
+  CHECK_EQUAL(0, descriptors[1].BTCTRL.sim_raw); // The empty segment takes no descriptor
+
+  sim::SpiMaster master(1, 16, 17, 18, 19);
+  for (uint8_t i = 0; i < 2; i++) {
+    std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {0, 0, 0, 0, 0}, 1000000);
+    sim::RunUntil(transaction->ss_high + 5000);
+    std::vector<uint16_t> expected = {0x11, 0x12, 0x21, 0x22, 0x23}; // Every transaction transmits the segments from the start
+    CHECK(expected == transaction->miso);
+  }
+
+  // A single segment needs no descriptor of the application
+  CHECK(slave.setResponseSegments(&segments[2], 1));
+  std::shared_ptr<sim::Transaction> transaction = master.Transfer(sim::Now() + 1000, {0, 0, 0}, 1000000);
+  sim::RunUntil(transaction->ss_high + 5000);
+  std::vector<uint16_t> expected = {0x21, 0x22, 0x23};
+  CHECK(expected == transaction->miso);
+  slave.disableTxDMA();
+  return TEST_RESULT();
+}
@@ -20,19 +20,27 @@
 */
 
 /* Acronyms
+  BTCNT    | Block Transfer Count
+  BTCTRL   | Block Transfer Control
   C        | Complete
-  CH       | Character
+  CH       | Channel (DMAC registers), Character (SERCOM registers)
+  CHID     | Channel ID
   CHSIZE   | Character Size
+  CMD      | Command
   CFG      | Configuration
   CLK      | Clock
   CPHA     | Clock Phase
   CPOL     | Clock Polarity
   CTRLA    | Control A register
   CTRLB    | Control B register
+  DESCADDR | Descriptor Address
   DIPO     | Data In Pinout
+  DMA      | Direct Memory Access
+  DMAC     | Direct Memory Access Controller
   DOPO     | Data Out Pinout
   DORD     | Data Order
   DRE      | Data register empty
+  DST      | Destination
   E        | Even
   EN       | Enable
   FORM     | Frame Format
@@ -64,16 +72,148 @@
   SPI      | Serial Peripheral Interface
   SS       | Slave Select
   SSDE     | Slave Select Low Detect Enable
+  SRC      | Source
   SSL      | Slave Select Low
   STDBY    | Standby
+  SUSP     | Suspend
   SW       | Software
   SWRST    | Software Reset
+  TCMPL    | Transfer Complete
+  TERR     | Transfer Error
+  TRIG     | Trigger
+  TRIGACT  | Trigger Action
+  TRIGSRC  | Trigger Source
   TX       | Transmit
   TXC      | Transmit Complete
+  WRB      | Write-Back
 */
 
 #include "SercomSPISlave.h"
 
+// Static variables //
+
+/* Explanation:
+The DMAC fetches the first transfer descriptor of each channel from the descriptor table at BASEADDR, and stores the state of an ongoing transfer in the write-back table at WRBADDR.
+Both tables hold one descriptor per channel and must be 128-bit aligned.
+The DMA receive path links the descriptor in the descriptor table to a second descriptor in dmac_link_descriptors, which links back to the first, such that the transfer loops around the circular buffer.
+The DMA transmit path links the descriptor in the descriptor table to the descriptors of the further segments, provided by the application to setResponseSegments(), and the last one to none, such that the transfer stops after the last segment.
+Reference: Atmel-42181G-SAM-D21_Datasheet section 19
+*/
+__attribute__((__aligned__(16))) static DmacDescriptor dmac_descriptor_table[DMAC_CH_NUM]; // First transfer descriptor of each channel, unless the DMAC was configured before the library used it
+__attribute__((__aligned__(16))) static DmacDescriptor dmac_writeback_table[DMAC_CH_NUM]; // Write-back descriptor of each channel, unless the DMAC was configured before the library used it
+static DmacDescriptor* dmac_descriptors = dmac_descriptor_table; // Descriptor table at BASEADDR, see DmacEnable()
+static DmacDescriptor* dmac_writeback = dmac_writeback_table; // Write-back table at WRBADDR, see DmacEnable()
+__attribute__((__aligned__(16))) static DmacDescriptor dmac_link_descriptors[DMAC_CH_NUM]; // Second transfer descriptor of each channel
+SercomSPISlave* SercomSPISlave::dmac_channel_owner_[DMAC_CH_NUM] = {NULL};
+SercomSPISlave* SercomSPISlave::dmac_crc_owner_ = NULL;
+SercomSPISlave* SercomSPISlave::timestamp_owner_ = NULL;
+SercomSPISlave* SercomSPISlave::instances_[SERCOM_INST_NUM] = {NULL};
+
+/* Explanation:
+The vector table holds the initial stack pointer, the 15 system exceptions and the PERIPH_COUNT_IRQn interrupts of the device.
+The Vector Table Offset Register requires the table to be aligned to its size, rounded up to a power of two: 256 bytes for up to 64 entries.
+Reference: ARM Cortex-M0+ Devices Generic User Guide section 4.3.5
+*/
+static const size_t kVectorCount = 16 + PERIPH_COUNT_IRQn;
+static_assert(kVectorCount <= 64, "The vector table does not fit in 256 bytes.");
+__attribute__((__aligned__(256))) static uint32_t ram_vectors[kVectorCount]; // Vector table used after relocateVectorTable()
+
+/* Explanation:
+The isr_cycles of the statistics are measured inside IrqHandler(), so they leave out the exception entry and exit of the core and the call from the handler of the Arduino core.
+Entry and exit take 15 cycles each without wait states; the wait state of the flash at 48 MHz and the call add about 10 more.
+Reference: ARM Cortex-M0+ Technical Reference Manual section 3.3
+*/
+static const uint32_t kIsrOverheadCycles = 40;
+
+constexpr SercomPinMux SercomSPISlavePinMux::kTable[]; // Definition of the table used by the lookups at run time
+
+/* Explanation:
+The checks below run during compilation, such that an error in the pin table or in the pin enums of Sercom0SPISlave to Sercom5SPISlave does not compile.
+Every pin listed for a SERCOM must be connected to a PAD of that SERCOM, and the table must not hold more pins for a SERCOM than its enum lists.
+The DIPO and DOPO of the combinations highlighted in the readme are checked against the values of the datasheet.
+*/
+// Whether all pins of a list are connected to a PAD of a SERCOM
+static constexpr bool AllPinsConnected(uint8_t sercom_no, const uint8_t* pins, size_t count) {
+  return (count == 0) || ((SercomSPISlavePinMux::Pad(sercom_no, pins[0]) >= 0) && AllPinsConnected(sercom_no, pins + 1, count - 1));
+}
+
+// Number of entries of the pin table for a SERCOM
+static constexpr size_t CountTablePins(uint8_t sercom_no, uint8_t i = 0) {
+  return (i >= SercomSPISlavePinMux::kTableSize) ? 0 : ((SercomSPISlavePinMux::kTable[i].sercom_no == sercom_no) ? 1 : 0) + CountTablePins(sercom_no, i + 1);
+}
+
+static constexpr uint8_t kSercom0Pins[] = {(uint8_t)Sercom0SPISlave::Pins::PA04, (uint8_t)Sercom0SPISlave::Pins::PA05, (uint8_t)Sercom0SPISlave::Pins::PA06, (uint8_t)Sercom0SPISlave::Pins::PA07, (uint8_t)Sercom0SPISlave::Pins::PA08, (uint8_t)Sercom0SPISlave::Pins::PA09, (uint8_t)Sercom0SPISlave::Pins::PA10, (uint8_t)Sercom0SPISlave::Pins::PA11};
+static constexpr uint8_t kSercom1Pins[] = {(uint8_t)Sercom1SPISlave::Pins::PA00, (uint8_t)Sercom1SPISlave::Pins::PA01, (uint8_t)Sercom1SPISlave::Pins::PA16, (uint8_t)Sercom1SPISlave::Pins::PA17, (uint8_t)Sercom1SPISlave::Pins::PA18, (uint8_t)Sercom1SPISlave::Pins::PA19, (uint8_t)Sercom1SPISlave::Pins::PA30, (uint8_t)Sercom1SPISlave::Pins::PA31};
+static constexpr uint8_t kSercom2Pins[] = {(uint8_t)Sercom2SPISlave::Pins::PA08, (uint8_t)Sercom2SPISlave::Pins::PA09, (uint8_t)Sercom2SPISlave::Pins::PA10, (uint8_t)Sercom2SPISlave::Pins::PA11, (uint8_t)Sercom2SPISlave::Pins::PA12, (uint8_t)Sercom2SPISlave::Pins::PA13, (uint8_t)Sercom2SPISlave::Pins::PA14, (uint8_t)Sercom2SPISlave::Pins::PA15};
+static constexpr uint8_t kSercom3Pins[] = {(uint8_t)Sercom3SPISlave::Pins::PA16, (uint8_t)Sercom3SPISlave::Pins::PA17, (uint8_t)Sercom3SPISlave::Pins::PA18, (uint8_t)Sercom3SPISlave::Pins::PA19, (uint8_t)Sercom3SPISlave::Pins::PA20, (uint8_t)Sercom3SPISlave::Pins::PA21, (uint8_t)Sercom3SPISlave::Pins::PA22, (uint8_t)Sercom3SPISlave::Pins::PA23, (uint8_t)Sercom3SPISlave::Pins::PA24, (uint8_t)Sercom3SPISlave::Pins::PA25};
+static constexpr uint8_t kSercom4Pins[] = {(uint8_t)Sercom4SPISlave::Pins::PA12, (uint8_t)Sercom4SPISlave::Pins::PA13, (uint8_t)Sercom4SPISlave::Pins::PA14, (uint8_t)Sercom4SPISlave::Pins::PA15, (uint8_t)Sercom4SPISlave::Pins::PB08, (uint8_t)Sercom4SPISlave::Pins::PB09, (uint8_t)Sercom4SPISlave::Pins::PB10, (uint8_t)Sercom4SPISlave::Pins::PB11, (uint8_t)Sercom4SPISlave::Pins::PB12, (uint8_t)Sercom4SPISlave::Pins::PB13, (uint8_t)Sercom4SPISlave::Pins::PB14, (uint8_t)Sercom4SPISlave::Pins::PB15};
+static constexpr uint8_t kSercom5Pins[] = {(uint8_t)Sercom5SPISlave::Pins::PA20, (uint8_t)Sercom5SPISlave::Pins::PA21, (uint8_t)Sercom5SPISlave::Pins::PA22, (uint8_t)Sercom5SPISlave::Pins::PA23, (uint8_t)Sercom5SPISlave::Pins::PA24, (uint8_t)Sercom5SPISlave::Pins::PA25, (uint8_t)Sercom5SPISlave::Pins::PB00, (uint8_t)Sercom5SPISlave::Pins::PB01, (uint8_t)Sercom5SPISlave::Pins::PB02, (uint8_t)Sercom5SPISlave::Pins::PB03, (uint8_t)Sercom5SPISlave::Pins::PB16, (uint8_t)Sercom5SPISlave::Pins::PB17, (uint8_t)Sercom5SPISlave::Pins::PB22, (uint8_t)Sercom5SPISlave::Pins::PB23, (uint8_t)Sercom5SPISlave::Pins::PB30, (uint8_t)Sercom5SPISlave::Pins::PB31};
+static_assert(AllPinsConnected(0, kSercom0Pins, sizeof(kSercom0Pins)) && (CountTablePins(0) == sizeof(kSercom0Pins)), "The pin table does not match Sercom0SPISlave::Pins.");
+static_assert(AllPinsConnected(1, kSercom1Pins, sizeof(kSercom1Pins)) && (CountTablePins(1) == sizeof(kSercom1Pins)), "The pin table does not match Sercom1SPISlave::Pins.");
+static_assert(AllPinsConnected(2, kSercom2Pins, sizeof(kSercom2Pins)) && (CountTablePins(2) == sizeof(kSercom2Pins)), "The pin table does not match Sercom2SPISlave::Pins.");
+static_assert(AllPinsConnected(3, kSercom3Pins, sizeof(kSercom3Pins)) && (CountTablePins(3) == sizeof(kSercom3Pins)), "The pin table does not match Sercom3SPISlave::Pins.");
+static_assert(AllPinsConnected(4, kSercom4Pins, sizeof(kSercom4Pins)) && (CountTablePins(4) == sizeof(kSercom4Pins)), "The pin table does not match Sercom4SPISlave::Pins.");
+static_assert(AllPinsConnected(5, kSercom5Pins, sizeof(kSercom5Pins)) && (CountTablePins(5) == sizeof(kSercom5Pins)), "The pin table does not match Sercom5SPISlave::Pins.");
+static_assert(SercomSPISlavePinMux::Dipo(SercomSPISlavePinMux::Pad(1, 16), SercomSPISlavePinMux::Pad(1, 17), SercomSPISlavePinMux::Pad(1, 18), SercomSPISlavePinMux::Pad(1, 19)) == 0x0 &&
+              SercomSPISlavePinMux::Dopo(SercomSPISlavePinMux::Pad(1, 19), SercomSPISlavePinMux::Pad(1, 17), SercomSPISlavePinMux::Pad(1, 18)) == 0x2,
+              "PA16, PA17, PA18, PA19 on SERCOM1 must select DIPO 0x0 and DOPO 0x2, see page 493.");
+static_assert(SercomSPISlavePinMux::Pad(1, 16) == 0 && SercomSPISlavePinMux::Function(1, 16) == 0x2, "PA16 must be PAD0 of SERCOM1 with peripheral function C.");
+static_assert(SercomSPISlavePinMux::Pad(3, 16) == 0 && SercomSPISlavePinMux::Function(3, 16) == 0x3, "PA16 must be PAD0 of SERCOM3 with peripheral function D.");
+static_assert(SercomSPISlavePinMux::Dopo(0, 3, 1) == 0x3 && SercomSPISlavePinMux::Dipo(2, 3, 1, 0) == 0x2, "MISO PAD0, SCK PAD3, SS PAD1 must select DOPO 0x3 with MOSI on PAD2.");
+static_assert(SercomSPISlavePinMux::Dopo(0, 1, 3) < 0 && SercomSPISlavePinMux::Dipo(1, 1, 2, 0) < 0, "Combinations of PADs the SERCOM cannot route must be rejected.");
+static_assert(SercomSPISlavePinMux::Extint(8) < 0 && SercomSPISlavePinMux::Extint(28) == 8 && SercomSPISlavePinMux::Extint(54) == 6, "PA08 has no external interrupt line, PA28 uses EXTINT8 and PB22 EXTINT6.");
+
+// Timestamps //
+
+// Offsets of the COUNT and CC0 registers of a TC in 32-bit mode, for READREQ.ADDR
+static const uint8_t kTcCountAddress = 0x10;
+static const uint8_t kTcCc0Address = 0x18;
+
+// Read a register of TC4. Reads of COUNT and CCx must be synchronized with the clock of the TC.
+static uint32_t Tc4Read(uint8_t address) {
+  TC4->COUNT32.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(address);
+  while (TC4->COUNT32.STATUS.bit.SYNCBUSY); // Wait for synchronisation
+  return (address == kTcCountAddress) ? TC4->COUNT32.COUNT.reg : TC4->COUNT32.CC[0].reg;
+}
+
+// Polls of CHINTFLAG in dmaPosition() before it gives up waiting for the channel to suspend, about 50 us at 48 MHz
+static const uint16_t kDmaSuspendPolls = 200;
+
+/* Explanation:
+DmacIrqHandler and TransactionEnd() both update the DMA receive state of a slave. The DMAC interrupt takes the highest priority of the SERCOM interrupts of the slaves using the DMAC,
+such that the SERCOM interrupt of a slave cannot preempt DmacIrqHandler, and the two are served one after the other.
+The priority is set before the interrupt is enabled, such that the DMAC interrupt is never taken at the reset priority 0.
+Reference: ARM Cortex-M0+ Devices Generic User Guide section 4.2
+*/
+
+// Enable the DMAC the first time it is used, and raise the priority of its interrupt to irq_priority, the priority of the SERCOM interrupt of a slave using it
+static void DmacEnable(uint8_t irq_priority) {
+  if (DMAC->CTRL.bit.DMAENABLE && (DMAC->BASEADDR.reg == (uint32_t)(uintptr_t)dmac_descriptors)) {
+    if (irq_priority < NVIC_GetPriority(DMAC_IRQn)) {
+      NVIC_SetPriority(DMAC_IRQn, irq_priority);
+    }
+    return;
+  }
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC; // Enable the AHB clock of the DMAC
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC; // Enable the APB clock of the DMAC
+  if ((DMAC->BASEADDR.reg != 0) && (DMAC->WRBADDR.reg != 0)) {
+    // The sketch or another library configured the DMAC: share its tables, rather than resetting the channels it uses
+    dmac_descriptors = (DmacDescriptor*)(uintptr_t)DMAC->BASEADDR.reg;
+    dmac_writeback = (DmacDescriptor*)(uintptr_t)DMAC->WRBADDR.reg;
+    DMAC->CTRL.reg |= DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF); // Enable the DMAC and all priority levels
+  } else {
+    dmac_descriptors = dmac_descriptor_table;
+    dmac_writeback = dmac_writeback_table;
+    DMAC->CTRL.bit.SWRST = 1; // Reset the DMAC
+    while (DMAC->CTRL.bit.SWRST); // Wait until software reset is complete.
+    DMAC->BASEADDR.reg = (uint32_t)(uintptr_t)dmac_descriptors; // Address of the descriptor table
+    DMAC->WRBADDR.reg = (uint32_t)(uintptr_t)dmac_writeback; // Address of the write-back table
+    DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF); // Enable the DMAC and all priority levels
+  }
+  NVIC_SetPriority(DMAC_IRQn, irq_priority);
+  NVIC_EnableIRQ(DMAC_IRQn);
+}
+
 // Constructors //
 
 Sercom0SPISlave::Sercom0SPISlave() {}
@@ -82,572 +222,1423 @@ Sercom2SPISlave::Sercom2SPISlave() {}
 Sercom3SPISlave::Sercom3SPISlave() {}
 Sercom4SPISlave::Sercom4SPISlave() {}
 Sercom5SPISlave::Sercom5SPISlave() {}
-SercomSPISlave::SercomSPISlave() {}
+SercomSPISlave::SercomSPISlave()
+    : pins_(),
+      sercom_(NULL),
+      sercom_no_(0),
+      char_bytes_(1),
+      profile_(kFullDuplex),
+      dma_channel_(-1),
+      dma_buffer_(NULL),
+      dma_length_(0),
+      dma_callback_(NULL),
+      dma_second_half_(false),
+      response_(NULL),
+      response_length_(0),
+      response_index_(0),
+      response_flush_(false),
+      transaction_length_(0),
+      frame_callback_(NULL),
+      framing_(false),
+      frame_length_(0),
+      ping_pong_buffers_(),
+      ping_pong_size_(0),
+      ping_pong_active_(0),
+      ping_pong_index_(0),
+      ping_pong_state_(kPingPongFree),
+      ping_pong_length_(0),
+      frame_pool_(NULL),
+      pool_slot_(-1),
+      pool_length_(0),
+      stats_(),
+      isr_cycles_(0),
+      dma_counted_position_(0),
+      error_callback_(NULL),
+      resync_(false),
+      transaction_active_(false),
+      transaction_ended_(false),
+      ended_(false),
+      register_map_(NULL),
+      register_size_(0),
+      register_write_mask_(NULL),
+      register_callback_(NULL),
+      register_address_(0),
+      register_first_(0),
+      register_write_(false),
+      crc_(NULL),
+      rx_crc_(0),
+      crc_history_(),
+      crc_tail_(0),
+      dma_crc_position_(0),
+      dma_transaction_length_(0),
+      last_crc_(0),
+      last_crc_valid_(false),
+      dma_crc_(kDmaCrc16),
+      timestamp_extint_(0),
+      timestamp_evsys_channel_(0),
+      timestamp_storage_(NULL),
+      latency_bin_ticks_(1),
+      timestamp_start_(0),
+      timestamp_start_valid_(false),
+      last_timestamps_(),
+      frame_timestamps_read_(),
+      tx_dma_channel_(-1),
+      tx_segment_count_(0) {}
 
-// Public Methods //
+// CRC //
+
+// Reverse the order of the lowest width bits of value
+static uint32_t ReflectBits(uint32_t value, uint8_t width) {
+  uint32_t reflected = 0;
+  for (uint8_t i = 0; i < width; i++) {
+    reflected = (reflected << 1) | ((value >> i) & 0x1);
+  }
+  return reflected;
+}
 
-void Sercom0SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
+SercomSPISlaveCrc::SercomSPISlaveCrc(uint8_t width, uint32_t polynomial, uint32_t init, bool reflected, uint32_t xor_out)
+    : start_(0), xor_out_(0), width_(width), reflected_(reflected) {
+  uint32_t mask = (width_ >= 32) ? 0xFFFFFFFF : ((1UL << width_) - 1);
   /* Explanation:
-  The selection of peripheral function A to H is done by writing to the Peripheral Multiplexing Odd and Even bits in the Peripheral Multiplexing register (PMUXn.PMUXE/O) in the PORT.
-  Reference: Atmel-42181G-SAM-D21_Datasheet section 6.1 on page 21
-  
-  In general:
-  Px(2n+0/1) corresponds to Portx, PMUX[n], 0=Even=PMUXE/1=Odd=PMUXO
-  
-  Example:
-  PA07 corresponds to PortA, PMUX[3], PMUXO
+  A reflected CRC shifts the register to the right and keeps it in the lowest width bits, with the reflected polynomial.
+  A non-reflected CRC shifts the register to the left and keeps it in the highest width bits, such that the byte combined with the register is always its most significant byte.
   */
-  // Configure SERCOM0       SPI Pins   PAD  Explanation
-  switch (MOSI_Pin) {
-    case PA04:
-      // Set PA04 as input   (MOSI)    0    PA04 corresponds to: PORTA, PMUX[2], Even
-      PORT->Group[PORTA].PINCFG[4].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA04
-      PORT->Group[PORTA].PMUX[2].bit.PMUXE = 0x3; // SERCOM0 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA08:
-      // Set PA08 as input   (MOSI)    0    PA08 corresponds to: PORTA, PMUX[4], Even
-      PORT->Group[PORTA].PINCFG[8].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA08
-      PORT->Group[PORTA].PMUX[4].bit.PMUXE = 0x2; // SERCOM0 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MOSI_Pin != PA04) || (MOSI_Pin != PA08))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM0"
-      #endif
-      break;
+  if (reflected_) {
+    uint32_t poly = ReflectBits(polynomial & mask, width_);
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        c = (c & 0x1) ? ((c >> 1) ^ poly) : (c >> 1);
+      }
+      table_[i] = c;
+    }
+    start_ = ReflectBits(init & mask, width_);
+  } else {
+    uint32_t poly = (polynomial & mask) << (32 - width_);
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i << 24;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        c = (c & 0x80000000) ? ((c << 1) ^ poly) : (c << 1);
+      }
+      table_[i] = c;
+    }
+    start_ = (init & mask) << (32 - width_);
   }
+  xor_out_ = xor_out & mask;
+}
 
-  switch (SCK_Pin) {
-    case PA05:
-      // Set PA05 as input   (SCK)     1    PA05 corresponds to: PORTA, PMUX[2], Odd
-      PORT->Group[PORTA].PINCFG[5].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA05
-      PORT->Group[PORTA].PMUX[2].bit.PMUXO = 0x3; // SERCOM0 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA09:
-      // Set PA09 as input   (SCK)     1    PA09 corresponds to: PORTA, PMUX[4], Odd
-      PORT->Group[PORTA].PINCFG[9].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA09
-      PORT->Group[PORTA].PMUX[4].bit.PMUXO = 0x2; // SERCOM0 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SCK_Pin != PA05) || (SCK_Pin != PA09))
-       #error "The pin selected is not available as SCK_Pin for SERCOM0"
-      #endif
-      break;
+uint32_t SercomSPISlaveCrc::Update(uint32_t crc, const volatile uint8_t* data, size_t length) const {
+  for (size_t i = 0; i < length; i++) {
+    crc = Update(crc, data[i]);
   }
+  return crc;
+}
 
-  switch (SS_Pin) {
-    case PA06:
-      // Set PA06 as input   (SS)      2    PA06 corresponds to: PORTA, PMUX[3], Even
-      PORT->Group[PORTA].PINCFG[6].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA06
-      PORT->Group[PORTA].PMUX[3].bit.PMUXE = 0x3; // SERCOM0 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA10:
-      // Set PA10 as input   (SS)      2    PA10 corresponds to: PORTA, PMUX[5], Even
-      PORT->Group[PORTA].PINCFG[10].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA10
-      PORT->Group[PORTA].PMUX[5].bit.PMUXE = 0x2; // SERCOM0 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SS_Pin != PA06) || (SS_Pin != PA10))
-       #error "The pin selected is not available as SS_Pin for SERCOM0"
-      #endif
-      break;
+uint32_t SercomSPISlaveCrc::Finish(uint32_t crc) const {
+  return (reflected_ ? crc : (crc >> (32 - width_))) ^ xor_out_;
+}
+
+uint32_t SercomSPISlaveCrc::FromBytes(uint32_t bytes) const {
+  if (!reflected_) {
+    return (width_ >= 32) ? bytes : (bytes & ((1UL << width_) - 1)); // Most significant byte first
   }
+  uint32_t crc = 0;
+  for (uint8_t i = 0; i < Bytes(); i++) {
+    crc |= ((bytes >> (8 * (Bytes() - 1 - i))) & 0xFF) << (8 * i); // Least significant byte first
+  }
+  return crc;
+}
 
-  switch (MISO_Pin) {
-    case PA07:
-      // Set PA07 as output  (MISO)    3    PA07 corresponds to: PORTA, PMUX[3], Odd
-      PORT->Group[PORTA].PINCFG[7].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA07
-      PORT->Group[PORTA].PMUX[3].bit.PMUXO = 0x3; // SERCOM0 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA11:
-      // Set PA11 as output  (MISO)    3    PA11 corresponds to: PORTA, PMUX[5], Odd
-      PORT->Group[PORTA].PINCFG[11].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM0 SPI PA11
-      PORT->Group[PORTA].PMUX[5].bit.PMUXO = 0x2; // SERCOM0 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MISO_Pin != PA07) || (MISO_Pin != PA11))
-       #error "The pin selected is not available as MISO_Pin for SERCOM0"
-      #endif
-      break;
-  }  
+void SercomSPISlaveCrc::ToBytes(uint32_t crc, uint8_t* bytes) const {
+  for (uint8_t i = 0; i < Bytes(); i++) {
+    bytes[i] = (uint8_t)(crc >> (reflected_ ? (8 * i) : (8 * (Bytes() - 1 - i))));
+  }
+}
 
-  // Initialize SERCOM0 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM0);
+size_t SercomSPISlaveCrc::Append(uint8_t* buffer, size_t length) const {
+  ToBytes(Compute(buffer, length), buffer + length);
+  return length + Bytes();
 }
 
-void Sercom1SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
-  // Configure SERCOM1       SPI Pins  PAD  Explanation
-  switch (MOSI_Pin) {
-    case PA00:
-      // Set PA00 as input   (MOSI)    0    PA00 corresponds to: PORTA, PMUX[0], Even
-      PORT->Group[PORTA].PINCFG[0].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA00
-      PORT->Group[PORTA].PMUX[0].bit.PMUXE = 0x3; // SERCOM1 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA16:
-      // Set PA16 as input   (MOSI)    0    PA16 corresponds to: PORTA, PMUX[8], Even
-      PORT->Group[PORTA].PINCFG[16].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA16, Arduino PIN11
-      PORT->Group[PORTA].PMUX[8].bit.PMUXE = 0x2; // SERCOM1 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MOSI_Pin != PA00) || (MOSI_Pin != PA16))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM1"
-      #endif
-      break;
+// Frame pool //
+
+SercomSPISlaveFramePool::SercomSPISlaveFramePool(uint8_t* storage, uint8_t* next, uint16_t* lengths, uint16_t slot_size, uint8_t slot_count)
+    : storage_(storage),
+      next_(next),
+      lengths_(lengths),
+      slot_size_(slot_size),
+      slot_count_(slot_count) {
+  Clear();
+}
+
+int SercomSPISlaveFramePool::SlotOf(const uint8_t* buffer) const {
+  if ((buffer < storage_) || (buffer >= storage_ + (size_t)slot_count_ * slot_size_) || ((size_t)(buffer - storage_) % slot_size_ != 0)) {
+    return -1;
   }
+  return (buffer - storage_) / slot_size_;
+}
 
-  switch (SCK_Pin) {
-    case PA01:
-      // Set PA01 as input   (SCK)     1    PA01 corresponds to: PORTA, PMUX[0], Odd
-      PORT->Group[PORTA].PINCFG[1].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA01
-      PORT->Group[PORTA].PMUX[0].bit.PMUXO = 0x3; // SERCOM1 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA17:
-      // Set PA17 as input   (SCK)     1    PA17 corresponds to: PORTA, PMUX[8], Odd
-      PORT->Group[PORTA].PINCFG[17].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA17, Arduino PIN13
-      PORT->Group[PORTA].PMUX[8].bit.PMUXO = 0x2; // SERCOM1 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SCK_Pin != PA01) || (SCK_Pin != PA17))
-       #error "The pin selected is not available as SCK_Pin for SERCOM1"
-      #endif
-      break;
+int SercomSPISlaveFramePool::Claim() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // The receive path and the application both change the lists
+  uint8_t slot = free_head_;
+  if (slot != kNone) {
+    free_head_ = next_[slot];
+    next_[slot] = kClaimed;
+    used_count_++;
+    if (used_count_ > high_water_mark_) {
+      high_water_mark_ = used_count_;
+    }
   }
+  __set_PRIMASK(primask);
+  return (slot == kNone) ? -1 : slot;
+}
 
-  switch (SS_Pin) {
-    case PA18:
-      // Set PA18 as input   (SS)      2    PA18 corresponds to: PORTA, PMUX[9], Even
-      PORT->Group[PORTA].PINCFG[18].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA18, Arduino PIN10
-      PORT->Group[PORTA].PMUX[9].bit.PMUXE = 0x2; // SERCOM1 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PA30:
-      // Set PA30 as input   (SS)      2    PA30 corresponds to: PORTA, PMUX[15], Even
-      PORT->Group[PORTA].PINCFG[30].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA30
-      PORT->Group[PORTA].PMUX[15].bit.PMUXE = 0x3; // SERCOM1 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((SS_Pin != PA18) || (SS_Pin != PA30))
-       #error "The pin selected is not available as SS_Pin for SERCOM1"
-      #endif
-      break;
+void SercomSPISlaveFramePool::Commit(uint8_t slot, uint16_t length) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if ((slot < slot_count_) && (next_[slot] == kClaimed)) {
+    lengths_[slot] = length;
+    next_[slot] = kNone;
+    if (ready_head_ == kNone) {
+      ready_head_ = slot;
+    } else {
+      next_[ready_tail_] = slot;
+    }
+    ready_tail_ = slot;
+    ready_count_++;
   }
+  __set_PRIMASK(primask);
+}
 
-  switch (MISO_Pin) {
-    case PA19:
-      // Set PA19 as output  (MISO)    3    PA19 corresponds to: PORTA, PMUX[9], Odd
-      PORT->Group[PORTA].PINCFG[19].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA19, Arduino PIN12
-      PORT->Group[PORTA].PMUX[9].bit.PMUXO = 0x2; // SERCOM1 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PA31:
-      // Set PA31 as output  (MISO)    3    PA31 corresponds to: PORTA, PMUX[15], Odd
-      PORT->Group[PORTA].PINCFG[31].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM1 SPI PA31
-      PORT->Group[PORTA].PMUX[15].bit.PMUXO = 0x3; // SERCOM1 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((MISO_Pin != PA19) || (MISO_Pin != PA31))
-       #error "The pin selected is not available as MISO_Pin for SERCOM1"
-      #endif
-      break;
+int SercomSPISlaveFramePool::Take(uint16_t* length) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint8_t slot = ready_head_;
+  if (slot != kNone) {
+    ready_head_ = next_[slot];
+    next_[slot] = kLent;
+    ready_count_--;
+    if (length != NULL) {
+      *length = lengths_[slot];
+    }
   }
+  __set_PRIMASK(primask);
+  return (slot == kNone) ? -1 : slot;
+}
 
-  // Initialize SERCOM1 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM1);
+bool SercomSPISlaveFramePool::FreeSlot(uint8_t slot, uint8_t state) {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  bool released = (slot < slot_count_) && (next_[slot] == state); // A slot is not released twice, and a slot claimed by the receive path is not returned by the application
+  if (released) {
+    next_[slot] = free_head_;
+    free_head_ = slot;
+    used_count_--;
+  }
+  __set_PRIMASK(primask);
+  return released;
 }
 
-void Sercom2SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
-  // Configure SERCOM2       SPI Pins  PAD  Explanation
-  switch (MOSI_Pin) {
-    case PA08:
-      // Set PA08 as input   (MOSI)    0    PA08 corresponds to: PORTA, PMUX[4], Even
-      PORT->Group[PORTA].PINCFG[8].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA08
-      PORT->Group[PORTA].PMUX[4].bit.PMUXE = 0x3; // SERCOM2 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA12:
-      // Set PA12 as input   (MOSI)    0    PA12 corresponds to: PORTA, PMUX[6], Even
-      PORT->Group[PORTA].PINCFG[12].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA16, Arduino PIN11
-      PORT->Group[PORTA].PMUX[6].bit.PMUXE = 0x2; // SERCOM2 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MOSI_Pin != PA08) || (MOSI_Pin != PA12))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM2"
-      #endif
-      break;
+void SercomSPISlaveFramePool::Clear() {
+  for (uint8_t i = 0; i < slot_count_; i++) {
+    next_[i] = (i + 1 < slot_count_) ? i + 1 : kNone;
   }
+  free_head_ = 0;
+  ready_head_ = kNone;
+  ready_tail_ = kNone;
+  ready_count_ = 0;
+  used_count_ = 0;
+  high_water_mark_ = 0;
+}
 
-  switch (SCK_Pin) {
-    case PA09:
-      // Set PA09 as input   (SCK)     1    PA09 corresponds to: PORTA, PMUX[4], Odd
-      PORT->Group[PORTA].PINCFG[9].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA09
-      PORT->Group[PORTA].PMUX[4].bit.PMUXO = 0x3; // SERCOM2 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA13:
-      // Set PA13 as input   (SCK)     1    PA13 corresponds to: PORTA, PMUX[6], Odd
-      PORT->Group[PORTA].PINCFG[13].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA17, Arduino PIN13
-      PORT->Group[PORTA].PMUX[6].bit.PMUXO = 0x2; // SERCOM2 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SCK_Pin != PA09) || (SCK_Pin != PA13))
-       #error "The pin selected is not available as SCK_Pin for SERCOM2"
-      #endif
-      break;
+// Public Methods //
+
+bool Sercom0SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM0, 0, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool Sercom1SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM1, 1, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool Sercom2SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM2, 2, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool Sercom3SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM3, 3, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool Sercom4SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM4, 4, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool Sercom5SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  return SercomPadInit(SERCOM5, 5, (uint8_t)MOSI_Pin, (uint8_t)SCK_Pin, (uint8_t)SS_Pin, (uint8_t)MISO_Pin, char_size, profile, irq_priority, gclk_generator);
+}
+
+bool SercomSPISlave::setMode(uint8_t cpol, uint8_t cpha, uint8_t dord) {
+  if ((sercom_ == NULL) || transaction_active_) {
+    return false;
   }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent IrqHandler from loading a character while the SERCOM is disabled
+  Reconfigure(SERCOM_SPI_CTRLA_CPOL | SERCOM_SPI_CTRLA_CPHA | SERCOM_SPI_CTRLA_DORD,
+              (cpol ? SERCOM_SPI_CTRLA_CPOL : 0) | (cpha ? SERCOM_SPI_CTRLA_CPHA : 0) | (dord ? SERCOM_SPI_CTRLA_DORD : 0), // page 492
+              0, 0);
+  EnableIrq();
+  return true;
+}
 
-  switch (SS_Pin) {
-    case PA10:
-      // Set PA10 as input   (SS)      2    PA10 corresponds to: PORTA, PMUX[5], Even
-      PORT->Group[PORTA].PINCFG[10].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA10
-      PORT->Group[PORTA].PMUX[5].bit.PMUXE = 0x3; // SERCOM2 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA14:
-      // Set PA14 as input   (SS)      2    PA14 corresponds to: PORTA, PMUX[7], Even
-      PORT->Group[PORTA].PINCFG[14].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA14
-      PORT->Group[PORTA].PMUX[7].bit.PMUXE = 0x2; // SERCOM2 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SS_Pin != PA10) || (SS_Pin != PA14))
-       #error "The pin selected is not available as SS_Pin for SERCOM2"
-      #endif
-      break;
+bool SercomSPISlave::setCharSize(CharSize char_size) {
+  if ((sercom_ == NULL) || transaction_active_ || (dma_channel_ >= 0) || (tx_dma_channel_ >= 0)) {
+    return false; // The DMA paths transfer characters of the size they were enabled with
+  }
+  if ((char_size == kCharSize9) && ((register_map_ != NULL) || (crc_ != NULL))) {
+    return false; // The register map and the CRC work on bytes
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent IrqHandler from using the buffers while they are cleared
+  char_bytes_ = (char_size == kCharSize9) ? 2 : 1;
+  rx_buffer_.Clear();
+  tx_buffer_.Clear();
+  frame_lengths_.Clear();
+  frame_crcs_.Clear();
+  frame_crc_valid_.Clear();
+  if (timestamp_storage_ != NULL) {
+    timestamp_storage_->frames.Clear();
+  }
+  frame_length_ = 0;
+  ping_pong_index_ = 0;
+  if (ping_pong_state_ == kPingPongFull) {
+    ping_pong_state_ = kPingPongFree; // The frame not yet lent holds characters of the previous size
   }
+  response_ = NULL;
+  response_index_ = 0;
+  sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE; // Nothing is left to transmit
+  Reconfigure(0, 0, SERCOM_SPI_CTRLB_CHSIZE_Msk, SERCOM_SPI_CTRLB_CHSIZE(char_size)); // page 497
+  EnableIrq();
+  return true;
+}
 
-  switch (MISO_Pin) {
-    case PA11:
-      // Set PA11 as output  (MISO)    3    PA11 corresponds to: PORTA, PMUX[5], Odd
-      PORT->Group[PORTA].PINCFG[11].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA11
-      PORT->Group[PORTA].PMUX[5].bit.PMUXO = 0x3; // SERCOM2 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA15:
-      // Set PA15 as output  (MISO)    3    PA15 corresponds to: PORTA, PMUX[7], Odd
-      PORT->Group[PORTA].PINCFG[15].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM2 SPI PA15
-      PORT->Group[PORTA].PMUX[7].bit.PMUXO = 0x2; // SERCOM2 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MISO_Pin != PA11) || (MISO_Pin != PA15))
-       #error "The pin selected is not available as MISO_Pin for SERCOM2"
-      #endif
-      break;
+void SercomSPISlave::end() {
+  if (sercom_ == NULL) {
+    return;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq);
+  ended_ = true; // The functions that disable the SERCOM or its interrupt for a moment leave them disabled
+  sercom_->SPI.CTRLA.bit.ENABLE = 0; // page 481
+  while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is disabled.
+  for (uint8_t i = 0; i < 4; i++) {
+    PORT->Group[pins_[i] / 32].PINCFG[pins_[i] % 32].bit.PMUXEN = 0x0; // Return the pin to the PORT. The PMUX value is kept for begin().
   }
 
-  // Initialize SERCOM2 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM2);
+  // Discard the transaction in progress, as TransactionEnd() is not called for it
+  if (framing_) {
+    rx_buffer_.Rewind(frame_length_ * char_bytes_);
+  }
+  frame_length_ = 0;
+  ping_pong_index_ = 0;
+  if ((frame_pool_ != NULL) && (pool_slot_ >= 0)) {
+    frame_pool_->Release(pool_slot_);
+  }
+  pool_slot_ = -1;
+  pool_length_ = 0;
+  transaction_length_ = 0;
+  transaction_active_ = false;
+  resync_ = false;
+  const SercomSPISlaveCrc* crc = crc_;
+  if (crc != NULL) {
+    rx_crc_ = crc->Start();
+    crc_tail_ = 0;
+  }
 }
 
-void Sercom3SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
-  // Configure SERCOM3       SPI Pins   PAD  Explanation
-  switch (MOSI_Pin) {
-    case PA16:
-      // Set PA16 as input   (MOSI)    0    PA16 corresponds to: PORTA, PMUX[8], Even
-      PORT->Group[PORTA].PINCFG[16].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA16, Arduino PIN11
-      PORT->Group[PORTA].PMUX[8].bit.PMUXE = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA22:
-      // Set PA22 as input   (MOSI)    0    PA22 corresponds to: PORTA, PMUX[11], Even
-      PORT->Group[PORTA].PINCFG[22].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA22
-      PORT->Group[PORTA].PMUX[11].bit.PMUXE = 0x2; // SERCOM3 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MOSI_Pin != PA16) || (MOSI_Pin != PA22))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM3"
-      #endif
-      break;
+bool SercomSPISlave::begin() {
+  if (sercom_ == NULL) {
+    return false;
+  }
+  if (!ended_) {
+    return true; // end() has not been called
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    PORT->Group[pins_[i] / 32].PINCFG[pins_[i] % 32].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing
+  }
+  instances_[sercom_no_] = this;
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  sercom_->SPI.CTRLA.bit.ENABLE = 1; // page 481
+  while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is enabled.
+  ended_ = false;
+  RestartTransmit();
+  if (timestamp_owner_ == this) {
+    TC4->COUNT32.INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_ERR; // Discard the edges captured while the slave was stopped
   }
+  NVIC_ClearPendingIRQ(irq);
+  NVIC_EnableIRQ(irq);
+  return true;
+}
 
-  switch (SCK_Pin) {
-    case PA17:
-      // Set PA17 as input   (SCK)     1    PA17 corresponds to: PORTA, PMUX[8], Odd
-      PORT->Group[PORTA].PINCFG[17].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA17, Arduino PIN13
-      PORT->Group[PORTA].PMUX[8].bit.PMUXO = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA23:
-      // Set PA23 as input   (SCK)     1    PA23 corresponds to: PORTA, PMUX[11], Odd
-      PORT->Group[PORTA].PINCFG[23].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA23
-      PORT->Group[PORTA].PMUX[11].bit.PMUXO = 0x2; // SERCOM3 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SCK_Pin != PA17) || (SCK_Pin != PA23))
-       #error "The pin selected is not available as SCK_Pin for SERCOM3"
-      #endif
-      break;
+int SercomSPISlave::available() {
+  return rx_buffer_.Available() / char_bytes_;
+}
+
+int SercomSPISlave::read() {
+  if (char_bytes_ == 1) {
+    return rx_buffer_.Pop();
   }
+  uint16_t data;
+  return (rx_buffer_.Read((uint8_t*)&data, 2) == 2) ? data : -1; // In 9-bit mode the buffer holds whole characters, so 0 or 2 bytes are read
+}
 
-  switch (SS_Pin) {
-    case PA18:
-      // Set PA18 as input   (SS)      2    PA18 corresponds to: PORTA, PMUX[9], Even
-      PORT->Group[PORTA].PINCFG[18].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA18, Arduino PIN10
-      PORT->Group[PORTA].PMUX[9].bit.PMUXE = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA20:
-      // Set PA20 as input   (SS)      2    PA20 corresponds to: PORTA, PMUX[10], Even
-      PORT->Group[PORTA].PINCFG[20].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA20
-      PORT->Group[PORTA].PMUX[10].bit.PMUXE = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA24:
-      // Set PA24 as input   (SS)      2    PA24 corresponds to: PORTA, PMUX[12], Even
-      PORT->Group[PORTA].PINCFG[24].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA24
-      PORT->Group[PORTA].PMUX[12].bit.PMUXE = 0x2; // SERCOM3 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SS_Pin != PA18) || (SS_Pin != PA20) || (SS_Pin != PA24))
-       #error "The pin selected is not available as SS_Pin for SERCOM3"
-      #endif
-      break;
+size_t SercomSPISlave::read(uint8_t* buffer, size_t length) {
+  return rx_buffer_.Read(buffer, (length > 0xFFFF) ? 0xFFFF : length);
+}
+
+size_t SercomSPISlave::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  unsigned long start = millis();
+  while (count < length) {
+    size_t copied = read((uint8_t*)buffer + count, length - count);
+    if (copied > 0) {
+      count += copied;
+      start = millis(); // As in Stream::readBytes(), the timeout applies to each wait for data
+    } else if (millis() - start >= _timeout) {
+      break;
+    }
   }
+  return count;
+}
 
-  switch (MISO_Pin) {
-    case PA19:
-      // Set PA19 as output  (MISO)    3    PA19 corresponds to: PORTA, PMUX[9], Odd
-      PORT->Group[PORTA].PINCFG[19].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA19, Arduino PIN12
-      PORT->Group[PORTA].PMUX[9].bit.PMUXO = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA21:
-      // Set PA21 as output  (MISO)    3    PA21 corresponds to: PORTA, PMUX[10], Odd
-      PORT->Group[PORTA].PINCFG[21].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA21
-      PORT->Group[PORTA].PMUX[10].bit.PMUXO = 0x3; // SERCOM3 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PA25:
-      // Set PA25 as output  (MISO)    3    PA25 corresponds to: PORTA, PMUX[12], Odd
-      PORT->Group[PORTA].PINCFG[25].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM3 SPI PA25
-      PORT->Group[PORTA].PMUX[12].bit.PMUXO = 0x2; // SERCOM3 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)      
-      break;
-    default:
-      #if ((MISO_Pin != PA19) || (MISO_Pin != PA21) || (MISO_Pin != PA25))
-       #error "The pin selected is not available as MISO_Pin for SERCOM3"
-      #endif
-      break;
+size_t SercomSPISlave::read(uint16_t* buffer, size_t length) {
+  if (length > 0x7FFF) {
+    length = 0x7FFF;
   }
+  if (char_bytes_ == 2) {
+    return rx_buffer_.Read((uint8_t*)buffer, length * 2) / 2; // The characters are stored in the byte order of the CPU, so they are copied as is
+  }
+  size_t count = 0;
+  int data;
+  while ((count < length) && ((data = rx_buffer_.Pop()) >= 0)) {
+    buffer[count++] = data;
+  }
+  return count;
+}
 
-  // Initialize SERCOM3 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM3);
+int SercomSPISlave::peek() {
+  if (char_bytes_ == 1) {
+    return rx_buffer_.Peek();
+  }
+  int low = rx_buffer_.Peek(0);
+  int high = rx_buffer_.Peek(1);
+  return (high < 0) ? -1 : (low | (high << 8));
 }
 
-void Sercom4SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
-  // Configure SERCOM4       SPI Pins   PAD  Explanation
-  switch (MOSI_Pin) {
-    case PA12:
-      // Set PA12 as input   (MOSI)     0    PA12 corresponds to: PORTA, PMUX[6], Even
-      PORT->Group[PORTA].PINCFG[12].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PA12, Arduino PIN22
-      PORT->Group[PORTA].PMUX[6].bit.PMUXE = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB08:
-      // Set PB08 as input   (MOSI)     0    PB08 corresponds to: PORTB, PMUX[4], Even
-      PORT->Group[PORTB].PINCFG[8].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB08
-      PORT->Group[PORTB].PMUX[4].bit.PMUXE = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)  
-      break;
-    case PB12:
-      // Set PB12 as input   (MOSI)     0    PB12 corresponds to: PORTB, PMUX[6], Even
-      PORT->Group[PORTB].PINCFG[12].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB12
-      PORT->Group[PORTB].PMUX[6].bit.PMUXE = 0x2; // SERCOM4 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)  
-      break;
-    default:
-      #if ((MOSI_Pin != PA12) || (MOSI_Pin != PB08) || (MOSI_Pin != PB12))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM4"
-      #endif
-      break;
+void SercomSPISlave::enableFraming(FrameCallback callback) {
+  disablePingPong();
+  disableFramePool();
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from storing bytes while the buffers are cleared
+  }
+  frame_callback_ = callback;
+  frame_lengths_.Clear();
+  frame_crcs_.Clear();
+  frame_crc_valid_.Clear();
+  if (timestamp_storage_ != NULL) {
+    timestamp_storage_->frames.Clear();
   }
+  rx_buffer_.Clear();
+  frame_length_ = 0;
+  framing_ = true;
+  if (sercom_ != NULL) {
+    EnableIrq();
+  }
+}
 
-  switch (SCK_Pin) {
-    case PA13:
-      // Set PA13 as input   (SCK)      1    PA13 corresponds to: PORTA, PMUX[6], Odd
-      PORT->Group[PORTA].PINCFG[13].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PA13
-      PORT->Group[PORTA].PMUX[6].bit.PMUXO = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB09:
-      // Set PB09 as input   (SCK)      1    PB09 corresponds to: PORTB, PMUX[4], Odd
-      PORT->Group[PORTB].PINCFG[9].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB09, Arduino PIN16
-      PORT->Group[PORTB].PMUX[4].bit.PMUXO = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB13:
-      // Set PB13 as input   (SCK)      1    PB13 corresponds to: PORTB, PMUX[6], Odd
-      PORT->Group[PORTB].PINCFG[13].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB13
-      PORT->Group[PORTB].PMUX[6].bit.PMUXO = 0x2; // SERCOM4 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SCK_Pin != PA13) || (SCK_Pin != PB09) || (SCK_Pin != PB13))
-        #error "The pin selected is not available as SCK_Pin for SERCOM4"
-      #endif
-      break;
+void SercomSPISlave::disableFraming() {
+  framing_ = false;
+  frame_lengths_.Clear();
+  frame_crcs_.Clear();
+  frame_crc_valid_.Clear();
+  if (timestamp_storage_ != NULL) {
+    timestamp_storage_->frames.Clear();
   }
+}
 
-  switch (SS_Pin) {
-    case PA14:
-      // Set PA14 as input   (SS)       2    PA14 corresponds to: PORTA, PMUX[7], Even
-      PORT->Group[PORTA].PINCFG[14].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PA14
-      PORT->Group[PORTA].PMUX[7].bit.PMUXE = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB10:
-      // Set PB10 as input   (SS)       2    PB10 corresponds to: PORTB, PMUX[5], Even
-      PORT->Group[PORTB].PINCFG[10].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB10, Arduino PIN23
-      PORT->Group[PORTB].PMUX[5].bit.PMUXE = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB14:
-      // Set PB14 as input   (SS)       2    PB14 corresponds to: PORTB, PMUX[7], Even
-      PORT->Group[PORTB].PINCFG[14].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB14
-      PORT->Group[PORTB].PMUX[7].bit.PMUXE = 0x2; // SERCOM4 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((SS_Pin != PA14) || (SS_Pin != PB10) || (SS_Pin != PB14))
-        #error "The pin selected is not available as SS_Pin for SERCOM4"
-      #endif
-      break;
+int SercomSPISlave::availableFrames() {
+  SercomSPISlaveFramePool* pool = frame_pool_;
+  if (pool != NULL) {
+    return pool->Available();
   }
+  if (ping_pong_buffers_[0] != NULL) {
+    return (ping_pong_state_ == kPingPongFull) ? 1 : 0;
+  }
+  return frame_lengths_.Available();
+}
 
-  switch (MISO_Pin) {
-    case PA15:
-      // Set PA15 as output  (MISO)     3    PA15 corresponds to: PORTA, PMUX[7], Odd
-      PORT->Group[PORTA].PINCFG[15].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PA15, Arduino PIN23
-      PORT->Group[PORTA].PMUX[7].bit.PMUXO = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB11:
-      // Set PB11 as output  (MISO)     3    PB11 corresponds to: PORTB, PMUX[5], Odd
-      PORT->Group[PORTB].PINCFG[11].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB11, Arduino PIN24
-      PORT->Group[PORTB].PMUX[5].bit.PMUXO = 0x3; // SERCOM4 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB15:
-      // Set PB15 as output  (MISO)     3    PB15 corresponds to: PORTB, PMUX[7], Odd
-      PORT->Group[PORTB].PINCFG[15].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM4 SPI PB15
-      PORT->Group[PORTB].PMUX[7].bit.PMUXO = 0x2; // SERCOM4 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    default:
-      #if ((MISO_Pin != PA15) || (MISO_Pin != PB11) || (MISO_Pin != PB15))
-        #error "The pin selected is not available as MISO_Pin for SERCOM4"
-      #endif
-      break;
+size_t SercomSPISlave::readFrame(uint8_t* buffer, size_t size) {
+  bool crc_valid;
+  return readFrame(buffer, size, &crc_valid);
+}
+
+size_t SercomSPISlave::readFrame(uint8_t* buffer, size_t size, bool* crc_valid, uint32_t* crc) {
+  *crc_valid = false;
+  int length = frame_lengths_.Peek();
+  if (length <= 0) {
+    return 0; // No frame queued
+  }
+  size_t copied = rx_buffer_.Read(buffer, ((size_t)length < size) ? length : size);
+  rx_buffer_.Skip(length - copied); // Discard the bytes that do not fit in the buffer
+  uint32_t frame_crc = 0;
+  frame_crcs_.Read(&frame_crc, 1);
+  *crc_valid = (frame_crc_valid_.Pop() == 1);
+  frame_timestamps_read_.valid = false;
+  TimestampStorage* storage = timestamp_storage_;
+  if (storage != NULL) {
+    storage->frames.Read(&frame_timestamps_read_, 1);
   }
+  if (crc != NULL) {
+    *crc = frame_crc;
+  }
+  frame_lengths_.Pop(); // Remove the length last, such that IrqHandler does not queue a new frame before the bytes are read
+  return length;
+}
 
-  // Initialize SERCOM4 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM4);
+bool SercomSPISlave::enablePingPong(uint8_t* buffer0, uint8_t* buffer1, size_t size, FrameCallback callback) {
+  if ((buffer0 == NULL) || (buffer1 == NULL) || (buffer0 == buffer1) || (size < char_bytes_) || (size > 0xFFFF) || (register_map_ != NULL) || (dma_channel_ >= 0)) {
+    return false;
+  }
+  disableFraming();
+  disableFramePool();
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from writing to the buffers while they are replaced
+  }
+  ping_pong_buffers_[0] = buffer0;
+  ping_pong_buffers_[1] = buffer1;
+  ping_pong_size_ = size - (size % char_bytes_); // Only whole characters are stored
+  ping_pong_active_ = 0;
+  ping_pong_index_ = 0;
+  ping_pong_state_ = kPingPongFree;
+  ping_pong_length_ = 0;
+  frame_callback_ = callback;
+  frame_length_ = 0;
+  if (sercom_ != NULL) {
+    EnableIrq();
+  }
+  return true;
 }
 
-void Sercom5SPISlave::SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin) {
-  // Configure SERCOM5       SPI Pins  PAD  Explanation
-  switch (MOSI_Pin) {
-    case PB02:
-      // Set PB02 as input   (MOSI)    0    PB02 corresponds to: PORTB, PMUX[1], Even
-      PORT->Group[PORTB].PINCFG[2].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB02
-      PORT->Group[PORTB].PMUX[1].bit.PMUXE = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB16:
-      // Set PB16 as input   (MOSI)    0    PB16 corresponds to: PORTB, PMUX[8], Even
-      PORT->Group[PORTB].PINCFG[16].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB16
-      PORT->Group[PORTB].PMUX[8].bit.PMUXE = 0x2; // SERCOM5 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PB30:
-      // Set PB30 as input   (MOSI)    0    PB30 corresponds to: PORTB, PMUX[15], Even
-      PORT->Group[PORTB].PINCFG[30].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB30
-      PORT->Group[PORTB].PMUX[15].bit.PMUXE = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((MOSI_Pin != PB02) || (MOSI_Pin != PB16) || (MOSI_Pin != PB30))
-       #error "The pin selected is not available as MOSI_Pin for SERCOM5"
-      #endif
-      break;
+void SercomSPISlave::disablePingPong() {
+  if (ping_pong_buffers_[0] == NULL) {
+    return;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from writing to the buffers after this function returns
+  }
+  ping_pong_buffers_[0] = NULL;
+  ping_pong_buffers_[1] = NULL;
+  ping_pong_state_ = kPingPongFree;
+  frame_length_ = 0;
+  if (sercom_ != NULL) {
+    EnableIrq();
   }
+}
 
-  switch (SCK_Pin) {
-    case PB03:
-      // Set PB03 as input   (SCK)     1    PB03 corresponds to: PORTB, PMUX[1], Odd
-      PORT->Group[PORTB].PINCFG[3].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB03
-      PORT->Group[PORTB].PMUX[1].bit.PMUXO = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB17:
-      // Set PB17 as input   (SCK)     1    PB17 corresponds to: PORTB, PMUX[8], Odd
-      PORT->Group[PORTB].PINCFG[17].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB17
-      PORT->Group[PORTB].PMUX[8].bit.PMUXO = 0x2; // SERCOM5 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PB31:
-      // Set PB31 as input   (SCK)     1    PB31 corresponds to: PORTB, PMUX[15], Odd
-      PORT->Group[PORTB].PINCFG[31].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB31
-      PORT->Group[PORTB].PMUX[15].bit.PMUXO = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((SCK_Pin != PB03) || (SCK_Pin != PB17) || (SCK_Pin != PB31))
-        #error "The pin selected is not available as SCK_Pin for SERCOM5"
-      #endif
-      break;
+bool SercomSPISlave::enableFramePool(SercomSPISlaveFramePool* pool, FrameCallback callback) {
+  if ((pool == NULL) || (pool->SlotSize() < char_bytes_) || (register_map_ != NULL) || (dma_channel_ >= 0)) {
+    return false;
+  }
+  disableFraming();
+  disablePingPong();
+  disableFramePool();
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from claiming a slot while the pool is replaced
+  }
+  frame_callback_ = callback;
+  frame_length_ = 0;
+  pool_slot_ = -1;
+  pool_length_ = 0;
+  frame_pool_ = pool;
+  if (sercom_ != NULL) {
+    EnableIrq();
   }
+  return true;
+}
 
-  switch (SS_Pin) {
-    case PA20:
-      // Set PA20 as input   (SS)      2    PA20 corresponds to: PORTA, PMUX[10], Even
-      PORT->Group[PORTA].PINCFG[20].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PA20
-      PORT->Group[PORTA].PMUX[10].bit.PMUXE = 0x2; // SERCOM5 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PA24:
-      // Set PA24 as input   (SS)      2    PA24 corresponds to: PORTA, PMUX[12], Even
-      PORT->Group[PORTA].PINCFG[24].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PA24
-      PORT->Group[PORTA].PMUX[12].bit.PMUXE = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB00:
-      // Set PB00 as input   (SS)      2    PB00 corresponds to: PORTB, PMUX[0], Even
-      PORT->Group[PORTB].PINCFG[0].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB00
-      PORT->Group[PORTB].PMUX[0].bit.PMUXE = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB22:
-      // Set PB22 as input   (SS)      2    PB22 corresponds to: PORTB, PMUX[11], Even
-      PORT->Group[PORTB].PINCFG[22].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB22
-      PORT->Group[PORTB].PMUX[11].bit.PMUXE = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((SS_Pin != PA20) || (SS_Pin != PA24) || (SS_Pin != PB00) || (SS_Pin != PB22))
-        #error "The pin selected is not available as SS_Pin for SERCOM5"
-      #endif
-      break;
+void SercomSPISlave::disableFramePool() {
+  if (frame_pool_ == NULL) {
+    return;
   }
-  
-  switch (MISO_Pin) {
-    case PA21:
-      // Set PA21 as output  (MISO)    3    PA21 corresponds to: PORTA, PMUX[10], Odd
-      PORT->Group[PORTA].PINCFG[21].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PA21
-      PORT->Group[PORTA].PMUX[10].bit.PMUXO = 0x2; // SERCOM5 is selected for peripheral use of this pad (0x2 selects peripheral function C: SERCOM)
-      break;
-    case PA25:
-      // Set PA25 as output  (MISO)    3    PA25 corresponds to: PORTA, PMUX[12], Odd
-      PORT->Group[PORTA].PINCFG[25].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PA25
-      PORT->Group[PORTA].PMUX[12].bit.PMUXO = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB01:
-      // Set PB01 as output  (MISO)    3    PB01 corresponds to: PORTB, PMUX[0], Odd
-      PORT->Group[PORTB].PINCFG[1].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB01
-      PORT->Group[PORTB].PMUX[0].bit.PMUXO = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    case PB23:
-      // Set PB23 as output  (MISO)    3    PB23 corresponds to: PORTB, PMUX[11], Odd
-      PORT->Group[PORTB].PINCFG[23].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing for SERCOM5 SPI PB23
-      PORT->Group[PORTB].PMUX[11].bit.PMUXO = 0x3; // SERCOM5 is selected for peripheral use of this pad (0x3 selects peripheral function D: SERCOM-ALT)
-      break;
-    default:
-      #if ((MISO_Pin != PA21) || (MISO_Pin != PA25) || (MISO_Pin != PB01) || (MISO_Pin != PB23))
-        #error "The pin selected is not available as MISO_Pin for SERCOM5"
-      #endif
-      break;
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from writing to a slot after this function returns
+  }
+  if (pool_slot_ >= 0) {
+    frame_pool_->Release(pool_slot_); // The frame of the current transaction is incomplete
+  }
+  pool_slot_ = -1;
+  pool_length_ = 0;
+  frame_length_ = 0;
+  frame_pool_ = NULL;
+  if (sercom_ != NULL) {
+    EnableIrq();
+  }
+}
+
+uint8_t* SercomSPISlave::lendFrame(size_t* length) {
+  SercomSPISlaveFramePool* pool = frame_pool_;
+  if (pool != NULL) {
+    uint16_t frame_length = 0;
+    int slot = pool->Take(&frame_length);
+    if (slot < 0) {
+      return NULL;
+    }
+    if (length != NULL) {
+      *length = frame_length;
+    }
+    return pool->Slot(slot);
+  }
+  if ((ping_pong_buffers_[0] == NULL) || (ping_pong_state_ != kPingPongFull)) {
+    return NULL;
+  }
+  if (length != NULL) {
+    *length = ping_pong_length_;
+  }
+  ping_pong_state_ = kPingPongLent;
+  return ping_pong_buffers_[ping_pong_active_ ^ 1]; // The active buffer does not change while the other one is not kPingPongFree
+}
+
+bool SercomSPISlave::returnFrame(uint8_t* buffer) {
+  SercomSPISlaveFramePool* pool = frame_pool_;
+  if (pool != NULL) {
+    int slot = pool->SlotOf(buffer);
+    return (slot >= 0) && pool->Return(slot); // Return() rejects a slot that is not lent, such as one claimed by IrqHandler
+  }
+  if ((ping_pong_state_ != kPingPongLent) || (buffer == NULL) || (buffer != ping_pong_buffers_[ping_pong_active_ ^ 1])) {
+    return false;
+  }
+  __DMB(); // The application must be done with the buffer before IrqHandler may write to it
+  ping_pong_state_ = kPingPongFree;
+  return true;
+}
+
+bool SercomSPISlave::enableRegisterMap(volatile void* registers, uint8_t size, const uint8_t* write_mask, RegisterWriteCallback callback) {
+  if ((sercom_ == NULL) || (registers == NULL) || (size == 0) || (size > 128) || (char_bytes_ != 1) || (profile_ != kFullDuplex) || (dma_channel_ >= 0) || (tx_dma_channel_ >= 0) || (ping_pong_buffers_[0] != NULL) || (frame_pool_ != NULL)) {
+    return false;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent IrqHandler from using the register map while it is replaced
+  sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE;
+  response_ = NULL;
+  response_index_ = 0;
+  tx_buffer_.Clear();
+  register_size_ = size;
+  register_write_mask_ = write_mask;
+  register_callback_ = callback;
+  register_write_ = false;
+  register_map_ = (volatile uint8_t*)registers;
+  EnableIrq();
+  return true;
+}
+
+void SercomSPISlave::disableRegisterMap() {
+  if (sercom_ == NULL) {
+    register_map_ = NULL;
+    return;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq);
+  sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE;
+  response_ = NULL;
+  response_index_ = 0;
+  register_map_ = NULL;
+  EnableIrq();
+}
+
+bool SercomSPISlave::enableCrc(const SercomSPISlaveCrc* crc) {
+  if ((crc == NULL) || (char_bytes_ != 1) || (dmac_crc_owner_ == this)) {
+    return false;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from updating the CRC while it is reset
+  }
+  if (dma_channel_ >= 0) {
+    NVIC_DisableIRQ(DMAC_IRQn); // Prevent DmaBlockComplete from updating the CRC while it is reset
+  }
+  rx_crc_ = crc->Start();
+  crc_tail_ = 0;
+  size_t position = (dma_channel_ >= 0) ? dmaPosition() : 0;
+  dma_crc_position_ = (position == kDmaPositionError) ? dma_counted_position_ : position; // The CRC starts with the next character
+  dma_transaction_length_ = 0;
+  last_crc_valid_ = false;
+  crc_ = crc;
+  if (dma_channel_ >= 0) {
+    NVIC_EnableIRQ(DMAC_IRQn);
+  }
+  if (sercom_ != NULL) {
+    EnableIrq();
+  }
+  return true;
+}
+
+void SercomSPISlave::disableCrc() {
+  crc_ = NULL;
+  last_crc_valid_ = false;
+}
+
+bool SercomSPISlave::lastTransactionCrc(uint32_t* crc) {
+  if (crc != NULL) {
+    *crc = last_crc_;
+  }
+  return ((crc_ != NULL) || (dmac_crc_owner_ == this)) && last_crc_valid_;
+}
+
+void SercomSPISlave::setErrorCallback(ErrorCallback callback) {
+  error_callback_ = callback;
+}
+
+void SercomSPISlave::enableStandby(WakeSource source) {
+  if (sercom_ == NULL) {
+    return;
+  }
+
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent IrqHandler from loading a character while the SERCOM is disabled
+  bool ssl = (source == kWakeOnSlaveSelect) || (timestamp_owner_ == this); // The timestamps read the Slave Select low capture in the Slave Select Low interrupt
+  if (sercom_->SPI.CTRLB.bit.SSDE != ssl) {
+    Reconfigure(0, 0, SERCOM_SPI_CTRLB_SSDE, ssl ? SERCOM_SPI_CTRLB_SSDE : 0); // Slave Select Low Detect Enable. // page 497
+  }
+  if (ssl) {
+    sercom_->SPI.INTENSET.reg = SERCOM_SPI_INTENSET_SSL; // Enable Slave Select Low interrupt. // page 501
+  } else {
+    sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_SSL;
+  }
+  EnableIrq();
+
+  // Errata: the device may not wake up from standby if the NVM controller is in its power reduction mode. Reference: Atmel-42181G-SAM-D21_Datasheet section 40
+  NVMCTRL->CTRLB.bit.SLEEPPRM = NVMCTRL_CTRLB_SLEEPPRM_DISABLED_Val;
+}
+
+void SercomSPISlave::standby() {
+  /* Explanation:
+  WFI also wakes the core on an interrupt that is pending while interrupts are disabled. Testing the flags with interrupts disabled,
+  and enabling them only after WFI, ensures an interrupt between the test and WFI is not missed.
+  The core sleeps in standby (SCR.SLEEPDEEP) while no transaction is active, and in idle during a transaction, as the wake-up from standby is too slow to serve every character.
+  Reference: ARM Cortex-M0+ Devices Generic User Guide section 2.5
+  */
+  while (true) {
+    __disable_irq();
+    if (transaction_ended_) {
+      break;
+    }
+    bool deep = !transaction_active_;
+    if (deep) {
+      SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk; // Standby
+    } else {
+      SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk; // Idle
+    }
+    __DSB();
+    __WFI();
+    if (deep) {
+      stats_.wakeups++; // Idle sleep is left at every interrupt, including SysTick, so only the wake-ups from standby are counted
+    }
+    __enable_irq(); // Serve the interrupt that woke the core
+  }
+  transaction_ended_ = false;
+  __enable_irq();
+  SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+size_t SercomSPISlave::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t SercomSPISlave::write(const uint8_t* buffer, size_t length) {
+  size_t count;
+  if ((profile_ == kReceiveOnly) || (register_map_ != NULL) || (tx_dma_channel_ >= 0)) {
+    return 0; // Nothing is transmitted from the transmit buffer
+  } else if (char_bytes_ == 1) {
+    count = tx_buffer_.Write(buffer, (length > 0xFFFF) ? 0xFFFF : length);
+  } else {
+    count = 0;
+    while ((count < length) && write16(buffer[count])) {
+      count++;
+    }
+  }
+  if (count > 0) {
+    ArmTransmit(); // Load the characters queued
+  }
+  return count;
+}
+
+size_t SercomSPISlave::writeWithCrc(const uint8_t* buffer, size_t length, const SercomSPISlaveCrc& crc) {
+  if ((profile_ == kReceiveOnly) || (register_map_ != NULL) || (tx_dma_channel_ >= 0) || (char_bytes_ != 1) || (tx_buffer_.Free() < length + crc.Bytes())) {
+    return 0; // The bytes and the CRC are queued together, or not at all
+  }
+  uint8_t crc_bytes[4];
+  crc.ToBytes(crc.Compute(buffer, length), crc_bytes);
+  size_t count = tx_buffer_.Write(buffer, length) + tx_buffer_.Write(crc_bytes, crc.Bytes());
+  ArmTransmit();
+  return count;
+}
+
+size_t SercomSPISlave::write16(uint16_t data) {
+  size_t count;
+  if ((profile_ == kReceiveOnly) || (register_map_ != NULL) || (tx_dma_channel_ >= 0)) {
+    return 0; // Nothing is transmitted from the transmit buffer
+  } else if (char_bytes_ == 1) {
+    count = tx_buffer_.Push((uint8_t)data) ? 1 : 0;
+  } else {
+    count = (tx_buffer_.Free() >= 2) ? tx_buffer_.Write((const uint8_t*)&data, 2) / 2 : 0; // Only queue whole characters
+  }
+  if (count > 0) {
+    ArmTransmit();
+  }
+  return count;
+}
+
+size_t SercomSPISlave::write(const uint16_t* buffer, size_t length) {
+  size_t count;
+  if ((profile_ == kReceiveOnly) || (register_map_ != NULL) || (tx_dma_channel_ >= 0)) {
+    return 0; // Nothing is transmitted from the transmit buffer
+  } else if (char_bytes_ == 2) {
+    count = tx_buffer_.Write((const uint8_t*)buffer, (length > 0x7FFF) ? 0xFFFE : length * 2) / 2; // The free space is always even in 9-bit mode, so only whole characters are queued
+  } else {
+    count = 0;
+    while ((count < length) && tx_buffer_.Push((uint8_t)buffer[count])) {
+      count++;
+    }
+  }
+  if (count > 0) {
+    ArmTransmit();
+  }
+  return count;
+}
+
+int SercomSPISlave::availableForWrite() {
+  return tx_buffer_.Free() / char_bytes_;
+}
+
+void SercomSPISlave::setResponse(const uint8_t* buffer, size_t length) {
+  SetResponse(buffer, length);
+}
+
+void SercomSPISlave::setResponse16(const uint16_t* buffer, size_t length) {
+  SetResponse(buffer, length);
+}
+
+bool SercomSPISlave::enableDMA(uint8_t channel, volatile uint8_t* buffer, size_t length, DmaCallback callback) {
+  if ((sercom_ == NULL) || (buffer == NULL) || (channel >= DMAC_CH_NUM) || (length < 2u * char_bytes_) || (length % (2u * char_bytes_) != 0) || (length / (2u * char_bytes_) > 0xFFFF)) {
+    return false; // SercomInit() has not been called, or an argument is invalid
+  }
+  if (((dmac_channel_owner_[channel] != NULL) && (dmac_channel_owner_[channel] != this)) || ((int)channel == tx_dma_channel_)) {
+    return false; // The channel is already used by another slave, or by the DMA transmit path
+  }
+  if ((ping_pong_buffers_[0] != NULL) || (frame_pool_ != NULL)) {
+    return false; // The ping-pong receive mode and the frame pool need IrqHandler() to write each character
+  }
+  disableDMA();
+  DmacEnable(NVIC_GetPriority((IRQn_Type)(SERCOM0_IRQn + sercom_no_)));
+
+  dma_channel_ = channel;
+  dma_buffer_ = buffer;
+  dma_length_ = length;
+  dma_callback_ = callback;
+  dma_second_half_ = false;
+  dma_counted_position_ = 0;
+  dmac_channel_owner_[channel] = this;
+
+  // Set up the two descriptors, each transferring one half of the circular buffer, and linked to each other
+  size_t half_length = length / 2;
+  DmacDescriptor* first = &dmac_descriptors[channel];
+  DmacDescriptor* second = &dmac_link_descriptors[channel];
+  first->BTCTRL.reg = DMAC_BTCTRL_VALID | // Descriptor is valid
+                      DMAC_BTCTRL_BLOCKACT_INT | // Set the Transfer Complete interrupt flag when the block is transferred
+                      ((char_bytes_ == 2) ? DMAC_BTCTRL_BEATSIZE_HWORD : DMAC_BTCTRL_BEATSIZE_BYTE) | // Transfer one character per beat
+                      DMAC_BTCTRL_DSTINC; // Increment the destination address, the source address is the fixed DATA register
+  first->BTCNT.reg = half_length / char_bytes_; // Number of beats
+  first->SRCADDR.reg = (uint32_t)(uintptr_t)&sercom_->SPI.DATA.reg;
+  first->DSTADDR.reg = (uint32_t)(uintptr_t)(buffer + half_length); // The DMAC expects the end address of the block when the address is incremented
+  first->DESCADDR.reg = (uint32_t)(uintptr_t)second;
+  second->BTCTRL.reg = first->BTCTRL.reg;
+  second->BTCNT.reg = first->BTCNT.reg;
+  second->SRCADDR.reg = first->SRCADDR.reg;
+  second->DSTADDR.reg = (uint32_t)(uintptr_t)(buffer + length);
+  second->DESCADDR.reg = (uint32_t)(uintptr_t)first;
+
+  // Flush bytes received before the DMA receive path is enabled
+  while (sercom_->SPI.INTFLAG.bit.RXC) {
+    (void)sercom_->SPI.DATA.reg;
+  }
+
+  // Set up the DMAC channel
+  NVIC_DisableIRQ(DMAC_IRQn); // DmacIrqHandler also selects channels through CHID
+  DMAC->CHID.reg = DMAC_CHID_ID(channel);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST; // Reset the channel
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST); // Wait until software reset is complete.
+  DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | // Priority level 0
+                      DMAC_CHCTRLB_TRIGSRC(SERCOM0_DMAC_ID_RX + 2 * sercom_no_) | // Triggered by the Receive Complete of the SERCOM
+                      DMAC_CHCTRLB_TRIGACT_BEAT; // Transfer one beat per trigger
+  DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR; // Enable the Transfer Complete and Transfer Error interrupts
+  DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_RUNSTDBY | DMAC_CHCTRLA_ENABLE; // Enable the channel. It runs in standby, such that it keeps receiving while the core sleeps.
+  NVIC_EnableIRQ(DMAC_IRQn);
+
+  // Only the end of a transaction, signalled by the Transmit Complete interrupt, is handled by the CPU
+  sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_SSL | SERCOM_SPI_INTENCLR_RXC | SERCOM_SPI_INTENCLR_ERROR | SERCOM_SPI_INTENCLR_DRE;
+  sercom_->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_TXC; // Clear a Transmit Complete interrupt of an earlier transaction
+  sercom_->SPI.INTENSET.reg = SERCOM_SPI_INTENSET_TXC | ((timestamp_owner_ == this) ? SERCOM_SPI_INTENSET_SSL : 0);
+  return true;
+}
+
+void SercomSPISlave::disableDMA() {
+  if (dma_channel_ < 0) {
+    return;
+  }
+  disableDmaCrc();
+
+  // Disable the DMAC channel
+  NVIC_DisableIRQ(DMAC_IRQn);
+  DMAC->CHID.reg = DMAC_CHID_ID(dma_channel_);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE); // Wait until the channel is disabled.
+  DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL | DMAC_CHINTENCLR_TERR | DMAC_CHINTENCLR_SUSP;
+  DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR | DMAC_CHINTFLAG_SUSP;
+  NVIC_EnableIRQ(DMAC_IRQn);
+  dmac_channel_owner_[dma_channel_] = NULL;
+  dma_channel_ = -1;
+
+  // Receive through IrqHandler() again. In the kDmaAssisted profile this enables the interrupts of kFullDuplex.
+  sercom_->SPI.INTENSET.reg = SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR;
+  if ((response_ != NULL) || (tx_buffer_.Available() > 0)) {
+    ArmTransmit();
+  }
+}
+
+bool SercomSPISlave::enableTxDMA(uint8_t channel) {
+  if ((sercom_ == NULL) || (channel >= DMAC_CH_NUM) || (profile_ == kReceiveOnly) || (register_map_ != NULL)) {
+    return false; // SercomInit() has not been called, or an argument is invalid
+  }
+  if (((dmac_channel_owner_[channel] != NULL) && (dmac_channel_owner_[channel] != this)) || ((int)channel == dma_channel_)) {
+    return false; // The channel is already used by another slave, or by the DMA receive path
+  }
+  disableTxDMA();
+  DmacEnable(NVIC_GetPriority((IRQn_Type)(SERCOM0_IRQn + sercom_no_)));
+
+  // Stop transmitting through IrqHandler()
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq);
+  sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE;
+  response_ = NULL;
+  response_index_ = 0;
+  tx_buffer_.Clear();
+  tx_segment_count_ = 0;
+  tx_dma_channel_ = channel;
+  dmac_channel_owner_[channel] = this;
+  EnableIrq();
+
+  // Set up the DMAC channel. It is enabled by setResponseSegments().
+  NVIC_DisableIRQ(DMAC_IRQn); // DmacIrqHandler also selects channels through CHID
+  DMAC->CHID.reg = DMAC_CHID_ID(channel);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST; // Reset the channel
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST); // Wait until software reset is complete.
+  DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | // Priority level 0
+                      DMAC_CHCTRLB_TRIGSRC(SERCOM0_DMAC_ID_TX + 2 * sercom_no_) | // Triggered by the Data Register Empty of the SERCOM
+                      DMAC_CHCTRLB_TRIGACT_BEAT; // Transfer one beat per trigger
+  NVIC_EnableIRQ(DMAC_IRQn);
+  return true;
+}
+
+void SercomSPISlave::disableTxDMA() {
+  if (tx_dma_channel_ < 0) {
+    return;
+  }
+  NVIC_DisableIRQ(DMAC_IRQn);
+  DMAC->CHID.reg = DMAC_CHID_ID(tx_dma_channel_);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE); // Wait until the channel is disabled.
+  NVIC_EnableIRQ(DMAC_IRQn);
+  dmac_channel_owner_[tx_dma_channel_] = NULL;
+  tx_dma_channel_ = -1;
+  tx_segment_count_ = 0;
+}
+
+bool SercomSPISlave::setResponseSegments(const Segment* segments, uint8_t count, DmacDescriptor* descriptors) {
+  if ((tx_dma_channel_ < 0) || ((count > 0) && (segments == NULL))) {
+    return false;
+  }
+  uint8_t non_empty = 0; // Segments that take a descriptor. All but the first take one of the application.
+  for (uint8_t i = 0; i < count; i++) {
+    non_empty += (segments[i].length > 0) ? 1 : 0;
+  }
+  if ((non_empty > 1) && ((descriptors == NULL) || (((uintptr_t)descriptors & 0xF) != 0))) {
+    return false; // The DMAC fetches descriptors from 128-bit aligned addresses
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent TransactionEnd from restarting the channel while the descriptors are replaced
+  NVIC_DisableIRQ(DMAC_IRQn);
+  DMAC->CHID.reg = DMAC_CHID_ID(tx_dma_channel_);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE); // Wait until the channel is disabled.
+  NVIC_EnableIRQ(DMAC_IRQn);
+
+  // Link one descriptor per segment
+  uint8_t used = 0;
+  DmacDescriptor* previous = NULL;
+  for (uint8_t i = 0; i < count; i++) {
+    if (segments[i].length == 0) {
+      continue;
+    }
+    DmacDescriptor* descriptor = (used == 0) ? &dmac_descriptors[tx_dma_channel_] : &descriptors[used - 1];
+    descriptor->BTCTRL.reg = DMAC_BTCTRL_VALID | // Descriptor is valid
+                             DMAC_BTCTRL_BLOCKACT_NOACT | // No interrupt at the end of the block
+                             ((char_bytes_ == 2) ? DMAC_BTCTRL_BEATSIZE_HWORD : DMAC_BTCTRL_BEATSIZE_BYTE) | // Transfer one character per beat
+                             DMAC_BTCTRL_SRCINC; // Increment the source address, the destination address is the fixed DATA register
+    descriptor->BTCNT.reg = segments[i].length; // Number of beats
+    descriptor->SRCADDR.reg = (uint32_t)(uintptr_t)segments[i].buffer + segments[i].length * char_bytes_; // The DMAC expects the end address of the block when the address is incremented
+    descriptor->DSTADDR.reg = (uint32_t)(uintptr_t)&sercom_->SPI.DATA.reg;
+    descriptor->DESCADDR.reg = 0; // Last segment, until the next one is linked
+    if (previous != NULL) {
+      previous->DESCADDR.reg = (uint32_t)(uintptr_t)descriptor;
+    }
+    previous = descriptor;
+    used++;
+  }
+  tx_segment_count_ = used;
+  TxDmaRestart();
+  EnableIrq();
+  return true;
+}
+
+size_t SercomSPISlave::dmaPosition() {
+  if (dma_channel_ < 0) {
+    return 0;
+  }
+  /* Explanation:
+  The SAMD21 DMAC has no register holding the remaining block transfer count of an idle channel.
+  Suspending the channel writes its state to the write-back descriptor: BTCNT holds the number of beats (characters) left in the block, DSTADDR the end address of the block.
+  Reference: Atmel-42181G-SAM-D21_Datasheet section 19
+  */
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // DmacIrqHandler also selects channels through CHID
+  uint8_t chid = DMAC->CHID.reg;
+  DMAC->CHID.reg = DMAC_CHID_ID(dma_channel_);
+  DMAC->CHCTRLB.bit.CMD = DMAC_CHCTRLB_CMD_SUSPEND_Val; // Suspend the channel after the ongoing beat
+  // The suspend takes effect within a few cycles. A channel disabled by a transfer error never suspends, so the wait is bounded.
+  uint8_t flags = 0;
+  for (uint16_t i = 0; (i < kDmaSuspendPolls) && !(flags & (DMAC_CHINTFLAG_SUSP | DMAC_CHINTFLAG_TERR)); i++) {
+    flags = DMAC->CHINTFLAG.reg;
+  }
+  if (!(flags & DMAC_CHINTFLAG_SUSP)) {
+    DMAC->CHCTRLB.bit.CMD = DMAC_CHCTRLB_CMD_NOACT_Val; // Withdraw the suspend command
+    DMAC->CHID.reg = chid;
+    __set_PRIMASK(primask);
+    return kDmaPositionError;
+  }
+  uint32_t block_end = dmac_writeback[dma_channel_].DSTADDR.reg;
+  uint16_t remaining = dmac_writeback[dma_channel_].BTCNT.reg;
+  DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_SUSP;
+  DMAC->CHCTRLB.bit.CMD = DMAC_CHCTRLB_CMD_RESUME_Val; // Resume the channel
+  DMAC->CHID.reg = chid;
+  __set_PRIMASK(primask);
+
+  size_t position = block_end - (uint32_t)(uintptr_t)dma_buffer_ - remaining * char_bytes_;
+  return (position == dma_length_) ? 0 : position;
+}
+
+bool SercomSPISlave::enableDmaCrc(DmaCrc polynomial) {
+  if ((dma_channel_ < 0) || (char_bytes_ != 1) || (crc_ != NULL) || ((dmac_crc_owner_ != NULL) && (dmac_crc_owner_ != this))) {
+    return false;
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent TransactionEnd from reading the checksum while the CRC engine is set up
+  DMAC->CTRL.bit.CRCENABLE = 0; // CRCCTRL is enable-protected
+  DMAC->CRCCTRL.reg = DMAC_CRCCTRL_CRCBEATSIZE_BYTE | // The CRC is updated with each byte
+                      ((polynomial == kDmaCrc32) ? DMAC_CRCCTRL_CRCPOLY_CRC32 : DMAC_CRCCTRL_CRCPOLY_CRC16) |
+                      DMAC_CRCCTRL_CRCSRC(0x20 + dma_channel_); // Data transferred by the DMAC channel of the DMA receive path
+  dma_crc_ = polynomial;
+  dmac_crc_owner_ = this;
+  last_crc_valid_ = false;
+  DmaCrcRestart();
+  EnableIrq();
+  return true;
+}
+
+void SercomSPISlave::disableDmaCrc() {
+  if (dmac_crc_owner_ != this) {
+    return;
+  }
+  DMAC->CTRL.bit.CRCENABLE = 0;
+  DMAC->CRCCTRL.reg = 0; // No CRC source
+  dmac_crc_owner_ = NULL;
+  last_crc_valid_ = false;
+}
+
+bool SercomSPISlave::enableTimestamps(SercomPin capture_pin, uint8_t evsys_channel, TimestampStorage* storage, uint8_t gclk_generator, uint16_t latency_bin_ticks) {
+  int extint = SercomSPISlavePinMux::Extint((uint8_t)capture_pin);
+  if ((sercom_ == NULL) || (extint < 0) || (storage == NULL) || (evsys_channel >= EVSYS_CHANNELS) || (gclk_generator >= GCLK_GEN_NUM) || (latency_bin_ticks == 0)) {
+    return false; // SercomInit() has not been called, or an argument is invalid
+  }
+  if ((timestamp_owner_ != NULL) && (timestamp_owner_ != this)) {
+    return false; // TC4 is already used by another slave
+  }
+  for (uint8_t i = 0; i < 4; i++) {
+    if (pins_[i] == (uint8_t)capture_pin) {
+      return false; // Routing the pin to the EIC would disconnect it from the SERCOM
+    }
+  }
+  disableTimestamps();
+
+  // Enable the clocks of the EIC, the Event System, and TC4 and TC5, which form one 32-bit counter
+  PM->APBAMASK.reg |= PM_APBAMASK_EIC;
+  PM->APBCMASK.reg |= PM_APBCMASK_EVSYS | PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_TC4_TC5) | GCLK_CLKCTRL_GEN(gclk_generator) | GCLK_CLKCTRL_CLKEN;
+  while (GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY); // Wait for synchronisation
+  if (!EIC->CTRL.bit.ENABLE) {
+    // The EIC needs a Generic Clock to detect edges. If it is enabled, for instance by attachInterrupt(), it keeps its clock.
+    GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_EIC) | GCLK_CLKCTRL_GEN(gclk_generator) | GCLK_CLKCTRL_CLKEN;
+    while (GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY); // Wait for synchronisation
+  }
+
+  // Route the capture pin to the EIC, peripheral function A
+  uint8_t port = (uint8_t)capture_pin / 32;
+  uint8_t pin = (uint8_t)capture_pin % 32;
+  PORT->Group[port].PINCFG[pin].reg = PORT_PINCFG_PMUXEN | PORT_PINCFG_INEN;
+  if (pin % 2 == 0) {
+    PORT->Group[port].PMUX[pin / 2].bit.PMUXE = 0x0;
+  } else {
+    PORT->Group[port].PMUX[pin / 2].bit.PMUXO = 0x0;
+  }
+
+  // Generate an event on both edges of the external interrupt line, without an interrupt
+  EIC->CTRL.bit.ENABLE = 0; // CONFIG is enable-protected
+  while (EIC->STATUS.bit.SYNCBUSY); // Wait until bit is disabled.
+  uint8_t shift = 4 * (extint % 8);
+  EIC->CONFIG[extint / 8].reg = (EIC->CONFIG[extint / 8].reg & ~(0xFul << shift)) | ((uint32_t)EIC_CONFIG_SENSE0_BOTH_Val << shift); // Both edges, no filter
+  EIC->INTENCLR.reg = 1ul << extint;
+  EIC->EVCTRL.reg |= 1ul << extint;
+  EIC->CTRL.bit.ENABLE = 1;
+  while (EIC->STATUS.bit.SYNCBUSY); // Wait until bit is enabled.
+
+  // Connect the external interrupt line to the event input of TC4. The asynchronous path adds no delay and needs no clock.
+  EVSYS->USER.reg = EVSYS_USER_USER(EVSYS_ID_USER_TC4_EVU) | EVSYS_USER_CHANNEL(evsys_channel + 1); // Channel n is selected with n + 1
+  EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(evsys_channel) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS | EVSYS_CHANNEL_EVGEN(EVSYS_ID_GEN_EIC_EXTINT_0 + extint);
+
+  // Free-running 32-bit counter of TC4 and TC5, which copies COUNT into CC0 on each event
+  TC4->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+  while (TC4->COUNT32.CTRLA.bit.SWRST || TC4->COUNT32.STATUS.bit.SYNCBUSY); // Wait until software reset is complete.
+  TC4->COUNT32.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_PRESCALER_DIV1 | TC_CTRLA_RUNSTDBY;
+  TC4->COUNT32.CTRLC.reg = TC_CTRLC_CPTEN0; // Capture channel 0
+  while (TC4->COUNT32.STATUS.bit.SYNCBUSY); // Wait for synchronisation
+  TC4->COUNT32.EVCTRL.reg = TC_EVCTRL_TCEI | TC_EVCTRL_EVACT_OFF; // The event only triggers the capture
+  TC4->COUNT32.CTRLA.bit.ENABLE = 1;
+  while (TC4->COUNT32.STATUS.bit.SYNCBUSY); // Wait until bit is enabled.
+
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq);
+  timestamp_extint_ = extint;
+  timestamp_evsys_channel_ = evsys_channel;
+  latency_bin_ticks_ = latency_bin_ticks;
+  timestamp_start_valid_ = false;
+  last_timestamps_.valid = false;
+  storage->frames.Clear();
+  Timestamps none = {0, 0, false};
+  for (uint16_t i = 0; i < frame_lengths_.Available(); i++) {
+    storage->frames.Push(none); // The frames queued before have no timestamps, such that the timestamps stay in step with frame_lengths_
+  }
+  for (uint8_t i = 0; i < SERCOM_SPI_SLAVE_LATENCY_BINS; i++) {
+    storage->latency_histogram[i] = 0;
+  }
+  timestamp_storage_ = storage;
+  timestamp_owner_ = this;
+
+  // The Slave Select low capture is read in the Slave Select Low interrupt
+  if (!sercom_->SPI.CTRLB.bit.SSDE) {
+    Reconfigure(0, 0, SERCOM_SPI_CTRLB_SSDE, SERCOM_SPI_CTRLB_SSDE); // Slave Select Low Detect Enable. // page 497
+  }
+  sercom_->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_SSL;
+  sercom_->SPI.INTENSET.reg = SERCOM_SPI_INTENSET_SSL;
+  EnableIrq();
+  return true;
+}
+
+void SercomSPISlave::disableTimestamps() {
+  if (timestamp_owner_ != this) {
+    return;
+  }
+  TC4->COUNT32.CTRLA.bit.ENABLE = 0;
+  while (TC4->COUNT32.STATUS.bit.SYNCBUSY); // Wait until bit is disabled.
+  EVSYS->USER.reg = EVSYS_USER_USER(EVSYS_ID_USER_TC4_EVU) | EVSYS_USER_CHANNEL(0); // Disconnect the event input of TC4
+  EVSYS->CHANNEL.reg = EVSYS_CHANNEL_CHANNEL(timestamp_evsys_channel_); // No event generator
+  EIC->EVCTRL.reg &= ~(1ul << timestamp_extint_);
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  NVIC_DisableIRQ(irq); // Prevent TransactionEnd from writing to the storage after this function returns
+  timestamp_owner_ = NULL;
+  timestamp_storage_ = NULL;
+  timestamp_start_valid_ = false;
+  last_timestamps_.valid = false;
+  EnableIrq();
+  // The Slave Select Low interrupt is left enabled, as enableStandby() may use it
+}
+
+SercomSPISlave::Timestamps SercomSPISlave::lastTransactionTimestamps() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // TransactionEnd writes the timestamps
+  Timestamps timestamps = last_timestamps_;
+  __set_PRIMASK(primask);
+  return timestamps;
+}
+
+SercomSPISlave::Timestamps SercomSPISlave::lastFrameTimestamps() {
+  return frame_timestamps_read_;
+}
+
+SercomSPISlave::Stats SercomSPISlave::getStats() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // IrqHandler updates the statistics
+  Stats stats = stats_;
+  uint64_t isr_cycles = isr_cycles_;
+  __set_PRIMASK(primask);
+  stats.isr_avg_cycles = (stats.isr_count > 0) ? (uint32_t)(isr_cycles / stats.isr_count) : 0;
+  return stats;
+}
+
+void SercomSPISlave::resetStats() {
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // IrqHandler updates the statistics
+  memset(&stats_, 0, sizeof(stats_));
+  isr_cycles_ = 0;
+  TimestampStorage* storage = timestamp_storage_;
+  if (storage != NULL) {
+    for (uint8_t i = 0; i < SERCOM_SPI_SLAVE_LATENCY_BINS; i++) {
+      storage->latency_histogram[i] = 0;
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+void SercomSPISlave::IrqHandler() {
+  /*
+  Reference: Atmel-42181G-SAM-D21_Datasheet section 26.8.6 on page 503
+  */
+  uint32_t start = SysTick->VAL; // Start of the interrupt, see UpdateIsrStats()
+  uint8_t interrupts = sercom_->SPI.INTFLAG.reg & sercom_->SPI.INTENSET.reg; // Read the enabled SPI interrupts
+
+  // Slave Select Low interrupt
+  if (interrupts & SERCOM_SPI_INTFLAG_SSL) {
+    sercom_->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_SSL; // Clear Slave Select Low interrupt
+    transaction_active_ = true; // Keep the core out of standby until Slave Select goes high, see standby()
+    if (timestamp_owner_ == this) {
+      CaptureStart();
+    }
+  }
+
+  // Data Received Complete interrupt: this is where the data is received
+  if (interrupts & SERCOM_SPI_INTFLAG_RXC) {
+    uint16_t data = sercom_->SPI.DATA.reg; // Reading the data register clears the Receive Complete interrupt
+    transaction_active_ = true;
+    if (register_map_ != NULL) {
+      RegisterMapReceive((uint8_t)data);
+    } else if (!resync_) { // After a buffer overflow the rest of the transaction is discarded, see TransactionEnd()
+      bool stored;
+      uint8_t* ping_pong = ping_pong_buffers_[ping_pong_active_];
+      if (ping_pong != NULL) {
+        // Zero-copy receive: the character is written straight into the buffer of the application, see TransactionEnd()
+        uint16_t index = ping_pong_index_;
+        stored = (ping_pong_size_ - index >= char_bytes_);
+        if (stored) {
+          ping_pong[index] = (uint8_t)data;
+          if (char_bytes_ == 2) {
+            ping_pong[index + 1] = (uint8_t)(data >> 8);
+          }
+          ping_pong_index_ = index + char_bytes_;
+        }
+      } else if (frame_pool_ != NULL) {
+        // The first character of a transaction claims a slot, which the application releases with returnFrame(), see TransactionEnd()
+        SercomSPISlaveFramePool* pool = frame_pool_;
+        if (transaction_length_ == 0) {
+          pool_slot_ = pool->Claim();
+        }
+        int slot = pool_slot_;
+        uint16_t index = pool_length_;
+        stored = (slot >= 0) && (pool->SlotSize() - index >= char_bytes_);
+        if (stored) {
+          uint8_t* frame = pool->Slot(slot);
+          frame[index] = (uint8_t)data;
+          if (char_bytes_ == 2) {
+            frame[index + 1] = (uint8_t)(data >> 8);
+          }
+          pool_length_ = index + char_bytes_;
+        }
+      } else if (char_bytes_ == 1) {
+        stored = rx_buffer_.Push((uint8_t)data);
+      } else {
+        stored = (rx_buffer_.Free() >= 2) && (rx_buffer_.Write((const uint8_t*)&data, 2) == 2); // Only store whole characters
+      }
+      if (stored) { // If the receive buffer is full, the character is dropped
+        frame_length_++;
+      } else {
+        stats_.drops++;
+      }
+      const SercomSPISlaveCrc* crc = crc_;
+      if (crc != NULL) {
+        // The last characters may turn out to be the CRC, so the register before each of them is kept, see TransactionEnd()
+        crc_history_[transaction_length_ & 7] = rx_crc_;
+        rx_crc_ = crc->Update(rx_crc_, (uint8_t)data);
+        crc_tail_ = (crc_tail_ << 8) | (uint8_t)data;
+      }
+    }
+    transaction_length_++;
+    stats_.chars_received++;
+  }
+
+  // Data Register Empty interrupt: load the next byte to transmit
+  if (interrupts & SERCOM_SPI_INTFLAG_DRE) {
+    int data = NextTransmitByte();
+    if (data >= 0) {
+      sercom_->SPI.DATA.reg = data; // Writing the data register clears the Data Register Empty interrupt
+      stats_.chars_sent++;
+    } else {
+      sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE; // Nothing to transmit: disable the interrupt to prevent it from firing continuously. write() and setResponse() arm it again.
+    }
+  }
+
+  // Error interrupt: a byte was received while the data register was full.
+  // Served before Transmit Complete, such that TransactionEnd() discards a transaction that overflowed in its last characters, and the next transaction is not discarded instead.
+  if (interrupts & SERCOM_SPI_INTFLAG_ERROR) {
+    bool overflow = sercom_->SPI.STATUS.bit.BUFOVF;
+    sercom_->SPI.STATUS.reg = SERCOM_SPI_STATUS_BUFOVF; // Clear Buffer Overflow
+    sercom_->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_ERROR; // Clear Error interrupt
+    if (overflow) {
+      // A character is lost, so the rest of the transaction is out of sync. Resynchronize when Slave Select goes high.
+      resync_ = true;
+      stats_.overflows++;
+      if (error_callback_ != NULL) {
+        error_callback_(stats_.overflows);
+      }
+    }
+  }
+
+  // Transmit Complete interrupt: in slave mode it is set when Slave Select goes high, at the end of a transaction
+  if (interrupts & SERCOM_SPI_INTFLAG_TXC) {
+    sercom_->SPI.INTFLAG.reg = SERCOM_SPI_INTFLAG_TXC; // Clear Transmit Complete interrupt
+    TransactionEnd();
+  }
+
+  UpdateIsrStats(start);
+}
+
+SercomSPISlave* SercomSPISlave::instance(uint8_t sercom_no) {
+  return (sercom_no < SERCOM_INST_NUM) ? instances_[sercom_no] : NULL;
+}
+
+uint32_t SercomSPISlave::maxSckFrequency(uint32_t isr_cycles, CharSize char_size, uint32_t cpu_frequency, uint32_t gclk_frequency) {
+  uint32_t max_frequency = gclk_frequency / 2; // Limit of the synchronization to the Generic Clock
+  if (isr_cycles > 0) {
+    uint32_t char_bits = (char_size == kCharSize9) ? 9 : 8;
+    uint64_t cpu_limit = (uint64_t)cpu_frequency * char_bits / (isr_cycles + kIsrOverheadCycles); // One character time must be at least one whole interrupt long
+    if (cpu_limit < max_frequency) {
+      max_frequency = (uint32_t)cpu_limit;
+    }
   }
+  return max_frequency;
+}
 
-  // Initialize SERCOM5 registries
-  SercomSPISlave RegInit;
-  RegInit.SercomRegistryInit(SERCOM5);
+void SercomSPISlave::DmacIrqHandler() {
+  uint8_t chid = DMAC->CHID.reg; // Restore the channel selected by interrupted code when done
+  uint32_t pending = DMAC->INTSTATUS.reg; // One bit per channel with a pending interrupt
+  for (uint8_t channel = 0; pending != 0; channel++, pending >>= 1) {
+    if (!(pending & 1)) {
+      continue;
+    }
+    DMAC->CHID.reg = DMAC_CHID_ID(channel);
+    uint8_t flags = DMAC->CHINTFLAG.reg & DMAC->CHINTENSET.reg;
+    DMAC->CHINTFLAG.reg = flags; // Clear the interrupts handled
+    SercomSPISlave* owner = dmac_channel_owner_[channel];
+    if ((owner != NULL) && (flags & DMAC_CHINTFLAG_TCMPL)) {
+      owner->DmaBlockComplete();
+    }
+    if ((owner != NULL) && (flags & DMAC_CHINTFLAG_TERR)) {
+      // A transfer error disables the channel, for instance when the descriptor is invalid. Re-enable it to keep receiving.
+      DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+    }
+  }
+  DMAC->CHID.reg = chid;
+}
+
+void SercomSPISlave::relocateVectorTable() {
+  const uint32_t* vectors = (const uint32_t*)(uintptr_t)SCB->VTOR; // The table in flash, set by the startup code after the bootloader
+  if (vectors == ram_vectors) {
+    return;
+  }
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq(); // Take no interrupt while the table is switched
+  for (size_t i = 0; i < kVectorCount; i++) {
+    ram_vectors[i] = vectors[i];
+  }
+  __DSB(); // The copy must be complete before the core fetches vectors from it
+  SCB->VTOR = (uint32_t)(uintptr_t)ram_vectors & SCB_VTOR_TBLOFF_Msk;
+  __DSB();
+  __set_PRIMASK(primask);
 }
 
 // Private Methods //
 
-void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x) {
-  int sercom_no = -1; // Initialize sercom number to be used in switch case. Initialize to -1 such that it has an invalid value if it is not explicitely defined.
-  if (sercom_x == SERCOM0) {
-    sercom_no = 0;
-  } else if (sercom_x == SERCOM1) {
-    sercom_no = 1;
-  } else if (sercom_x == SERCOM2) {
-    sercom_no = 2;
-  } else if (sercom_x == SERCOM3) {
-    sercom_no = 3;
-  } else if (sercom_x == SERCOM4) {
-    sercom_no = 4;
-  } else if (sercom_x == SERCOM5) {
-    sercom_no = 5;
+bool SercomSPISlave::SercomPadInit(Sercom* sercom_x, uint8_t sercom_no, uint8_t mosi_pin, uint8_t sck_pin, uint8_t ss_pin, uint8_t miso_pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator) {
+  int mosi_pad = SercomSPISlavePinMux::Pad(sercom_no, mosi_pin);
+  int sck_pad = SercomSPISlavePinMux::Pad(sercom_no, sck_pin);
+  int ss_pad = SercomSPISlavePinMux::Pad(sercom_no, ss_pin);
+  int miso_pad = SercomSPISlavePinMux::Pad(sercom_no, miso_pin);
+  if ((mosi_pad < 0) || (sck_pad < 0) || (ss_pad < 0) || (miso_pad < 0)) {
+    return false; // A pin is not connected to a PAD of this SERCOM
+  }
+  if ((irq_priority > 3) || (gclk_generator >= GCLK_GEN_NUM)) {
+    return false; // The Cortex-M0+ has four priority levels, and the SAMD21 nine Generic Clock Generators
+  }
+
+  // Select the Data In and Data Out Pinout matching the PADs
+  int dipo = SercomSPISlavePinMux::Dipo(mosi_pad, sck_pad, ss_pad, miso_pad);
+  int dopo = SercomSPISlavePinMux::Dopo(miso_pad, sck_pad, ss_pad);
+  if ((dipo < 0) || (dopo < 0)) {
+    return false; // The SERCOM cannot route this combination of PADs
+  }
+
+  // Configure the pins
+  const uint8_t pins[4] = {mosi_pin, sck_pin, ss_pin, miso_pin};
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t port = pins[i] / 32; // PORTA or PORTB
+    uint8_t pin = pins[i] % 32;
+    uint8_t function = SercomSPISlavePinMux::Function(sercom_no, pins[i]);
+    PORT->Group[port].PINCFG[pin].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing
+    pins_[i] = pins[i];
+    if (pin % 2 == 0) {
+      PORT->Group[port].PMUX[pin / 2].bit.PMUXE = function; // Select the SERCOM for peripheral use of this pad, even pin
+    } else {
+      PORT->Group[port].PMUX[pin / 2].bit.PMUXO = function; // Select the SERCOM for peripheral use of this pad, odd pin
+    }
   }
 
+  SercomRegistryInit(sercom_x, sercom_no, char_size, profile, irq_priority, gclk_generator, dipo, dopo);
+  return true;
+}
+
+void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x, uint8_t sercom_no, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator, uint8_t dipo, uint8_t dopo) {
+  sercom_ = sercom_x;
+  sercom_no_ = sercom_no;
+  char_bytes_ = (char_size == kCharSize9) ? 2 : 1;
+  profile_ = profile;
+  rx_buffer_.Clear();
+  resetStats();
+  ended_ = false;
+  instances_[sercom_no] = this; // Used by SercomIrqHandler to dispatch the interrupts of this SERCOM
+
   // Disable SPI 1
   sercom_x->SPI.CTRLA.bit.ENABLE = 0; // page 481
   while (sercom_x->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is enabled.
@@ -657,55 +1648,13 @@ void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x) {
   while (sercom_x->SPI.CTRLA.bit.SWRST || sercom_x->SPI.SYNCBUSY.bit.SWRST); // Wait until software reset is complete.
   
   // Setting up Nested Vectored Interrupt Controller (NVIC) and Generic Clock Controller
-  switch (sercom_no) { // specific code for each SERCOM
-    case 0:
-      NVIC_EnableIRQ(SERCOM0_IRQn);
-      NVIC_SetPriority(SERCOM0_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM0_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    case 1:
-      NVIC_EnableIRQ(SERCOM1_IRQn);
-      NVIC_SetPriority(SERCOM1_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM1_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    case 2:
-      NVIC_EnableIRQ(SERCOM2_IRQn);
-      NVIC_SetPriority(SERCOM2_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM2_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    case 3:
-      NVIC_EnableIRQ(SERCOM3_IRQn);
-      NVIC_SetPriority(SERCOM3_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM3_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    case 4:
-      NVIC_EnableIRQ(SERCOM4_IRQn);
-      NVIC_SetPriority(SERCOM4_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM4_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    case 5:
-      NVIC_EnableIRQ(SERCOM5_IRQn);
-      NVIC_SetPriority(SERCOM5_IRQn, 2);
-      GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM5_CORE) | // Generic Clock 0
-                          GCLK_CLKCTRL_GEN_GCLK0 | // Generic Clock Generator 0 is the source
-                          GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
-      break;
-    default:
-      #if ((sercom_no < 0) || (sercom_no > 5))
-        #warning "The SERCOM selected is not supported by this library."
-      #endif
-      break;
-  }
+  // The interrupt numbers and the Generic Clock IDs of SERCOM0 to SERCOM5 are consecutive
+  IRQn_Type irqn = (IRQn_Type)(SERCOM0_IRQn + sercom_no);
+  NVIC_SetPriority(irqn, irq_priority); // Before the interrupt is enabled, such that it is not taken at the reset priority 0
+  NVIC_EnableIRQ(irqn);
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID(GCM_SERCOM0_CORE + sercom_no) | // Generic Clock of the SERCOM core
+                      GCLK_CLKCTRL_GEN(gclk_generator) | // Generic Clock Generator gclk_generator is the source. The generator must be enabled.
+                      GCLK_CLKCTRL_CLKEN; // Enable Generic Clock Generator
 
   while (GCLK->STATUS.reg & GCLK_STATUS_SYNCBUSY); // Wait for synchronisation
 
@@ -714,8 +1663,8 @@ void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x) {
   sercom_x->SPI.CTRLA.bit.CPOL = 0; // SCK is low when idle. The leading edge of a clock cycle is a rising edge, while the trailing edge is a falling edge. // page 492
   sercom_x->SPI.CTRLA.bit.CPHA = 0; // Data is sampled on a leading SCK edge and changed on a trailing SCK edge. // page 492
   sercom_x->SPI.CTRLA.bit.FORM = 0x0; // SPI frame // page 493
-  sercom_x->SPI.CTRLA.bit.DIPO = 0x0; // DATA PAD0 is used as slave input: MOSI // (slave mode) page 493
-  sercom_x->SPI.CTRLA.bit.DOPO = 0x2; // DATA PAD2 is used as slave output: MISO // (slave mode) page 493
+  sercom_x->SPI.CTRLA.bit.DIPO = dipo; // PAD of the slave input: MOSI // (slave mode) page 493
+  sercom_x->SPI.CTRLA.bit.DOPO = dopo; // PADs of the slave output MISO, SCK and SS // (slave mode) page 493
   sercom_x->SPI.CTRLA.bit.MODE = 0x2; // SPI slave operation. // page 494
   sercom_x->SPI.CTRLA.bit.IBON = 0x1; // Immediate Buffer Overflow Notification. STATUS.BUFOVF is asserted immediately upon buffer overflow. // page 494
   sercom_x->SPI.CTRLA.bit.RUNSTDBY = 1; // Wake on Receive Complete interrupt. // page 494
@@ -723,16 +1672,14 @@ void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x) {
   // Set up SPI control B register
   //sercom_x->SPI.CTRLB.bit.RXEN = 0x1; // Enable Receiver // page 496
   sercom_x->SPI.CTRLB.bit.SSDE = 0x1; // Enable Slave Select Low Detect // page 497
-  sercom_x->SPI.CTRLB.bit.CHSIZE = 0; // Character Size 8 bits // page 497
-  //sercom_x->SPI.CTRLB.bit.PLOADEN = 0x1; // Enable Slave Data Preload // page 497
-  //while (sercom_x->SPI.SYNCBUSY.bit.CTRLB); // Wait until receiver is enabled
+  sercom_x->SPI.CTRLB.bit.CHSIZE = char_size; // Character Size 8 or 9 bits // page 497
+  sercom_x->SPI.CTRLB.bit.PLOADEN = 0x1; // Enable Slave Data Preload. Data written to the data register while Slave Select is high is loaded into the shift register, such that the first byte is transmitted with the first SCK edge. // page 497
 
   // Set up SPI interrupts
-  sercom_x->SPI.INTENSET.bit.SSL = 0x1; // Enable Slave Select Low interrupt. // page 501
-  sercom_x->SPI.INTENSET.bit.RXC = 0x1; // Enable Receive Complete interrupt. // page 501
-  sercom_x->SPI.INTENSET.bit.TXC = 0x1; // Enable Transmit Complete interrupt. // page 501
-  sercom_x->SPI.INTENSET.bit.ERROR = 0x1; // Enable Error interrupt. // page 501
-  sercom_x->SPI.INTENSET.bit.DRE = 0x1; // Enable Data Register Empty interrupt. // page 501
+  sercom_x->SPI.INTENSET.reg = ReceiveInterrupts(); // Enable the interrupts of the profile. // page 501
+  if ((response_ != NULL) || (tx_buffer_.Available() > 0)) {
+    ArmTransmit(); // Enable Data Register Empty interrupt, only while characters are queued to transmit. // page 501
+  }
 
   // Init SPI CLK // not used in SPI slave operation // page 481
   //sercom_x->SPI.BAUD.reg = SERCOM_FREQ_REF / (2*4000000u)-1;
@@ -743,3 +1690,455 @@ void SercomSPISlave::SercomRegistryInit(Sercom* sercom_x) {
   sercom_x->SPI.CTRLB.bit.RXEN = 0x1; // Enable Receiver // page 496. This is done here rather than in section "Set up SPI control B register" due to an errate issue.
   while (sercom_x->SPI.SYNCBUSY.bit.CTRLB); // Wait until receiver is enabled.
 }
+
+void SercomSPISlave::DmaBlockComplete() {
+  DmaEvent event = dma_second_half_ ? kDmaFullTransfer : kDmaHalfTransfer;
+  dma_second_half_ = !dma_second_half_;
+  size_t position = dma_second_half_ ? dma_length_ / 2 : 0;
+  CountDmaReceived(position);
+  const SercomSPISlaveCrc* crc = crc_;
+  if ((crc != NULL) && (((position + dma_length_ - dma_crc_position_) % dma_length_) > crc->Bytes())) {
+    DmaCrcUpdate((position + dma_length_ - crc->Bytes()) % dma_length_); // The last bytes may turn out to be the CRC, see TransactionEnd()
+  }
+  if (dma_callback_ != NULL) {
+    dma_callback_(event, position);
+  }
+}
+
+int SercomSPISlave::NextTransmitByte() {
+  const void* response = response_;
+  if (response == NULL) {
+    if (char_bytes_ == 1) {
+      return tx_buffer_.Pop();
+    }
+    uint16_t data;
+    return (tx_buffer_.Read((uint8_t*)&data, 2) == 2) ? data : -1;
+  }
+  uint16_t index = response_index_;
+  if (index >= response_length_) {
+    return -1; // The whole response is loaded
+  }
+  response_index_ = index + 1;
+  return (char_bytes_ == 1) ? ((const uint8_t*)response)[index] : ((const uint16_t*)response)[index];
+}
+
+void SercomSPISlave::SetResponse(const void* buffer, size_t length) {
+  if ((register_map_ != NULL) || (tx_dma_channel_ >= 0)) {
+    return; // The register map and the DMA transmit path use the response path
+  }
+  IRQn_Type irq = (IRQn_Type)(SERCOM0_IRQn + sercom_no_);
+  if (sercom_ != NULL) {
+    NVIC_DisableIRQ(irq); // Prevent IrqHandler from loading a character while the response is replaced
+    sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE;
+  }
+  bool preloaded = (response_ != NULL); // The first characters of the previous response are held in the data and shift registers
+  response_ = ((length > 0) && (profile_ != kReceiveOnly)) ? buffer : NULL;
+  response_length_ = (length > 0xFFFF) ? 0xFFFF : length;
+  response_index_ = 0;
+  if (sercom_ == NULL) {
+    return;
+  }
+  if (preloaded && transaction_active_) {
+    response_flush_ = true; // Discarding them now would disturb the transaction, so TransactionEnd() does
+  } else if (preloaded) {
+    FlushTransmit();
+  }
+  if (response_ != NULL) {
+    ArmTransmit(); // Preload the first character
+  } else if (preloaded && (tx_buffer_.Available() > 0)) {
+    ArmTransmit(); // Preload the characters queued with write()
+  }
+  EnableIrq();
+}
+
+void SercomSPISlave::TransactionEnd() {
+  size_t position = 0;
+  bool position_valid = true;
+  if (dma_channel_ >= 0) {
+    position = dmaPosition();
+    position_valid = (position != kDmaPositionError);
+    if (!position_valid) {
+      position = dma_counted_position_; // The characters since the last DMA event are counted at the next one
+    }
+    CountDmaReceived(position);
+  }
+  stats_.transactions++;
+  if (timestamp_owner_ == this) {
+    CaptureEnd();
+  }
+
+  const SercomSPISlaveCrc* crc = crc_;
+  if ((crc != NULL) && (register_map_ == NULL)) {
+    /* Explanation:
+    The CRC register is updated with every character, as the end of the transaction is not known in advance.
+    At the end, the CRC over the characters before the last crc->Bytes() is taken from the register kept before the first of them,
+    and compared with the last crc->Bytes() characters. With DMA, the last bytes are left out of the update and read from the circular buffer.
+    */
+    uint8_t bytes = crc->Bytes();
+    size_t length = (dma_channel_ >= 0) ? dma_transaction_length_ : transaction_length_;
+    if (length > 0) {
+      last_crc_valid_ = false;
+      if (!resync_ && position_valid && (length > bytes)) {
+        if (dma_channel_ >= 0) {
+          size_t end = (position + dma_length_ - bytes) % dma_length_; // Position of the CRC in the circular buffer
+          DmaCrcUpdate(end);
+          crc_tail_ = 0;
+          for (uint8_t i = 0; i < bytes; i++) {
+            crc_tail_ = (crc_tail_ << 8) | dma_buffer_[(end + i) % dma_length_];
+          }
+          last_crc_ = crc->Finish(rx_crc_);
+        } else {
+          last_crc_ = crc->Finish(crc_history_[(length - bytes) & 7]);
+        }
+        last_crc_valid_ = (last_crc_ == crc->FromBytes(crc_tail_));
+      }
+      if (!last_crc_valid_) {
+        stats_.crc_errors++;
+      }
+    }
+    rx_crc_ = crc->Start();
+    crc_tail_ = 0;
+    dma_crc_position_ = position;
+  } else if ((dmac_crc_owner_ == this) && (dma_channel_ >= 0)) {
+    /* Explanation:
+    The CRC engine of the DMAC updated the checksum with every byte of the transaction, including the CRC in its last bytes.
+    The CRC over a message followed by its own CRC is a constant: 0x0000 for CRC-16/CCITT-FALSE, and 0x2144DF1C for CRC-32.
+    */
+    if (dma_transaction_length_ > 0) {
+      last_crc_ = DMAC->CRCCHKSUM.reg;
+      if (dma_crc_ == kDmaCrc32) {
+        last_crc_valid_ = (dma_transaction_length_ > 4) && (last_crc_ == 0x2144DF1C);
+      } else {
+        last_crc_valid_ = (dma_transaction_length_ > 2) && ((last_crc_ & 0xFFFF) == 0x0000);
+      }
+      if (!last_crc_valid_) {
+        stats_.crc_errors++;
+      }
+    }
+    DmaCrcRestart();
+  }
+  dma_transaction_length_ = 0;
+
+  if ((dma_channel_ >= 0) && (dma_callback_ != NULL)) {
+    dma_callback_(kDmaTransactionEnd, position); // After the CRC check, such that the callback can read its verdict with lastTransactionCrc()
+  }
+
+  if (register_map_ != NULL) {
+    if (register_write_ && (register_address_ != register_first_) && (register_callback_ != NULL)) {
+      register_callback_(register_first_, register_address_ - register_first_);
+    }
+    sercom_->SPI.INTENCLR.reg = SERCOM_SPI_INTENCLR_DRE;
+    if (response_ != NULL) {
+      // The registers preloaded into the data and shift registers beyond the last one clocked would be transmitted at the start of the next read
+      FlushTransmit();
+    }
+    response_ = NULL;
+    response_index_ = 0;
+    register_write_ = false;
+  } else if ((frame_pool_ != NULL) && (transaction_length_ > 0)) {
+    int slot = pool_slot_;
+    if ((slot < 0) || resync_ || (frame_length_ != transaction_length_)) {
+      if (slot >= 0) {
+        frame_pool_->Release(slot); // The frame is incomplete
+      }
+      stats_.frames_dropped++; // No slot was free, or the frame is incomplete
+    } else {
+      uint16_t length = pool_length_;
+      frame_pool_->Commit(slot, length);
+      if (frame_callback_ != NULL) {
+        frame_callback_(length);
+      }
+    }
+    pool_slot_ = -1;
+    pool_length_ = 0;
+  } else if ((ping_pong_buffers_[0] != NULL) && (transaction_length_ > 0)) {
+    if (resync_ || (frame_length_ != transaction_length_) || (ping_pong_state_ != kPingPongFree)) {
+      stats_.frames_dropped++; // The frame is incomplete, or the application holds the other buffer. The next frame overwrites this one.
+    } else {
+      // Swap the buffers: hand the filled one to the application, and write the next frame into the other one
+      uint16_t length = ping_pong_index_;
+      ping_pong_length_ = length;
+      ping_pong_active_ ^= 1;
+      __DMB(); // The length and the swap must be visible before the application sees the frame
+      ping_pong_state_ = kPingPongFull;
+      if (frame_callback_ != NULL) {
+        frame_callback_(length);
+      }
+    }
+    ping_pong_index_ = 0;
+  } else if (framing_ && (transaction_length_ > 0)) {
+    uint16_t length = transaction_length_ * char_bytes_; // Length of the frame in bytes
+    if (resync_ || (frame_length_ != transaction_length_) || (frame_lengths_.Free() == 0)) {
+      rx_buffer_.Rewind(frame_length_ * char_bytes_); // Drop the incomplete frame, or the frame that cannot be queued, by removing the bytes it left in the receive buffer
+      stats_.frames_dropped++;
+    } else {
+      // readFrame() removes the length last, so the CRC queues have room whenever the length queue has
+      frame_crcs_.Push(last_crc_);
+      frame_crc_valid_.Push(((crc != NULL) && last_crc_valid_) ? 1 : 0);
+      if (timestamp_storage_ != NULL) {
+        timestamp_storage_->frames.Push(last_timestamps_);
+      }
+      frame_lengths_.Push(length);
+      if (frame_callback_ != NULL) {
+        frame_callback_(length);
+      }
+    }
+  }
+  frame_length_ = 0;
+
+  if (response_flush_) {
+    // The response was replaced during the transaction: discard the characters preloaded from the previous one
+    response_flush_ = false;
+    FlushTransmit();
+    RestartTransmit();
+  } else if (response_ != NULL) {
+    if ((dma_channel_ < 0) && (response_index_ > transaction_length_)) {
+      FlushTransmit(); // The master clocked fewer bytes than were loaded
+    }
+    response_index_ = 0;
+    ArmTransmit(); // Preload the response for the next transaction
+  } else if (tx_dma_channel_ >= 0) {
+    TxDmaRestart(); // Transmit the segments from the start in the next transaction
+  }
+  transaction_length_ = 0;
+  transaction_active_ = false;
+  transaction_ended_ = true;
+
+  if (resync_) {
+    // Discard the characters of the transaction left in the data register, such that the next transaction starts in sync
+    while (sercom_->SPI.INTFLAG.bit.RXC) {
+      (void)sercom_->SPI.DATA.reg;
+    }
+    resync_ = false;
+    stats_.resyncs++;
+  }
+}
+
+uint8_t SercomSPISlave::ReceiveInterrupts() const {
+  // The Slave Select Low interrupt is not needed: the end of a transaction is detected with Transmit Complete
+  if (profile_ == kDmaAssisted) {
+    return SERCOM_SPI_INTENSET_TXC; // The DMAC serves the Receive Complete trigger
+  }
+  return SERCOM_SPI_INTENSET_RXC | SERCOM_SPI_INTENSET_TXC | SERCOM_SPI_INTENSET_ERROR;
+}
+
+void SercomSPISlave::ArmTransmit() {
+  if ((sercom_ != NULL) && (profile_ != kReceiveOnly) && (tx_dma_channel_ < 0)) {
+    sercom_->SPI.INTENSET.reg = SERCOM_SPI_INTENSET_DRE; // Data Register Empty is disabled again by IrqHandler() when nothing is left to transmit
+  }
+}
+
+void SercomSPISlave::Reconfigure(uint32_t ctrla_mask, uint32_t ctrla, uint32_t ctrlb_mask, uint32_t ctrlb) {
+  // The fields are enable-protected. Disabling the SERCOM keeps the other fields, the pins and the clock, unlike the software reset of SercomInit().
+  bool enabled = sercom_->SPI.CTRLA.bit.ENABLE; // A slave stopped by end() stays stopped until begin()
+  sercom_->SPI.CTRLA.bit.ENABLE = 0; // page 481
+  while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is disabled.
+  if (ctrla_mask != 0) {
+    sercom_->SPI.CTRLA.reg = (sercom_->SPI.CTRLA.reg & ~ctrla_mask) | ctrla;
+  }
+  if (ctrlb_mask != 0) {
+    sercom_->SPI.CTRLB.reg = (sercom_->SPI.CTRLB.reg & ~ctrlb_mask) | ctrlb;
+    while (sercom_->SPI.SYNCBUSY.bit.CTRLB); // Wait until CTRLB is synchronized.
+  }
+  if (enabled) {
+    sercom_->SPI.CTRLA.bit.ENABLE = 1; // page 481
+    while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is enabled.
+    RestartTransmit();
+  }
+}
+
+void SercomSPISlave::EnableIrq() {
+  if (!ended_) {
+    NVIC_EnableIRQ((IRQn_Type)(SERCOM0_IRQn + sercom_no_));
+  }
+}
+
+void SercomSPISlave::FlushTransmit() {
+  if (sercom_->SPI.CTRLA.bit.ENABLE) { // A slave stopped by end() holds no characters
+    sercom_->SPI.CTRLA.bit.ENABLE = 0; // page 481
+    while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is disabled.
+    sercom_->SPI.CTRLA.bit.ENABLE = 1; // page 481
+    while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is enabled.
+  }
+}
+
+void SercomSPISlave::RestartTransmit() {
+  // Disabling the SERCOM discarded the character preloaded for the next transaction
+  if (tx_dma_channel_ >= 0) {
+    TxDmaRestart();
+  } else if (response_ != NULL) {
+    response_index_ = 0;
+    ArmTransmit();
+  } else if (tx_buffer_.Available() > 0) {
+    ArmTransmit();
+  }
+}
+
+void SercomSPISlave::RegisterMapReceive(uint8_t data) {
+  if (transaction_length_ == 0) {
+    // Command: bit 7 selects a read or a write, bits 6 to 0 the address
+    uint8_t address = data & 0x7F;
+    register_first_ = address;
+    register_address_ = address;
+    register_write_ = !(data & 0x80);
+    if (!register_write_ && (address < register_size_)) {
+      // Transmit the registers straight from the memory of the application, through the response path
+      response_ = (const void*)(register_map_ + address);
+      response_length_ = register_size_ - address;
+      response_index_ = 0;
+      sercom_->SPI.DATA.reg = NextTransmitByte(); // The data register is empty: TransactionEnd() discarded the registers left by the previous read
+      stats_.chars_sent++;
+      ArmTransmit(); // Load the next registers
+    }
+  } else if (register_write_ && (register_address_ < register_size_)) {
+    if (register_write_mask_ != NULL) {
+      uint8_t mask = register_write_mask_[register_address_];
+      register_map_[register_address_] = (register_map_[register_address_] & ~mask) | (data & mask);
+    }
+    register_address_++;
+  }
+}
+
+void SercomSPISlave::UpdateIsrStats(uint32_t start) {
+  /* Explanation:
+  SysTick counts down from LOAD to 0 at the CPU clock, and is reloaded every millisecond by the Arduino core.
+  If it is reloaded during the interrupt, the value at the end is larger than at the start.
+  Reference: ARM Cortex-M0+ Devices Generic User Guide section 4.4
+  */
+  uint32_t end = SysTick->VAL;
+  uint32_t cycles = (start >= end) ? (start - end) : (start + SysTick->LOAD + 1 - end);
+  stats_.isr_count++;
+  isr_cycles_ += cycles;
+  if (cycles > stats_.isr_max_cycles) {
+    stats_.isr_max_cycles = cycles;
+  }
+}
+
+void SercomSPISlave::CountDmaReceived(size_t position) {
+  // The DMA events occur at least every half buffer, so the DMAC cannot have written more than a whole buffer since the last count
+  size_t received = (position + dma_length_ - dma_counted_position_) % dma_length_;
+  stats_.chars_received += received / char_bytes_;
+  dma_transaction_length_ += received;
+  dma_counted_position_ = position;
+}
+
+void SercomSPISlave::TxDmaRestart() {
+  NVIC_DisableIRQ(DMAC_IRQn); // DmacIrqHandler also selects channels through CHID
+  uint8_t chid = DMAC->CHID.reg;
+  DMAC->CHID.reg = DMAC_CHID_ID(tx_dma_channel_);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE); // Wait until the channel is disabled.
+
+  // A slave stopped by end() is left stopped. begin() restarts the channel when it enables the SERCOM again.
+  if (!ended_) {
+    // Disable and enable the SERCOM to discard the characters left in the data and shift registers, if the master clocked fewer characters than the segments hold
+    sercom_->SPI.CTRLA.bit.ENABLE = 0; // page 481
+    while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is disabled.
+    sercom_->SPI.CTRLA.bit.ENABLE = 1; // page 481
+    while (sercom_->SPI.SYNCBUSY.bit.ENABLE); // Wait until bit is enabled.
+
+    if (tx_segment_count_ > 0) {
+      // Enabling the channel fetches the first descriptor again. Data Register Empty triggers the first beat, which is preloaded while Slave Select is high.
+      DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_RUNSTDBY | DMAC_CHCTRLA_ENABLE;
+    }
+  }
+  DMAC->CHID.reg = chid;
+  NVIC_EnableIRQ(DMAC_IRQn);
+}
+
+void SercomSPISlave::CaptureStart() {
+  /* Explanation:
+  The EIC, the Event System and the capture of TC4 copy the counter into CC0 within a few cycles of the Slave Select edge, independent of the CPU.
+  The latency is the difference between the counter at this point and the capture. It includes the synchronisation of the counter read, which is constant.
+  A capture while MC0 is still set sets ERR: an edge was missed, so the timestamps of the transaction are not valid.
+  */
+  uint32_t now = Tc4Read(kTcCountAddress);
+  uint8_t flags = TC4->COUNT32.INTFLAG.reg;
+  timestamp_start_valid_ = (flags & TC_INTFLAG_MC0) && !(flags & TC_INTFLAG_ERR);
+  if (timestamp_start_valid_) {
+    timestamp_start_ = Tc4Read(kTcCc0Address);
+    uint32_t latency = now - timestamp_start_;
+    uint32_t bin = latency / latency_bin_ticks_;
+    timestamp_storage_->latency_histogram[(bin < SERCOM_SPI_SLAVE_LATENCY_BINS) ? bin : SERCOM_SPI_SLAVE_LATENCY_BINS - 1]++;
+    if ((stats_.latency_count == 0) || (latency < stats_.latency_min)) {
+      stats_.latency_min = latency;
+    }
+    if (latency > stats_.latency_max) {
+      stats_.latency_max = latency;
+    }
+    stats_.latency_count++;
+  }
+  TC4->COUNT32.INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_ERR;
+}
+
+void SercomSPISlave::CaptureEnd() {
+  uint8_t flags = TC4->COUNT32.INTFLAG.reg;
+  last_timestamps_.valid = timestamp_start_valid_ && (flags & TC_INTFLAG_MC0) && !(flags & TC_INTFLAG_ERR);
+  last_timestamps_.start = timestamp_start_;
+  last_timestamps_.end = last_timestamps_.valid ? Tc4Read(kTcCc0Address) : 0;
+  TC4->COUNT32.INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_ERR;
+  timestamp_start_valid_ = false;
+}
+
+void SercomSPISlave::DmaCrcRestart() {
+  DMAC->CTRL.bit.CRCENABLE = 0;
+  DMAC->CRCCHKSUM.reg = (dma_crc_ == kDmaCrc32) ? 0xFFFFFFFF : 0xFFFF; // Initial value
+  DMAC->CTRL.bit.CRCENABLE = 1;
+}
+
+void SercomSPISlave::DmaCrcUpdate(size_t end) {
+  const SercomSPISlaveCrc* crc = crc_;
+  size_t start = dma_crc_position_;
+  if (end < start) {
+    rx_crc_ = crc->Update(rx_crc_, dma_buffer_ + start, dma_length_ - start); // Up to the end of the circular buffer
+    start = 0;
+  }
+  rx_crc_ = crc->Update(rx_crc_, dma_buffer_ + start, end - start);
+  dma_crc_position_ = end;
+}
+
+// Interrupt handlers //
+
+/*
+The handlers are weak, such that a handler defined by the sketch, the board variant or another library takes precedence.
+For instance, the variant of the Arduino Zero defines SERCOM0_Handler and SERCOM5_Handler for Serial1 and Serial.
+*/
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM_HANDLERS
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM0_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM0_Handler() {
+  SercomSPISlave::SercomIrqHandler(0);
+}
+#endif
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM1_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM1_Handler() {
+  SercomSPISlave::SercomIrqHandler(1);
+}
+#endif
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM2_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM2_Handler() {
+  SercomSPISlave::SercomIrqHandler(2);
+}
+#endif
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM3_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM3_Handler() {
+  SercomSPISlave::SercomIrqHandler(3);
+}
+#endif
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM4_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM4_Handler() {
+  SercomSPISlave::SercomIrqHandler(4);
+}
+#endif
+#ifndef SERCOM_SPI_SLAVE_NO_SERCOM5_HANDLER
+__attribute__((weak)) SERCOM_SPI_SLAVE_RAM_CODE void SERCOM5_Handler() {
+  SercomSPISlave::SercomIrqHandler(5);
+}
+#endif
+#endif
+
+
+#ifndef SERCOM_SPI_SLAVE_NO_DMAC_HANDLER
+__attribute__((weak)) void DMAC_Handler() {
+  SercomSPISlave::DmacIrqHandler();
+}
+#endif
@@ -24,13 +24,1411 @@
 
 #include <Arduino.h>
 
-class Sercom0SPISlave {
+// Size of the receive buffer of each slave in bytes. Must be a power of two. Define it in the build flags to change it, as the library is compiled separately from the sketch.
+#ifndef SERCOM_SPI_SLAVE_RX_BUFFER_SIZE
+#define SERCOM_SPI_SLAVE_RX_BUFFER_SIZE 256
+#endif
+
+// Size of the transmit buffer of each slave in bytes. Must be a power of two. Define it in the build flags to change it.
+#ifndef SERCOM_SPI_SLAVE_TX_BUFFER_SIZE
+#define SERCOM_SPI_SLAVE_TX_BUFFER_SIZE 64
+#endif
+
+// Number of complete frames that can be queued for readFrame(). Must be a power of two. Define it in the build flags to change it.
+#ifndef SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE
+#define SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE 16
+#endif
+
+// Number of bins of the histogram of the Slave Select latency, see SercomSPISlave::TimestampStorage. Define it in the build flags to change it.
+#ifndef SERCOM_SPI_SLAVE_LATENCY_BINS
+#define SERCOM_SPI_SLAVE_LATENCY_BINS 16
+#endif
+
+// Define SERCOM_SPI_SLAVE_RAMFUNC in the build flags to run the per-character interrupt path from RAM, without the wait states of the flash. See SercomSPISlave::relocateVectorTable().
+#ifdef SERCOM_SPI_SLAVE_RAMFUNC
+#define SERCOM_SPI_SLAVE_RAM_CODE __attribute__((section(".ramfunc"), long_call)) // Copied to RAM by the startup code. long_call reaches RAM from functions in flash.
+#define SERCOM_SPI_SLAVE_INLINE inline __attribute__((always_inline)) // Inlined into the functions in RAM, instead of called in flash
+#else
+#define SERCOM_SPI_SLAVE_RAM_CODE
+#define SERCOM_SPI_SLAVE_INLINE inline
+#endif
+
+/**
+ * @brief Lock-free single-producer, single-consumer ring buffer.
+ * 
+ * One side, usually the SERCOM interrupt handler, only calls Push(), Write() and Rewind(). The other side, usually the main loop, only calls Pop(), Peek(), Read(), Skip() and Clear().
+ * The head is only written by the producer and the tail only by the consumer, so neither side has to disable interrupts.
+ * The indices run freely and are masked when the buffer is accessed, such that all kSize elements can be used.
+ * 
+ * @tparam kSize Number of elements. Must be a power of two, and at most 32768.
+ * @tparam T Type of the elements.
+ */
+template <uint16_t kSize, typename T = uint8_t>
+class SercomSPISlaveRingBuffer {
+ public:
+  // Constructors //
+  SercomSPISlaveRingBuffer() : head_(0), tail_(0) {}
+
+  // Public methods //
+  SERCOM_SPI_SLAVE_INLINE uint16_t Available() const { return (uint16_t)(head_ - tail_); } // Number of elements in the buffer
+  SERCOM_SPI_SLAVE_INLINE uint16_t Free() const { return kSize - Available(); } // Number of elements that can be pushed
+
+  SERCOM_SPI_SLAVE_INLINE bool Push(T data) {
+    uint16_t head = head_;
+    if ((uint16_t)(head - tail_) == kSize) {
+      return false; // Buffer full, the element is dropped
+    }
+    buffer_[head & kMask] = data;
+    __DMB(); // The element must be stored before the consumer sees the new head
+    head_ = head + 1;
+    return true;
+  }
+
+  SERCOM_SPI_SLAVE_INLINE uint16_t Write(const T* data, uint16_t length) {
+    uint16_t head = head_;
+    uint16_t count = kSize - (uint16_t)(head - tail_);
+    if (length < count) {
+      count = length;
+    }
+    uint16_t index = head & kMask;
+    uint16_t first = kSize - index; // Elements until the end of the buffer
+    if (first > count) {
+      first = count;
+    }
+    memcpy(&buffer_[index], data, first * sizeof(T));
+    memcpy(&buffer_[0], data + first, (count - first) * sizeof(T)); // Elements wrapped around to the start of the buffer
+    __DMB(); // The elements must be stored before the consumer sees the new head
+    head_ = head + count;
+    return count;
+  }
+
+  // Remove the last count elements pushed. Only valid if the consumer has not read them.
+  void Rewind(uint16_t count) { head_ = head_ - count; }
+
+  SERCOM_SPI_SLAVE_INLINE int Pop() {
+    uint16_t tail = tail_;
+    if (head_ == tail) {
+      return -1; // Buffer empty
+    }
+    T data = buffer_[tail & kMask];
+    __DMB(); // The element must be loaded before the producer may overwrite it
+    tail_ = tail + 1;
+    return data;
+  }
+
+  int Peek(uint16_t offset = 0) const {
+    uint16_t tail = tail_;
+    return ((uint16_t)(head_ - tail) <= offset) ? -1 : buffer_[(tail + offset) & kMask];
+  }
+
+  SERCOM_SPI_SLAVE_INLINE uint16_t Read(T* data, uint16_t length) {
+    uint16_t tail = tail_;
+    uint16_t count = (uint16_t)(head_ - tail);
+    if (length < count) {
+      count = length;
+    }
+    uint16_t index = tail & kMask;
+    uint16_t first = kSize - index; // Elements until the end of the buffer
+    if (first > count) {
+      first = count;
+    }
+    memcpy(data, &buffer_[index], first * sizeof(T));
+    memcpy(data + first, &buffer_[0], (count - first) * sizeof(T)); // Elements wrapped around to the start of the buffer
+    __DMB(); // The elements must be copied before the producer may overwrite them
+    tail_ = tail + count;
+    return count;
+  }
+
+  // Remove up to count elements without reading them
+  void Skip(uint16_t count) {
+    uint16_t available = Available();
+    tail_ = tail_ + ((count < available) ? count : available);
+  }
+
+  void Clear() { tail_ = head_; }
+
+ private:
+  static_assert((kSize != 0) && ((kSize & (kSize - 1)) == 0) && (kSize <= 32768), "The size of SercomSPISlaveRingBuffer must be a power of two, and at most 32768");
+  static const uint16_t kMask = kSize - 1;
+
+  T buffer_[kSize];
+  volatile uint16_t head_; // Index of the next element to push, written by the producer only
+  volatile uint16_t tail_; // Index of the next element to pop, written by the consumer only
+};
+
+/**
+ * @brief Table-driven CRC of 8, 16 or 32 bits with a configurable polynomial.
+ * 
+ * The parameters follow the usual CRC catalogue model: width, polynomial, initial value, reflected input and output, and final XOR value. Examples:
+ * CRC-8: SercomSPISlaveCrc(8, 0x07, 0x00, false, 0x00)
+ * CRC-16/CCITT-FALSE: SercomSPISlaveCrc(16, 0x1021, 0xFFFF, false, 0x0000)
+ * CRC-32: SercomSPISlaveCrc(32, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF)
+ * The constructor computes a table of 256 entries, such that each byte takes one table lookup. An instance holds no state of a computation, so it can be shared by several slaves.
+ * On the SPI bus the CRC follows the data, most significant byte first for a non-reflected CRC and least significant byte first for a reflected CRC.
+ */
+class SercomSPISlaveCrc {
+ public:
+  // Constructors //
+  SercomSPISlaveCrc(uint8_t width, uint32_t polynomial, uint32_t init, bool reflected, uint32_t xor_out);
+
+  // Public methods //
+  uint8_t Width() const { return width_; } // Width of the CRC in bits: 8, 16 or 32
+  uint8_t Bytes() const { return width_ / 8; } // Width of the CRC in bytes
+  uint32_t Start() const { return start_; } // Value of the CRC register before the first byte
+
+  // Update the CRC register with one byte
+  SERCOM_SPI_SLAVE_INLINE uint32_t Update(uint32_t crc, uint8_t data) const {
+    return reflected_ ? (table_[(uint8_t)(crc ^ data)] ^ (crc >> 8)) : (table_[(uint8_t)((crc >> 24) ^ data)] ^ (crc << 8));
+  }
+
+  uint32_t Update(uint32_t crc, const volatile uint8_t* data, size_t length) const; // Update the CRC register with a block of bytes
+  uint32_t Finish(uint32_t crc) const; // CRC of the bytes given to Update(), from the CRC register
+  uint32_t Compute(const uint8_t* data, size_t length) const { return Finish(Update(Start(), data, length)); } // CRC of a block of bytes
+  uint32_t FromBytes(uint32_t bytes) const; // CRC transmitted in the last Bytes() bytes of bytes, the first byte transmitted the most significant
+  void ToBytes(uint32_t crc, uint8_t* bytes) const; // Write the Bytes() bytes of the CRC in the order they are transmitted
+  size_t Append(uint8_t* buffer, size_t length) const; // Write the CRC of the first length bytes after them. The buffer must hold length + Bytes() bytes. Returns length + Bytes().
+
+ private:
+  // Private variables //
+  uint32_t table_[256]; // Register update for each value of the byte combined with the register
+  uint32_t start_; // Initial value, aligned as the register
+  uint32_t xor_out_; // Final XOR value
+  uint8_t width_; // Width of the CRC in bits
+  bool reflected_; // true: the register is right aligned and shifts right; false: the register is left aligned and shifts left
+};
+
+/**
+ * @brief Pool of fixed-size frame slots, without heap allocation.
+ * 
+ * Each slot holds one frame. A slot is free, claimed by the receive path while a frame is written into it, ready, or lent to the application until it is released.
+ * The free slots and the ready slots are kept in two linked lists through one array of indices, so Claim(), Commit(), Take(), Release() and Return() run in constant time.
+ * They briefly disable interrupts, as the Cortex-M0+ has no exclusive load and store, such that they can be called from interrupts and from the main loop.
+ * Declare a pool with SercomSPISlaveFramePoolT, which holds the slots, and pass it to SercomSPISlave::enableFramePool().
+ */
+class SercomSPISlaveFramePool {
+ public:
+  // Public methods //
+  uint16_t SlotSize() const { return slot_size_; } // Size of each slot in bytes
+  uint8_t SlotCount() const { return slot_count_; } // Number of slots
+  uint8_t* Slot(uint8_t slot) const { return storage_ + (size_t)slot * slot_size_; } // Memory of a slot
+  int SlotOf(const uint8_t* buffer) const; // Slot starting at buffer, -1 if buffer is not the start of a slot
+
+  int Claim(); // Take a free slot to write a frame into, -1 if all slots are used
+  void Commit(uint8_t slot, uint16_t length); // Append a claimed slot holding a frame of length bytes to the ready frames
+  int Take(uint16_t* length); // Lend the oldest ready frame, -1 if there is none
+  bool Release(uint8_t slot) { return FreeSlot(slot, kClaimed); } // Return a claimed slot to the free slots, for a frame that is dropped. false if the slot is not claimed.
+  bool Return(uint8_t slot) { return FreeSlot(slot, kLent); } // Return a lent slot to the free slots. false if the slot is not lent, such as a slot returned twice.
+  void Clear(); // Free all slots. Only call it while no slave uses the pool.
+
+  uint8_t Available() const { return ready_count_; } // Number of ready frames
+  uint8_t Free() const { return slot_count_ - used_count_; } // Number of free slots
+  uint8_t HighWaterMark() const { return high_water_mark_; } // Highest number of slots used at the same time since Clear() or ResetHighWaterMark()
+  void ResetHighWaterMark() { high_water_mark_ = used_count_; }
+
+ protected:
+  // Constructors //
+  SercomSPISlaveFramePool(uint8_t* storage, uint8_t* next, uint16_t* lengths, uint16_t slot_size, uint8_t slot_count);
+
+ private:
+  // Private methods //
+  bool FreeSlot(uint8_t slot, uint8_t state); // Return a slot to the free slots if it is in state kClaimed or kLent
+
+  // Private variables //
+  static const uint8_t kNone = 0xFF; // End of a list
+  static const uint8_t kClaimed = 0xFE; // next_ of a slot claimed by the receive path
+  static const uint8_t kLent = 0xFD; // next_ of a slot lent to the application
+
+  uint8_t* storage_; // Memory of the slots
+  uint8_t* next_; // Next slot in the list of each slot, or kClaimed or kLent
+  uint16_t* lengths_; // Length of the frame of each ready or lent slot
+  uint16_t slot_size_;
+  uint8_t slot_count_;
+  uint8_t free_head_; // First free slot
+  uint8_t ready_head_; // Oldest ready slot
+  uint8_t ready_tail_; // Newest ready slot
+  volatile uint8_t ready_count_;
+  volatile uint8_t used_count_; // Number of slots claimed, ready or lent
+  volatile uint8_t high_water_mark_;
+};
+
+/**
+ * @brief Pool of kSlotCount slots of kSlotSize bytes, see SercomSPISlaveFramePool.
+ * 
+ * @tparam kSlotCount Number of slots: 1 to 252.
+ * @tparam kSlotSize Size of each slot in bytes, two per character in 9-bit mode.
+ */
+template <uint8_t kSlotCount, uint16_t kSlotSize>
+class SercomSPISlaveFramePoolT : public SercomSPISlaveFramePool {
+ public:
+  // Constructors //
+  SercomSPISlaveFramePoolT() : SercomSPISlaveFramePool(storage_, next_, lengths_, kSlotSize, kSlotCount) {}
+
+ private:
+  static_assert((kSlotCount >= 1) && (kSlotCount <= 252), "SercomSPISlaveFramePoolT holds 1 to 252 slots.");
+  static_assert(kSlotSize >= 1, "The slots of SercomSPISlaveFramePoolT must hold at least one byte.");
+
+  // Private variables //
+  __attribute__((__aligned__(4))) uint8_t storage_[(size_t)kSlotCount * kSlotSize];
+  uint8_t next_[kSlotCount];
+  uint16_t lengths_[kSlotCount];
+};
+
+// Pins of PORTA and PORTB. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+enum class SercomPin : uint8_t {
+  PA00 = 0, PA01 = 1, PA02 = 2, PA03 = 3, PA04 = 4, PA05 = 5, PA06 = 6, PA07 = 7,
+  PA08 = 8, PA09 = 9, PA10 = 10, PA11 = 11, PA12 = 12, PA13 = 13, PA14 = 14, PA15 = 15,
+  PA16 = 16, PA17 = 17, PA18 = 18, PA19 = 19, PA20 = 20, PA21 = 21, PA22 = 22, PA23 = 23,
+  PA24 = 24, PA25 = 25, PA26 = 26, PA27 = 27, PA28 = 28, PA29 = 29, PA30 = 30, PA31 = 31,
+  PB00 = 32, PB01 = 33, PB02 = 34, PB03 = 35, PB04 = 36, PB05 = 37, PB06 = 38, PB07 = 39,
+  PB08 = 40, PB09 = 41, PB10 = 42, PB11 = 43, PB12 = 44, PB13 = 45, PB14 = 46, PB15 = 47,
+  PB16 = 48, PB17 = 49, PB18 = 50, PB19 = 51, PB20 = 52, PB21 = 53, PB22 = 54, PB23 = 55,
+  PB24 = 56, PB25 = 57, PB26 = 58, PB27 = 59, PB28 = 60, PB29 = 61, PB30 = 62, PB31 = 63,
+};
+
+/* Explanation:
+The selection of peripheral function A to H is done by writing to the Peripheral Multiplexing Odd and Even bits in the Peripheral Multiplexing register (PMUXn.PMUXE/O) in the PORT.
+Each SERCOM PAD is available on several pins, either as peripheral function C (SERCOM) or D (SERCOM-ALT).
+Reference: Atmel-42181G-SAM-D21_Datasheet section 6.1 on page 21
+
+In general:
+Px(2n+0/1) corresponds to Portx, PMUX[n], 0=Even=PMUXE/1=Odd=PMUXO
+
+Example:
+PA07 corresponds to PortA, PMUX[3], PMUXO
+*/
+struct SercomPinMux {
+  uint8_t pin; // Number of the pin in PORTA (0 to 31) or PORTB (32 to 63)
+  uint8_t sercom_no; // SERCOM connected to the pin
+  uint8_t pad; // PAD of the SERCOM connected to the pin
+  uint8_t function; // Peripheral function: 0x2 selects function C: SERCOM, 0x3 selects function D: SERCOM-ALT
+};
+
+/* Explanation:
+In slave mode, the Data Out Pinout (DOPO) selects the PADs of MISO, SCK and SS together. Only these combinations exist:
+DOPO  MISO  SCK   SS
+0x0   PAD0  PAD1  PAD2
+0x1   PAD2  PAD3  PAD1
+0x2   PAD3  PAD1  PAD2
+0x3   PAD0  PAD3  PAD1
+The Data In Pinout (DIPO) is the PAD of MOSI, which must not be used by MISO, SCK or SS.
+Reference: Atmel-42181G-SAM-D21_Datasheet section 26.8.1 on page 493
+*/
+/**
+ * @brief Table of the pins connected to a PAD of a SERCOM, with lookups that can be evaluated at compile time.
+ * 
+ * SercomSPISlaveT resolves its pins, PADs, DIPO and DOPO during compilation with these lookups, and SercomPadInit() uses the same table at run time.
+ */
+class SercomSPISlavePinMux {
+ public:
+  // Constants //
+  static constexpr SercomPinMux kTable[] = {
+    // pin  SERCOM PAD function
+    {0,     1,     0,  0x3}, // PA00
+    {1,     1,     1,  0x3}, // PA01
+    {4,     0,     0,  0x3}, // PA04
+    {5,     0,     1,  0x3}, // PA05
+    {6,     0,     2,  0x3}, // PA06
+    {7,     0,     3,  0x3}, // PA07
+    {8,     0,     0,  0x2}, // PA08
+    {8,     2,     0,  0x3}, // PA08
+    {9,     0,     1,  0x2}, // PA09
+    {9,     2,     1,  0x3}, // PA09
+    {10,    0,     2,  0x2}, // PA10
+    {10,    2,     2,  0x3}, // PA10
+    {11,    0,     3,  0x2}, // PA11
+    {11,    2,     3,  0x3}, // PA11
+    {12,    2,     0,  0x2}, // PA12
+    {12,    4,     0,  0x3}, // PA12
+    {13,    2,     1,  0x2}, // PA13
+    {13,    4,     1,  0x3}, // PA13
+    {14,    2,     2,  0x2}, // PA14
+    {14,    4,     2,  0x3}, // PA14
+    {15,    2,     3,  0x2}, // PA15
+    {15,    4,     3,  0x3}, // PA15
+    {16,    1,     0,  0x2}, // PA16
+    {16,    3,     0,  0x3}, // PA16
+    {17,    1,     1,  0x2}, // PA17
+    {17,    3,     1,  0x3}, // PA17
+    {18,    1,     2,  0x2}, // PA18
+    {18,    3,     2,  0x3}, // PA18
+    {19,    1,     3,  0x2}, // PA19
+    {19,    3,     3,  0x3}, // PA19
+    {20,    5,     2,  0x2}, // PA20
+    {20,    3,     2,  0x3}, // PA20
+    {21,    5,     3,  0x2}, // PA21
+    {21,    3,     3,  0x3}, // PA21
+    {22,    3,     0,  0x2}, // PA22
+    {22,    5,     0,  0x3}, // PA22
+    {23,    3,     1,  0x2}, // PA23
+    {23,    5,     1,  0x3}, // PA23
+    {24,    3,     2,  0x2}, // PA24
+    {24,    5,     2,  0x3}, // PA24
+    {25,    3,     3,  0x2}, // PA25
+    {25,    5,     3,  0x3}, // PA25
+    {30,    1,     2,  0x3}, // PA30
+    {31,    1,     3,  0x3}, // PA31
+    {32,    5,     2,  0x3}, // PB00
+    {33,    5,     3,  0x3}, // PB01
+    {34,    5,     0,  0x3}, // PB02
+    {35,    5,     1,  0x3}, // PB03
+    {40,    4,     0,  0x3}, // PB08
+    {41,    4,     1,  0x3}, // PB09
+    {42,    4,     2,  0x3}, // PB10
+    {43,    4,     3,  0x3}, // PB11
+    {44,    4,     0,  0x2}, // PB12
+    {45,    4,     1,  0x2}, // PB13
+    {46,    4,     2,  0x2}, // PB14
+    {47,    4,     3,  0x2}, // PB15
+    {48,    5,     0,  0x2}, // PB16
+    {49,    5,     1,  0x2}, // PB17
+    {54,    5,     2,  0x3}, // PB22
+    {55,    5,     3,  0x3}, // PB23
+    {62,    5,     0,  0x3}, // PB30
+    {63,    5,     1,  0x3}, // PB31
+  };
+  static constexpr uint8_t kTableSize = sizeof(kTable) / sizeof(kTable[0]);
+
+  // Public methods //
+  // Index of the entry of a pin in kTable for a SERCOM, kTableSize if the pin is not connected to the SERCOM
+  static constexpr uint8_t Find(uint8_t sercom_no, uint8_t pin, uint8_t i = 0) {
+    return (i >= kTableSize) ? kTableSize
+         : ((kTable[i].pin == pin) && (kTable[i].sercom_no == sercom_no)) ? i
+         : Find(sercom_no, pin, i + 1);
+  }
+
+  // PAD of the SERCOM connected to a pin, -1 if the pin is not connected to the SERCOM
+  static constexpr int Pad(uint8_t sercom_no, uint8_t pin) {
+    return (Find(sercom_no, pin) < kTableSize) ? kTable[Find(sercom_no, pin)].pad : -1;
+  }
+
+  // Peripheral function connecting a pin to the SERCOM, 0 if the pin is not connected to the SERCOM
+  static constexpr uint8_t Function(uint8_t sercom_no, uint8_t pin) {
+    return (Find(sercom_no, pin) < kTableSize) ? kTable[Find(sercom_no, pin)].function : 0;
+  }
+
+  // Data Out Pinout routing MISO, SCK and SS to these PADs, -1 if the SERCOM cannot route them
+  static constexpr int Dopo(int miso_pad, int sck_pad, int ss_pad) {
+    return ((miso_pad == 0) && (sck_pad == 1) && (ss_pad == 2)) ? 0x0
+         : ((miso_pad == 2) && (sck_pad == 3) && (ss_pad == 1)) ? 0x1
+         : ((miso_pad == 3) && (sck_pad == 1) && (ss_pad == 2)) ? 0x2
+         : ((miso_pad == 0) && (sck_pad == 3) && (ss_pad == 1)) ? 0x3
+         : -1;
+  }
+
+  // External interrupt line of the EIC on a pin, -1 for PA08, which is connected to the NMI. Reference: Atmel-42181G-SAM-D21_Datasheet section 7.1
+  static constexpr int Extint(uint8_t pin) {
+    return (pin == 8) ? -1
+         : (pin == 24) ? 12
+         : (pin == 25) ? 13
+         : (pin == 27) ? 15
+         : (pin == 28) ? 8
+         : (pin == 30) ? 10
+         : (pin == 31) ? 11
+         : (pin < 64) ? pin % 16
+         : -1;
+  }
+
+  // Data In Pinout: the PAD of MOSI, -1 if MOSI is not connected or shares its PAD with MISO, SCK or SS
+  static constexpr int Dipo(int mosi_pad, int sck_pad, int ss_pad, int miso_pad) {
+    return ((mosi_pad < 0) || (mosi_pad == sck_pad) || (mosi_pad == ss_pad) || (mosi_pad == miso_pad)) ? -1 : mosi_pad;
+  }
+};
+
+/**
+ * @brief SPI slave on a SERCOM, with the Arduino Stream interface.
+ * 
+ * available(), read(), peek(), write() and availableForWrite() implement Stream and Print, such that parsers written for Serial also work on the SPI slave.
+ * readBytes() and write(buffer, length) copy in bulk from and to the ring buffers, rather than one virtual call per byte.
+ */
+class SercomSPISlave : public Stream {
+ public:
+  // Types //
+  /**
+   * @brief Character size, the number of bits of each SPI character.
+   * 
+   * In 9-bit mode every character is stored as a uint16_t in the receive and transmit buffers, which takes two bytes.
+   */
+  enum CharSize {
+    kCharSize8 = 0x0, // 8 bits, CTRLB.CHSIZE = 0x0
+    kCharSize9 = 0x1 // 9 bits, CTRLB.CHSIZE = 0x1
+  };
+
+  /**
+   * @brief Interrupt profile, selecting the SERCOM interrupts enabled by SercomInit().
+   * 
+   * In every profile the Data Register Empty interrupt is only armed while characters are queued to transmit, as it is set whenever the data register is empty.
+   */
+  enum InterruptProfile {
+    kFullDuplex = 0x0, // Receive Complete, Transmit Complete and Error. Characters queued with write() or setResponse() are transmitted.
+    kReceiveOnly = 0x1, // Receive Complete, Transmit Complete and Error. write() and setResponse() queue nothing, so the data on MISO is undefined.
+    kDmaAssisted = 0x2 // Transmit Complete only. The received characters are written by the DMAC after enableDMA().
+  };
+
+  /**
+   * @brief Event that wakes the core from standby, see enableStandby().
+   */
+  enum WakeSource {
+    kWakeOnSlaveSelect = 0x0, // Slave Select low. The core wakes when the master starts a transaction, and stays awake until Slave Select goes high.
+    kWakeOnTransactionEnd = 0x1 // Slave Select high. With the DMA receive path, the DMAC writes the characters while the core sleeps, and the core only wakes at the end of the transaction.
+  };
+
+  // Polynomials of the CRC engine of the DMAC. Reference: Atmel-42181G-SAM-D21_Datasheet section 19.6.3.7
+  enum DmaCrc {
+    kDmaCrc16 = 0x0, // CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, transmitted most significant byte first
+    kDmaCrc32 = 0x1 // CRC-32 (IEEE 802.3): polynomial 0x04C11DB7, initial value 0xFFFFFFFF, transmitted least significant byte first
+  };
+
+  /**
+   * @brief Events reported by the DMA receive path.
+   */
+  enum DmaEvent {
+    kDmaHalfTransfer, // The first half of the circular buffer has been filled
+    kDmaFullTransfer, // The second half of the circular buffer has been filled, writing continues at the start of the buffer
+    kDmaTransactionEnd // Slave Select went high, the master ended the transaction
+  };
+
+  /**
+   * @brief Callback of the DMA receive path. It is called from interrupt context.
+   * 
+   * @param[in] event The event that triggered the callback.
+   * @param[in] position Index in the circular buffer at which the next received byte will be written.
+   * 
+   */
+  typedef void (*DmaCallback)(DmaEvent event, size_t position);
+
+  static const size_t kDmaPositionError = (size_t)-1; // Returned by dmaPosition() if the DMAC did not report the position
+
+  /**
+   * @brief Callback called when a frame is complete. It is called from interrupt context.
+   * 
+   * @param[in] length Number of bytes of the frame, two per character in 9-bit mode. The frame can be read with readFrame(), in the callback or later in the main loop.
+   * 
+   */
+  typedef void (*FrameCallback)(size_t length);
+
+  /**
+   * @brief Callback called when the SERCOM reports a buffer overflow. It is called from interrupt context.
+   * 
+   * @param[in] overflows Number of buffer overflows since SercomInit() or resetStats(), see Stats.
+   * 
+   */
+  typedef void (*ErrorCallback)(uint32_t overflows);
+
+  /**
+   * @brief Callback called at the end of a transaction that wrote registers of the register map. It is called from interrupt context.
+   * 
+   * @param[in] address Address of the first register written.
+   * @param[in] count Number of registers written, including the registers of which no bit is writable.
+   * 
+   */
+  typedef void (*RegisterWriteCallback)(uint8_t address, uint8_t count);
+
+  /**
+   * @brief Segment of the response of the DMA transmit path, see setResponseSegments().
+   */
+  struct Segment {
+    const volatile void* buffer; // Characters to transmit, which must remain valid while the segment is set
+    uint16_t length; // Number of characters
+  };
+
+  /**
+   * @brief Hardware timestamps of a transaction, in ticks of TC4, see enableTimestamps().
+   */
+  struct Timestamps {
+    uint32_t start; // Slave Select low
+    uint32_t end; // Slave Select high
+    bool valid; // false if an edge was not captured, for instance if the transaction was shorter than the interrupt latency, or if timestamps are disabled
+  };
+
+  /**
+   * @brief Memory of the timestamps, provided by the application to enableTimestamps(), such that a slave without timestamps does not hold it.
+   */
+  struct TimestampStorage {
+    SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE, Timestamps> frames; // Timestamps of the frames queued for readFrame()
+    volatile uint32_t latency_histogram[SERCOM_SPI_SLAVE_LATENCY_BINS]; // Number of latencies in each bin of latency_bin_ticks, the last bin also counts the longer latencies. Cleared by enableTimestamps() and resetStats().
+  };
+
+  /**
+   * @brief Runtime statistics of a slave, see getStats().
+   */
+  struct Stats {
+    uint32_t chars_received; // Characters received (bytes in 8-bit mode), including the characters dropped
+    uint32_t chars_sent; // Characters loaded into the data register for transmission
+    uint32_t transactions; // Transactions, from Slave Select low to Slave Select high
+    uint32_t overflows; // Buffer overflows reported by the SERCOM (STATUS.BUFOVF): characters lost because the interrupt was served too late
+    uint32_t resyncs; // Transactions of which the characters after a buffer overflow were discarded
+    uint32_t drops; // Characters dropped because the receive buffer was full
+    uint32_t frames_dropped; // Frames dropped because they did not fit in the receive buffer or the frame queue
+    uint32_t crc_errors; // Transactions of which the CRC did not match, see enableCrc()
+    uint32_t wakeups; // Number of times standby() woke the core from standby. The wake-ups from the idle sleep during a transaction are not counted.
+    uint32_t isr_count; // Number of calls of IrqHandler()
+    uint32_t isr_max_cycles; // Longest duration of IrqHandler() in CPU cycles, measured with SysTick
+    uint32_t isr_avg_cycles; // Average duration of IrqHandler() in CPU cycles, measured with SysTick
+    uint32_t latency_count; // Number of latencies from Slave Select low to IrqHandler() measured, see enableTimestamps()
+    uint32_t latency_min; // Shortest latency in ticks of TC4
+    uint32_t latency_max; // Longest latency in ticks of TC4. The histogram of the latencies is kept in the TimestampStorage.
+  };
+
+  // Public methods //
+  /**
+   * @brief Change the SPI mode without initializing the SERCOM again.
+   * 
+   * The SERCOM is disabled, only CTRLA.CPOL, CTRLA.CPHA and CTRLA.DORD are rewritten, and the SERCOM is enabled again, without a software reset, the pin multiplexing or the clock setup of SercomInit().
+   * Call this function between transactions, while Slave Select is high. Disabling the SERCOM discards the character preloaded for the next transaction:
+   * the response and the DMA transmit path start again from the first character, but a character preloaded from the transmit buffer of write() is lost.
+   * 
+   * @param[in] cpol Clock polarity: 0 SCK is low when idle, 1 SCK is high when idle
+   * @param[in] cpha Clock phase: 0 data is sampled on the leading SCK edge, 1 on the trailing SCK edge
+   * @param[in] dord Data order: 0 MSB first (default), 1 LSB first
+   * 
+   * @return true if the mode is changed, false if SercomInit() has not been called or a transaction is active.
+   * 
+   */
+  bool setMode(uint8_t cpol, uint8_t cpha, uint8_t dord = 0);
+
+  /**
+   * @brief Change the character size without initializing the SERCOM again.
+   * 
+   * Only CTRLB.CHSIZE is rewritten, as in setMode(). The receive and transmit buffers, the queued frames and the response are discarded, as they hold characters of the previous size.
+   * Not available while the DMA receive or transmit path is enabled. 9-bit characters are not available with the register map or the CRC.
+   * 
+   * @param[in] char_size kCharSize8 or kCharSize9
+   * 
+   * @return true if the character size is changed, false if SercomInit() has not been called, a transaction is active or the size is not supported in the current configuration.
+   * 
+   */
+  bool setCharSize(CharSize char_size);
+
+  /**
+   * @brief Stop the slave and release its pins.
+   * 
+   * The SERCOM and its interrupt are disabled, and the pins are returned to the PORT. A transaction in progress is discarded.
+   * The configuration, the clock, the buffers and the DMA paths are kept, such that begin() resumes within microseconds, without SercomInit().
+   * Functions that change the configuration meanwhile, such as setMode(), enableStandby() or enableTimestamps(), leave the slave stopped until begin().
+   * 
+   * @return void
+   * 
+   */
+  void end();
+
+  /**
+   * @brief Resume the slave after end().
+   * 
+   * The pins are connected to the SERCOM again, and the SERCOM and its interrupt are enabled, without a software reset. The response and the DMA transmit path start from the first character.
+   * 
+   * The configuration changed while the slave was stopped, for instance by setMode(), is kept.
+   * 
+   * @return true if the slave runs, false if SercomInit() has not been called.
+   * 
+   */
+  bool begin();
+
+  /**
+   * @brief Number of received characters that can be read.
+   * 
+   * @return Number of characters in the receive buffer.
+   * 
+   */
+  int available() override;
+
+  /**
+   * @brief Read one received character.
+   * 
+   * @return The oldest character in the receive buffer (0 to 255, or 0 to 511 in 9-bit mode), or -1 if the buffer is empty.
+   * 
+   */
+  int read() override;
+
+  /**
+   * @brief Read received bytes in bulk.
+   * 
+   * @param[out] buffer Buffer to copy the received bytes to.
+   * @param[in] length Maximum number of bytes to copy.
+   * 
+   * @return Number of bytes copied, which is less than length if the receive buffer holds fewer bytes.
+   * 
+   */
+  size_t read(uint8_t* buffer, size_t length);
+
+  /**
+   * @brief Read received bytes in bulk, waiting for them as Stream::readBytes() does.
+   * 
+   * The bytes available are copied at once. The call waits up to the timeout of setTimeout() for more bytes, restarting the timeout whenever bytes arrive.
+   * In 9-bit mode the bytes of the characters are copied as stored, two per character.
+   * 
+   * @param[out] buffer Buffer to copy the received bytes to.
+   * @param[in] length Number of bytes to copy.
+   * 
+   * @return Number of bytes copied, which is less than length on a timeout.
+   * 
+   */
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+
+  /**
+   * @brief Read received characters in bulk, in 9-bit mode.
+   * 
+   * In 9-bit mode the characters are copied from the receive buffer without repacking. In 8-bit mode each byte is copied to a uint16_t.
+   * 
+   * @param[out] buffer Buffer to copy the received characters to.
+   * @param[in] length Maximum number of characters to copy.
+   * 
+   * @return Number of characters copied.
+   * 
+   */
+  size_t read(uint16_t* buffer, size_t length);
+
+  /**
+   * @brief Read one received character, without removing it from the receive buffer.
+   * 
+   * @return The oldest character in the receive buffer, or -1 if the buffer is empty.
+   * 
+   */
+  int peek() override;
+
+  /**
+   * @brief Queue one byte to transmit to the master on MISO.
+   * 
+   * The bytes queued are transmitted in order, across transactions. The first byte is preloaded into the shift register while Slave Select is high, such that it is transmitted with the first SCK edge of the next transaction.
+   * When no byte is queued, the data transmitted on MISO is undefined.
+   * 
+   * @param[in] data Byte to transmit.
+   * 
+   * @return 1 if the byte is queued, 0 if the transmit buffer is full.
+   * 
+   */
+  size_t write(uint8_t data) override;
+
+  /**
+   * @brief Queue bytes to transmit to the master on MISO in bulk.
+   * 
+   * @param[in] buffer Bytes to transmit.
+   * @param[in] length Number of bytes to transmit.
+   * 
+   * @return Number of bytes queued, which is less than length if the transmit buffer is full.
+   * 
+   */
+  size_t write(const uint8_t* buffer, size_t length) override;
+
+  // Overloads of Print, such that write(0) and writes of other integer types are not ambiguous
+  using Print::write;
+  size_t write(unsigned long data) { return write((uint8_t)data); }
+  size_t write(long data) { return write((uint8_t)data); }
+  size_t write(unsigned int data) { return write((uint8_t)data); }
+  size_t write(int data) { return write((uint8_t)data); }
+
+  /**
+   * @brief Queue one character to transmit to the master on MISO, in 9-bit mode.
+   * 
+   * @param[in] data Character to transmit. In 8-bit mode only the lower 8 bits are transmitted.
+   * 
+   * @return 1 if the character is queued, 0 if the transmit buffer is full.
+   * 
+   */
+  size_t write16(uint16_t data);
+
+  /**
+   * @brief Queue characters to transmit to the master on MISO in bulk, in 9-bit mode.
+   * 
+   * @param[in] buffer Characters to transmit.
+   * @param[in] length Number of characters to transmit.
+   * 
+   * @return Number of characters queued, which is less than length if the transmit buffer is full.
+   * 
+   */
+  size_t write(const uint16_t* buffer, size_t length);
+
+  /**
+   * @brief Number of characters that can be queued with write().
+   * 
+   * @return Number of free characters in the transmit buffer.
+   * 
+   */
+  int availableForWrite() override;
+
+  /**
+   * @brief Set the response transmitted at the start of every transaction.
+   * 
+   * While a response is set, it replaces the bytes queued with write(). The first byte of the response is preloaded before Slave Select goes low, and the next bytes are loaded as the master clocks them out.
+   * If the master clocks more bytes than the response holds, the data transmitted on MISO is undefined. If it clocks fewer, the SERCOM is re-enabled at the end of the transaction, to discard the bytes already preloaded.
+   * Set the response between transactions, for instance from loop() after a transaction has been processed. Replacing or clearing the response re-enables the SERCOM, to discard the bytes preloaded from the previous one.
+   * The first two bytes are preloaded into the data and shift registers at the end of the previous transaction. After updating the contents of the buffer, call setResponse() again, such that they are loaded again.
+   * 
+   * @param[in] buffer Response to transmit. It is not copied, so it must remain valid while it is set. NULL clears the response.
+   * @param[in] length Number of bytes of the response.
+   * 
+   * @return void
+   * 
+   */
+  void setResponse(const uint8_t* buffer, size_t length);
+
+  /**
+   * @brief Set the response transmitted at the start of every transaction, in 9-bit mode.
+   * 
+   * @param[in] buffer Characters of the response. It is not copied, so it must remain valid while it is set. NULL clears the response.
+   * @param[in] length Number of characters of the response.
+   * 
+   * @return void
+   * 
+   */
+  void setResponse16(const uint16_t* buffer, size_t length);
+
+  /**
+   * @brief Enable framing of the received bytes.
+   * 
+   * A frame holds the bytes received from Slave Select going low to Slave Select going high. The end of a frame is detected with the Transmit Complete interrupt, which the SERCOM sets when Slave Select goes high in slave mode.
+   * While framing is enabled, read the received bytes with readFrame() rather than with read().
+   * A frame is dropped as a whole if it does not fit in the receive buffer, or if SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE frames are already queued.
+   * 
+   * @param[in] callback Function called at the end of each frame, or NULL.
+   * 
+   * @return void
+   * 
+   */
+  void enableFraming(FrameCallback callback = NULL);
+
+  /**
+   * @brief Disable framing of the received bytes. Queued frames remain readable with read().
+   * 
+   * @return void
+   * 
+   */
+  void disableFraming();
+
+  /**
+   * @brief Number of complete frames that can be read with readFrame(), or lent with lendFrame().
+   * 
+   * @return Number of frames queued.
+   * 
+   */
+  int availableFrames();
+
+  /**
+   * @brief Read the oldest complete frame.
+   * 
+   * @param[out] buffer Buffer to copy the frame to.
+   * @param[in] size Size of the buffer. The bytes of the frame that do not fit are discarded.
+   * 
+   * @return Number of bytes of the frame, which is larger than size if bytes were discarded, or 0 if no frame is queued.
+   * 
+   */
+  size_t readFrame(uint8_t* buffer, size_t size);
+
+  /**
+   * @brief Read the oldest complete frame, and the verdict of its CRC.
+   * 
+   * @param[out] buffer Buffer to copy the frame to, including the CRC in its last bytes.
+   * @param[in] size Size of the buffer. The bytes of the frame that do not fit are discarded.
+   * @param[out] crc_valid true if the CRC at the end of the frame matches the CRC of the bytes before it. false if it does not, or if enableCrc() was not called.
+   * @param[out] crc CRC computed over the bytes of the frame before its CRC, or NULL.
+   * 
+   * @return Number of bytes of the frame, which is larger than size if bytes were discarded, or 0 if no frame is queued.
+   * 
+   */
+  size_t readFrame(uint8_t* buffer, size_t size, bool* crc_valid, uint32_t* crc = NULL);
+
+  /**
+   * @brief Enable the ping-pong receive mode, in which IrqHandler() writes each frame straight into one of two buffers of the application.
+   * 
+   * The buffers are used in turn. When Slave Select goes high the filled buffer is handed to the application, and the next frame is written into the other buffer, without a copy.
+   * Ownership: the library owns both buffers until lendFrame() returns one. The application owns that buffer until it passes it to returnFrame(), and must not write to the other one.
+   * A frame is dropped and counted in frames_dropped of getStats() if the application still holds, or has not yet taken, the previous frame, if it does not fit in a buffer, or if a character was lost.
+   * The dropped frame is overwritten by the next one. read() and readFrame() receive nothing while the ping-pong mode is enabled, and framing is disabled.
+   * Not available with the register map or the DMA receive path.
+   * 
+   * @param[in] buffer0, buffer1 Buffers of the application. They must remain valid until disablePingPong() is called.
+   * @param[in] size Size of each buffer in bytes, two per character in 9-bit mode: 1 to 65535.
+   * @param[in] callback Function called with the length of each frame handed to the application, or NULL. The frame can be taken with lendFrame() in the callback.
+   * 
+   * @return true if the ping-pong mode is enabled, false if an argument is invalid, or the register map or the DMA receive path is enabled.
+   * 
+   */
+  bool enablePingPong(uint8_t* buffer0, uint8_t* buffer1, size_t size, FrameCallback callback = NULL);
+
+  /**
+   * @brief Disable the ping-pong receive mode, and store the received bytes in the receive buffer again. The library no longer uses the buffers.
+   * 
+   * @return void
+   * 
+   */
+  void disablePingPong();
+
+  /**
+   * @brief Receive the frames into the slots of a pool, without a copy and without heap allocation.
+   * 
+   * The first character of each transaction claims a free slot, and IrqHandler() writes the frame straight into it. When Slave Select goes high the slot is queued as ready.
+   * The application takes the ready frames in order with lendFrame(), and releases each slot with returnFrame() once processed, such that several frames can be in flight.
+   * A frame is dropped and counted in frames_dropped of getStats() if no slot is free, if it does not fit in a slot, or if a character was lost.
+   * read() and readFrame() receive nothing while the pool is enabled, and framing and the ping-pong mode are disabled. Not available with the register map or the DMA receive path.
+   * 
+   * @param[in] pool Pool of slots, see SercomSPISlaveFramePoolT. It must remain valid until disableFramePool() is called. A pool serves one slave.
+   * @param[in] callback Function called with the length of each frame queued as ready, or NULL.
+   * 
+   * @return true if the pool is enabled, false if pool is NULL, its slots cannot hold a character, or the register map or the DMA receive path is enabled.
+   * 
+   */
+  bool enableFramePool(SercomSPISlaveFramePool* pool, FrameCallback callback = NULL);
+
+  /**
+   * @brief Stop receiving into the pool, and store the received bytes in the receive buffer again.
+   * 
+   * The ready and lent frames remain in the pool. Call Clear() of the pool to free them.
+   * 
+   * @return void
+   * 
+   */
+  void disableFramePool();
+
+  /**
+   * @brief Lend the oldest frame received in the ping-pong mode or into the frame pool to the application.
+   * 
+   * @param[out] length Number of bytes of the frame, or NULL.
+   * 
+   * @return The buffer holding the frame, or NULL if no frame is ready, or in the ping-pong mode if a frame is already lent. Pass the buffer to returnFrame() when done with it.
+   * 
+   */
+  uint8_t* lendFrame(size_t* length = NULL);
+
+  /**
+   * @brief Return a buffer lent by lendFrame() to the library, such that a next frame can be received into it.
+   * 
+   * @param[in] buffer The buffer returned by lendFrame().
+   * 
+   * @return true if the buffer is returned, false if it is not a buffer lent.
+   * 
+   */
+  bool returnFrame(uint8_t* buffer);
+
+  /**
+   * @brief Enable the CRC check of received transactions.
+   * 
+   * The CRC is updated as the characters arrive: per character in IrqHandler(), or per block on each DmaEvent with the DMA receive path. No pass over the frame is needed in the main loop.
+   * The last crc->Bytes() characters of each transaction are taken as the CRC of the characters before them. The verdict is delivered with the frame by readFrame(), and with the transaction by lastTransactionCrc().
+   * Only available with 8-bit characters.
+   * 
+   * @param[in] crc CRC to use. It must remain valid until disableCrc() is called.
+   * 
+   * @return true if the CRC check is enabled, false if crc is NULL, the characters are 9-bit, or enableDmaCrc() is enabled.
+   * 
+   */
+  bool enableCrc(const SercomSPISlaveCrc* crc);
+
+  /**
+   * @brief Disable the CRC check of received transactions.
+   * 
+   * @return void
+   * 
+   */
+  void disableCrc();
+
+  /**
+   * @brief Verdict of the CRC of the last complete transaction.
+   * 
+   * @param[out] crc CRC computed over the characters of the transaction before its CRC, or NULL. With enableDmaCrc(), the checksum of the DMAC over the whole transaction, CRC included.
+   * 
+   * @return true if the CRC at the end of the transaction matches. false if it does not, if the transaction was not longer than the CRC, or if neither enableCrc() nor enableDmaCrc() was called.
+   * 
+   */
+  bool lastTransactionCrc(uint32_t* crc = NULL);
+
+  /**
+   * @brief Queue bytes to transmit to the master on MISO, followed by their CRC.
+   * 
+   * The bytes and the CRC are queued together, or not at all.
+   * 
+   * @param[in] buffer Bytes to transmit.
+   * @param[in] length Number of bytes.
+   * @param[in] crc CRC to append.
+   * 
+   * @return Number of bytes queued, including the CRC, or 0 if they do not fit in the transmit buffer.
+   * 
+   */
+  size_t writeWithCrc(const uint8_t* buffer, size_t length, const SercomSPISlaveCrc& crc);
+
+  /**
+   * @brief Enable the register map protocol.
+   * 
+   * The first character of each transaction is a command: bit 7 selects a read (1) or a write (0), and bits 6 to 0 the address of the first register.
+   * In a read, the registers are transmitted from the address on, straight from the memory of the application, while the characters of the master are ignored.
+   * In a write, the characters of the master are written to the registers from the address on. Only the bits set in write_mask are changed.
+   * The address increments after each character. Characters beyond the end of the map are ignored in a write, and undefined in a read.
+   * 
+   * The first register of a read is loaded when the command is received, so the master must leave at least one interrupt duration between the command and the next character.
+   * The received characters are not stored in the receive buffer, and frames are not queued. Only available with 8-bit characters and the kFullDuplex profile.
+   * Registers wider than one byte should be updated by the application with interrupts disabled, such that the master reads consistent values.
+   * 
+   * @param[in] registers Memory of the registers, for instance a struct. It must remain valid until disableRegisterMap() is called.
+   * @param[in] size Number of registers in bytes: 1 to 128.
+   * @param[in] write_mask Writable bits of each register, size bytes, or NULL if all registers are read-only.
+   * @param[in] callback Function called at the end of each transaction that wrote registers, or NULL.
+   * 
+   * @return true if the register map is enabled, false if an argument is invalid, SercomInit() has not been called, or the character size or profile is not supported.
+   * 
+   */
+  bool enableRegisterMap(volatile void* registers, uint8_t size, const uint8_t* write_mask = NULL, RegisterWriteCallback callback = NULL);
+
+  /**
+   * @brief Disable the register map protocol, and store the received characters in the receive buffer again.
+   * 
+   * @return void
+   * 
+   */
+  void disableRegisterMap();
+
+  /**
+   * @brief Set the callback called on a buffer overflow.
+   * 
+   * When a character is received while the data register is full, the SERCOM sets STATUS.BUFOVF and the Error interrupt, and a character is lost.
+   * IrqHandler() clears the error, and discards the characters received until Slave Select goes high, such that the next transaction starts in sync. With framing enabled, the frame is dropped.
+   * The receiver carries on with the next transaction, without calling SercomInit() again.
+   * 
+   * @param[in] callback Function called on each buffer overflow, or NULL.
+   * 
+   * @return void
+   * 
+   */
+  void setErrorCallback(ErrorCallback callback);
+
+  /**
+   * @brief Select the event that wakes the core from standby.
+   * 
+   * With kWakeOnSlaveSelect, Slave Select Low Detection (CTRLB.SSDE) and the Slave Select Low interrupt are enabled. The SERCOM is disabled and enabled to change CTRLB, so call this function between transactions.
+   * With kWakeOnTransactionEnd, the Transmit Complete interrupt at the end of a transaction wakes the core. Without the DMA receive path, the first Receive Complete interrupt wakes the core as well.
+   * 
+   * The SERCOM keeps receiving in standby (CTRLA.RUNSTDBY), so the first character is not lost while the core wakes up. The wake-to-first-byte latency is the standby wake-up time of the clock source of GCLK0, see the electrical characteristics of the datasheet, plus one interrupt.
+   * As the data register holds one character while the next one is shifted in, the master must leave at least this latency between pulling Slave Select low and completing the second character.
+   * 
+   * @param[in] source kWakeOnSlaveSelect or kWakeOnTransactionEnd
+   * 
+   * @return void
+   * 
+   */
+  void enableStandby(WakeSource source);
+
+  /**
+   * @brief Sleep in standby until a transaction ends.
+   * 
+   * The core sleeps in standby between transactions, and in idle during a transaction, such that IrqHandler() serves every character in time. Interrupts of other peripherals wake the core, and are served before it goes back to sleep.
+   * Returns immediately if a transaction ended since the last call. The frame or the DMA position can then be read, before calling standby() again.
+   * Call enableStandby() first.
+   * 
+   * @return void
+   * 
+   */
+  void standby();
+
+  /**
+   * @brief Enable the DMA receive path.
+   * 
+   * This function connects the SERCOM receive trigger to a DMAC channel, which writes every received byte into a circular buffer supplied by the user.
+   * The buffer is split in two halves, such that the CPU is only interrupted when a half is filled and when Slave Select goes high.
+   * The Receive Complete, Data Register Empty, Slave Select Low and Error interrupts are disabled while the DMA receive path is enabled.
+   * Call this function after SercomInit(). The received bytes are not available through read() while the DMA receive path is enabled.
+   * The DMAC interrupt takes the highest priority of the SERCOM interrupts of the slaves using the DMAC, such that they do not preempt it.
+   * 
+   * @param[in] channel DMAC channel to use: 0 to 11. If the sketch or another library configured BASEADDR and WRBADDR before, their tables are shared, and the channel must be free in them.
+   * @param[in] buffer Circular buffer the received bytes are written to. It must remain valid until disableDMA() is called.
+   * @param[in] length Length of the buffer in bytes. Must be even, and at most 131070. In 9-bit mode each character takes two bytes, so it must be a multiple of 4, and at most 262140.
+   * @param[in] callback Function called on each DmaEvent, or NULL.
+   * 
+   * @return true if the DMA receive path is enabled, false if an argument is invalid or SercomInit() has not been called.
+   * 
+   */
+  bool enableDMA(uint8_t channel, volatile uint8_t* buffer, size_t length, DmaCallback callback = NULL);
+
+  /**
+   * @brief Disable the DMA receive path, and receive through IrqHandler() again, also in the kDmaAssisted profile.
+   * 
+   * @return void
+   * 
+   */
+  void disableDMA();
+
+  /**
+   * @brief Position of the DMA receive path in the circular buffer.
+   * 
+   * The channel is suspended for a moment to read its position. If it does not suspend, for instance after a transfer error disabled it, the wait is abandoned.
+   * 
+   * @return Index in the circular buffer at which the next received byte will be written, or kDmaPositionError if the DMAC did not report the position.
+   * 
+   */
+  size_t dmaPosition();
+
+  /**
+   * @brief Enable the DMA transmit path.
+   * 
+   * This function connects the SERCOM transmit trigger (Data Register Empty) to a DMAC channel, which loads the response set with setResponseSegments() into the data register.
+   * The response is transmitted without interrupts and without copying it. At the end of each transaction the channel is restarted, such that every transaction transmits the response from its start.
+   * While the DMA transmit path is enabled, write() and setResponse() do nothing. It can be combined with the DMA receive path on another channel.
+   * Call this function after SercomInit(). Not available in the kReceiveOnly profile, or with the register map.
+   * 
+   * @param[in] channel DMAC channel to use: 0 to 11, other than the channel of the DMA receive path.
+   * 
+   * @return true if the DMA transmit path is enabled, false if an argument is invalid or SercomInit() has not been called.
+   * 
+   */
+  bool enableTxDMA(uint8_t channel);
+
+  /**
+   * @brief Disable the DMA transmit path, and transmit through IrqHandler() again.
+   * 
+   * @return void
+   * 
+   */
+  void disableTxDMA();
+
+  /**
+   * @brief Set the response of the DMA transmit path as a list of segments.
+   * 
+   * Each segment becomes a DMAC descriptor, linked to the next one, such that the DMAC transmits the segments back to back, from wherever they are in memory.
+   * The contents of the segments may be updated between transactions. Set the segments between transactions, for instance from loop() after a transaction has been processed.
+   * If the master clocks more characters than the segments hold, the data transmitted on MISO is undefined.
+   * 
+   * @param[in] segments Segments to transmit in order. The array is not used after the call, but the buffers of the segments are. Segments of length 0 are skipped.
+   * @param[in] count Number of segments. 0 clears the response.
+   * @param[in] descriptors Descriptors of the second and further segments, at least count - 1, aligned to 16 bytes. The first segment takes the descriptor of the channel in the descriptor table.
+   *                        They must remain valid while the segments are set, and can be NULL for a single segment. Declare them as __attribute__((__aligned__(16))) DmacDescriptor descriptors[count - 1].
+   * 
+   * @return true if the response is set, false if the DMA transmit path is not enabled, or descriptors is NULL or not aligned while it is needed.
+   * 
+   */
+  bool setResponseSegments(const Segment* segments, uint8_t count, DmacDescriptor* descriptors = NULL);
+
+  /**
+   * @brief Check the CRC of each transaction of the DMA receive path with the CRC engine of the DMAC.
+   * 
+   * The DMAC updates the CRC with each byte it transfers, so the check takes no CPU cycles per byte. At the end of each transaction the checksum is read, compared and restarted.
+   * The last bytes of each transaction are taken as the CRC of the bytes before them. The verdict is delivered by lastTransactionCrc(), which can be called from the kDmaTransactionEnd event.
+   * The DMAC has one CRC engine, so only one slave can use it at a time. The master must leave Slave Select high for at least one interrupt duration between transactions, such that the checksum is restarted before the next byte.
+   * Call enableDMA() first. enableCrc() and enableDmaCrc() exclude each other.
+   * 
+   * @param[in] polynomial kDmaCrc16 or kDmaCrc32.
+   * 
+   * @return true if the CRC check is enabled, false if the DMA receive path is not enabled, the characters are 9-bit, enableCrc() is enabled, or another slave uses the CRC engine.
+   * 
+   */
+  bool enableDmaCrc(DmaCrc polynomial);
+
+  /**
+   * @brief Disable the CRC check by the CRC engine of the DMAC, and release the engine.
+   * 
+   * @return void
+   * 
+   */
+  void disableDmaCrc();
+
+  /**
+   * @brief Capture the Slave Select edges of each transaction with a timer, and measure the interrupt latency.
+   * 
+   * The SS pin is routed to the SERCOM, so it cannot drive the EIC as well. Connect SS also to capture_pin, which is routed to the EIC.
+   * Both edges of capture_pin are routed through the Event System to capture channel 0 of TC4, which counts in 32-bit mode (TC4 and TC5) at the clock of gclk_generator.
+   * The timestamps are captured by hardware, so they do not depend on the interrupt latency. IrqHandler() reads the Slave Select low capture, and compares it with the counter to measure the latency into Stats.
+   * The timestamps are delivered with the frame by lastFrameTimestamps(), and with the transaction by lastTransactionTimestamps(), which can be called from the kDmaTransactionEnd event.
+   * The timestamps of the queued frames and the latency histogram are kept in storage, which the application reads the histogram from.
+   * TC4 and TC5 are used by this function, so they cannot be used by other libraries such as Servo. Only one slave can use timestamps at a time.
+   * 
+   * @param[in] capture_pin Pin connected to SS, any pin with an external interrupt line except PA08 and the four pins of the slave.
+   * @param[in] evsys_channel Event System channel, 0 to 11.
+   * @param[in] storage Memory of the timestamps. It must remain valid until disableTimestamps() is called.
+   * @param[in] gclk_generator Generic Clock Generator of TC4. The generator must be enabled.
+   * @param[in] latency_bin_ticks Width of the bins of the latency histogram in ticks of TC4.
+   * 
+   * @return true if the timestamps are enabled, false if SercomInit() has not been called, an argument is invalid or storage is NULL, capture_pin is a pin of the slave, or another slave uses TC4.
+   * 
+   */
+  bool enableTimestamps(SercomPin capture_pin, uint8_t evsys_channel, TimestampStorage* storage, uint8_t gclk_generator = 0, uint16_t latency_bin_ticks = 8);
+
+  /**
+   * @brief Stop capturing timestamps, and release TC4, the Event System channel and the external interrupt line.
+   * 
+   * @return void
+   * 
+   */
+  void disableTimestamps();
+
+  /**
+   * @brief Timestamps of the last complete transaction.
+   * 
+   * @return Timestamps, with valid false if they were not captured.
+   * 
+   */
+  Timestamps lastTransactionTimestamps();
+
+  /**
+   * @brief Timestamps of the frame returned by the last call of readFrame().
+   * 
+   * @return Timestamps, with valid false if they were not captured.
+   * 
+   */
+  Timestamps lastFrameTimestamps();
+
+  /**
+   * @brief Runtime statistics of the slave since SercomInit() or resetStats().
+   * 
+   * The counters are updated by IrqHandler() and the DMA receive path, and copied with interrupts disabled, such that they are consistent.
+   * In DMA mode the received characters are counted at each DmaEvent, and the DMAC cannot report overflows or drops.
+   * The duration of IrqHandler() is measured with SysTick, which counts at the CPU clock, and includes the callbacks called from it.
+   * 
+   * @return Copy of the statistics.
+   * 
+   */
+  Stats getStats();
+
+  /**
+   * @brief Reset all statistics to zero.
+   * 
+   * @return void
+   * 
+   */
+  void resetStats();
+
+  /**
+   * @brief SERCOM interrupt handler.
+   * 
+   * This function handles the SERCOM interrupts used by the library, and stores the received bytes in the receive buffer.
+   * The library defines a weak SERCOMn_Handler for each SERCOM that calls this function for the slave initialized on that SERCOM.
+   * A SERCOMn_Handler defined by the sketch, the board variant or another library takes precedence, and should call this function to use the receive buffer.
+   * Define SERCOM_SPI_SLAVE_NO_SERCOM_HANDLERS in the build flags to remove all weak SERCOMn_Handler of the library, or SERCOM_SPI_SLAVE_NO_SERCOMn_HANDLER to remove the one of SERCOMn.
+   * With SERCOM_SPI_SLAVE_RAMFUNC, this function, the weak SERCOMn_Handler and the functions they call per character run from RAM.
+   * 
+   * @return void
+   * 
+   */
+  SERCOM_SPI_SLAVE_RAM_CODE void IrqHandler();
+
+  /**
+   * @brief SERCOM interrupt dispatcher.
+   * 
+   * This function calls IrqHandler() of the slave initialized on a SERCOM. It is called by the weak SERCOMn_Handler of the library.
+   * All six handlers share this routine and the table of slaves indexed by SERCOM number. It is inline, such that each handler reduces to a table load and a call.
+   * 
+   * @param[in] sercom_no Number of the SERCOM: 0 to 5
+   * 
+   * @return void
+   * 
+   */
+  static SERCOM_SPI_SLAVE_INLINE void SercomIrqHandler(uint8_t sercom_no) {
+    SercomSPISlave* instance = instances_[sercom_no];
+    if (instance != NULL) {
+      instance->IrqHandler();
+    }
+  }
+
+  /**
+   * @brief Slave initialized on a SERCOM.
+   * 
+   * Slaves on different SERCOM run concurrently, each with its own buffers, callbacks and statistics. This function allows to serve all of them in one loop.
+   * 
+   * @param[in] sercom_no Number of the SERCOM: 0 to 5
+   * 
+   * @return The slave on which SercomInit() was called last for the SERCOM, or NULL if there is none.
+   * 
+   */
+  static SercomSPISlave* instance(uint8_t sercom_no);
+
+  /**
+   * @brief Highest SCK frequency of the master the slave can follow without buffer overflows.
+   * 
+   * The SERCOM holds one received character in its data register while the next one is shifted in, so IrqHandler() must complete within one character time.
+   * The receiver also synchronizes each character to the Generic Clock of the SERCOM, which is assumed to need two clock periods per SCK period.
+   * Use the isr_max_cycles of getStats(), measured under the expected load, for isr_cycles. With the DMA receive path, pass 0.
+   * The exception entry and exit, which isr_cycles does not include, are added to it.
+   * 
+   * @param[in] isr_cycles Duration of IrqHandler() in CPU cycles, as measured in isr_max_cycles, including the time it waits for interrupts of a higher priority.
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] cpu_frequency CPU clock in Hz. Default F_CPU.
+   * @param[in] gclk_frequency Frequency of the Generic Clock Generator of the SERCOM in Hz. Default F_CPU, the frequency of generator 0 in the Arduino core.
+   * 
+   * @return Frequency in Hz.
+   * 
+   */
+  static uint32_t maxSckFrequency(uint32_t isr_cycles, CharSize char_size = kCharSize8, uint32_t cpu_frequency = F_CPU, uint32_t gclk_frequency = F_CPU);
+
+  /**
+   * @brief DMAC interrupt handler.
+   * 
+   * The library defines a weak DMAC_Handler that calls this function. If the sketch defines its own DMAC_Handler, it should call this function.
+   * Define SERCOM_SPI_SLAVE_NO_DMAC_HANDLER in the build flags to remove the weak DMAC_Handler of the library.
+   * 
+   * @return void
+   * 
+   */
+  static void DmacIrqHandler();
+
+  /**
+   * @brief Copy the vector table of the application to RAM, and point the Vector Table Offset Register to the copy.
+   * 
+   * On each interrupt the core loads the address of the handler from the vector table. With the table in RAM this load has no flash wait states.
+   * Combined with SERCOM_SPI_SLAVE_RAMFUNC, the interrupt entry and the per-character path of IrqHandler() run without flash accesses. The table takes 256 bytes of RAM.
+   * Call this function once in setup(). Handlers are taken from the table at the time of the call.
+   * 
+   * @return void
+   * 
+   */
+  static void relocateVectorTable();
+
+ protected:
+  // Constructors //
+  SercomSPISlave();
+
+  // Protected methods //
+  /**
+   * @brief SERCOM pin and registry initialization.
+   * 
+   * This function looks up the PAD of each pin, selects the Data In Pinout (DIPO) and Data Out Pinout (DOPO) matching the PADs, connects the pins to the SERCOM and initializes the SERCOM registries.
+   * In slave mode MOSI may use any PAD, but MISO, SCK and SS must use one of these combinations of PADs:
+   * | DOPO | MISO | SCK  | SS   |
+   * |------|------|------|------|
+   * | 0x0  | PAD0 | PAD1 | PAD2 |
+   * | 0x1  | PAD2 | PAD3 | PAD1 |
+   * | 0x2  | PAD3 | PAD1 | PAD2 |
+   * | 0x3  | PAD0 | PAD3 | PAD1 |
+   * 
+   * @param[in] sercom_x The following are supported: SERCOM0, SERCOM1, SERCOM2, SERCOM3, SERCOM4, SERCOM5
+   * @param[in] sercom_no Number of the SERCOM: 0 to 5
+   * @param[in] mosi_pin, sck_pin, ss_pin, miso_pin Number of the pin in PORTA (0 to 31) or PORTB (32 to 63)
+   * @param[in] char_size kCharSize8 or kCharSize9
+   * @param[in] profile kFullDuplex, kReceiveOnly or kDmaAssisted
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8
+   * 
+   * @return true if the SPI slave is initialized, false if a pin is not connected to a PAD of the SERCOM or the combination of PADs cannot be routed.
+   * 
+   */
+  bool SercomPadInit(Sercom* sercom_x, uint8_t sercom_no, uint8_t mosi_pin, uint8_t sck_pin, uint8_t ss_pin, uint8_t miso_pin, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator);
+
+  /**
+   * @brief SERCOM registry initialization.
+   * 
+   * This function initializes the SERCOM registries of an SPI slave.
+   * 
+   * @param[in] sercom_x The following are supported: SERCOM0, SERCOM1, SERCOM2, SERCOM3, SERCOM4, SERCOM5
+   * @param[in] sercom_no Number of the SERCOM: 0 to 5
+   * @param[in] char_size kCharSize8 or kCharSize9
+   * @param[in] profile kFullDuplex, kReceiveOnly or kDmaAssisted
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8
+   * @param[in] dipo Data In Pinout: the PAD of MOSI
+   * @param[in] dopo Data Out Pinout: the combination of PADs of MISO, SCK and SS
+   * 
+   * @return void
+   * 
+   */
+  void SercomRegistryInit(Sercom* sercom_x, uint8_t sercom_no, CharSize char_size, InterruptProfile profile, uint8_t irq_priority, uint8_t gclk_generator, uint8_t dipo, uint8_t dopo);
+
+  // Protected variables //
+  uint8_t pins_[4]; // MOSI, SCK, SS and MISO pins, released by end() and connected again by begin()
+
+ private:
+  // Private types //
+  // Owner of the buffer of the ping-pong receive mode that IrqHandler does not write to. Each state is left by one side only, so no lock is needed.
+  enum PingPongState {
+    kPingPongFree = 0x0, // Owned by the library, TransactionEnd may swap to it
+    kPingPongFull = 0x1, // Holds a frame, lendFrame may lend it
+    kPingPongLent = 0x2 // Owned by the application until returnFrame
+  };
+
+  // Private methods //
+  void DmaBlockComplete(); // Called by DmacIrqHandler when a half of the circular buffer is filled.
+  SERCOM_SPI_SLAVE_RAM_CODE int NextTransmitByte(); // Next character of the response or of the transmit buffer, -1 if there is none
+  void SetResponse(const void* buffer, size_t length); // Shared by setResponse() and setResponse16()
+  void TransactionEnd(); // Called by IrqHandler when Slave Select goes high
+  SERCOM_SPI_SLAVE_RAM_CODE void RegisterMapReceive(uint8_t data); // Called by IrqHandler for each character received in register map mode
+  void DmaCrcUpdate(size_t end); // Update the CRC over the DMA circular buffer up to position end
+  void DmaCrcRestart(); // Restart the checksum of the CRC engine of the DMAC
+  void TxDmaRestart(); // Discard the characters loaded into the SERCOM, and restart the DMA transmit path from the first segment
+  void CaptureStart(); // Read the Slave Select low timestamp, and measure the latency
+  void CaptureEnd(); // Read the Slave Select high timestamp into last_timestamps_
+  uint8_t ReceiveInterrupts() const; // SERCOM interrupts of the profile, without Data Register Empty
+  void ArmTransmit(); // Arm the Data Register Empty interrupt, if the profile transmits
+  void Reconfigure(uint32_t ctrla_mask, uint32_t ctrla, uint32_t ctrlb_mask, uint32_t ctrlb); // Rewrite enable-protected fields of CTRLA and CTRLB, without a software reset. The SERCOM is enabled again only if it was enabled.
+  void EnableIrq(); // Enable the SERCOM interrupt at the end of a critical section, unless end() stopped the slave
+  void FlushTransmit(); // Disable and enable the SERCOM to discard the characters left in the data and shift registers
+  void RestartTransmit(); // Load the response or the DMA transmit path again, after the SERCOM was disabled
+  SERCOM_SPI_SLAVE_RAM_CODE void UpdateIsrStats(uint32_t start); // Record the duration of IrqHandler, started at SysTick value start
+  void CountDmaReceived(size_t position); // Count the characters the DMAC wrote up to position
+
+  // Private variables //
+  static SercomSPISlave* dmac_channel_owner_[DMAC_CH_NUM]; // Slave instance using each DMAC channel, NULL if unused
+  static SercomSPISlave* dmac_crc_owner_; // Slave instance using the CRC engine of the DMAC, NULL if unused
+  static SercomSPISlave* timestamp_owner_; // Slave instance using TC4 for timestamps, NULL if unused
+  static SercomSPISlave* instances_[SERCOM_INST_NUM]; // Slave instance initialized on each SERCOM, NULL if unused
+  Sercom* sercom_; // SERCOM used, NULL before SercomInit()
+  uint8_t sercom_no_; // Number of the SERCOM used: 0 to 5
+  uint8_t char_bytes_; // Bytes per character in the buffers: 1 in 8-bit mode, 2 in 9-bit mode
+  InterruptProfile profile_; // Interrupt profile selected by SercomInit()
+  int8_t dma_channel_; // DMAC channel of the DMA receive path, -1 if disabled
+  volatile uint8_t* dma_buffer_; // Circular buffer of the DMA receive path
+  size_t dma_length_; // Length of the circular buffer
+  DmaCallback dma_callback_; // Callback of the DMA receive path
+  volatile bool dma_second_half_; // true while the DMAC writes to the second half of the circular buffer
+  SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_RX_BUFFER_SIZE> rx_buffer_; // Receive buffer, filled by IrqHandler()
+  SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_TX_BUFFER_SIZE> tx_buffer_; // Transmit buffer, emptied by IrqHandler()
+  const void* volatile response_; // Response transmitted at the start of every transaction, NULL if not set
+  volatile uint16_t response_length_; // Number of characters of the response
+  volatile uint16_t response_index_; // Number of characters of the response loaded into the data register in the current transaction
+  volatile bool response_flush_; // The response was replaced during a transaction, so TransactionEnd() discards the characters preloaded from the previous one
+  volatile uint16_t transaction_length_; // Number of characters received in the current transaction
+  SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE, uint16_t> frame_lengths_; // Length of each complete frame in the receive buffer
+  SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE, uint32_t> frame_crcs_; // CRC computed for each complete frame
+  SercomSPISlaveRingBuffer<SERCOM_SPI_SLAVE_FRAME_QUEUE_SIZE> frame_crc_valid_; // 1 for each complete frame of which the CRC matches, 0 otherwise
+  FrameCallback frame_callback_; // Called at the end of each frame
+  volatile bool framing_; // true while framing is enabled
+  volatile uint16_t frame_length_; // Number of characters of the current transaction stored in the receive buffer
+  uint8_t* ping_pong_buffers_[2]; // Buffers of the ping-pong receive mode, NULL if it is disabled
+  uint16_t ping_pong_size_; // Size of each buffer in bytes
+  volatile uint8_t ping_pong_active_; // Index of the buffer IrqHandler writes to. Changed by TransactionEnd only while the other buffer is kPingPongFree.
+  volatile uint16_t ping_pong_index_; // Number of bytes written to the active buffer in the current transaction
+  volatile uint8_t ping_pong_state_; // PingPongState of the other buffer
+  volatile uint16_t ping_pong_length_; // Number of bytes of the frame in the other buffer
+  SercomSPISlaveFramePool* volatile frame_pool_; // Pool the frames are received into, NULL if disabled
+  volatile int16_t pool_slot_; // Slot claimed for the current transaction, -1 if none
+  volatile uint16_t pool_length_; // Number of bytes written to the slot in the current transaction
+  Stats stats_; // Runtime statistics, isr_avg_cycles is computed by getStats()
+  uint64_t isr_cycles_; // Total duration of IrqHandler() in CPU cycles
+  size_t dma_counted_position_; // Position in the DMA circular buffer up to which the received characters are counted
+  ErrorCallback error_callback_; // Called on each buffer overflow
+  volatile bool resync_; // true from a buffer overflow until Slave Select goes high: the received characters are discarded
+  volatile bool transaction_active_; // true from the first interrupt of a transaction until Slave Select goes high
+  volatile bool transaction_ended_; // true when a transaction ended since the last return of standby()
+  bool ended_; // true from end() until begin() or SercomInit(): the SERCOM, its interrupt and its pins are disabled
+  volatile uint8_t* volatile register_map_; // Memory of the registers, NULL if the register map is disabled
+  uint8_t register_size_; // Number of registers
+  const uint8_t* register_write_mask_; // Writable bits of each register, NULL if all are read-only
+  RegisterWriteCallback register_callback_; // Called at the end of each transaction that wrote registers
+  uint8_t register_address_; // Address of the next register written in the current transaction
+  uint8_t register_first_; // Address of the first register written in the current transaction
+  bool register_write_; // true if the current transaction writes registers
+  const SercomSPISlaveCrc* volatile crc_; // CRC checked on each transaction, NULL if disabled
+  uint32_t rx_crc_; // CRC register of the current transaction
+  uint32_t crc_history_[8]; // CRC register before each of the last characters, indexed by the position of the character in the transaction
+  uint32_t crc_tail_; // Last four characters of the current transaction, the last in the least significant byte
+  size_t dma_crc_position_; // Position in the DMA circular buffer up to which the CRC is updated
+  size_t dma_transaction_length_; // Number of characters the DMAC wrote in the current transaction
+  uint32_t last_crc_; // CRC of the last complete transaction
+  volatile bool last_crc_valid_; // true if the CRC of the last complete transaction matches
+  DmaCrc dma_crc_; // Polynomial of the CRC engine of the DMAC, if dmac_crc_owner_ is this slave
+  uint8_t timestamp_extint_; // External interrupt line of the capture pin, if timestamp_owner_ is this slave
+  uint8_t timestamp_evsys_channel_; // Event System channel of the timestamps, if timestamp_owner_ is this slave
+  TimestampStorage* volatile timestamp_storage_; // Memory of the timestamps, if timestamp_owner_ is this slave, NULL otherwise
+  uint16_t latency_bin_ticks_; // Width of the bins of TimestampStorage::latency_histogram
+  uint32_t timestamp_start_; // Slave Select low timestamp of the current transaction
+  bool timestamp_start_valid_; // true if timestamp_start_ was captured in the current transaction
+  Timestamps last_timestamps_; // Timestamps of the last complete transaction
+  Timestamps frame_timestamps_read_; // Timestamps of the frame returned by the last call of readFrame()
+  int8_t tx_dma_channel_; // DMAC channel of the DMA transmit path, -1 if disabled
+  uint8_t tx_segment_count_; // Number of descriptors of the response of the DMA transmit path
+};
+
+// The pin enums of Sercom0SPISlave to Sercom5SPISlave are unscoped, such that a pin can be named as Sercom1SPISlave::PA16, as well as through Pins or MOSI_Pins to MISO_Pins.
+class Sercom0SPISlave : public SercomSPISlave {
  public:
   // Types //
-  enum MOSI_Pins {PA04, PA08};
-  enum SCK_Pins {PA05, PA09};
-  enum SS_Pins {PA06, PA10};
-  enum MISO_Pins {PA07, PA11};
+  enum Pins : uint8_t {PA04 = 4, PA05 = 5, PA06 = 6, PA07 = 7, PA08 = 8, PA09 = 9, PA10 = 10, PA11 = 11}; // Pins connected to a PAD of SERCOM0. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom0SPISlave();
@@ -41,25 +1439,31 @@ class Sercom0SPISlave {
    * 
    * This function initializes an SPI slave using SERCOM0. It defines the pins used and sets the SERCOM registries.
    * A combination of pins highlighted in the readme is: PA08, PA09, PA10, PA11
+   * Any pin of SERCOM0 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
+   * 
+   * @param[in] MOSI_Pin PA04, PA05, PA06, PA07, PA08, PA09, PA10, PA11
+   * @param[in] SCK_Pin PA04, PA05, PA06, PA07, PA08, PA09, PA10, PA11
+   * @param[in] SS_Pin PA04, PA05, PA06, PA07, PA08, PA09, PA10, PA11
+   * @param[in] MISO_Pin PA04, PA05, PA06, PA07, PA08, PA09, PA10, PA11
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
    * 
-   * @param[in] MOSI_Pin PA04, PA08
-   * @param[in] SCK_Pin PA05, PA09
-   * @param[in] SS_Pin PA06, PA10
-   * @param[in] MISO_Pin PA07, PA11
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
-
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class Sercom1SPISlave {
+class Sercom1SPISlave : public SercomSPISlave {
  public:
-
   // Types //
-  enum MOSI_Pins {PA00, PA16};
-  enum SCK_Pins {PA01, PA17};
-  enum SS_Pins {PA18, PA30};
-  enum MISO_Pins {PA19, PA31};
+  enum Pins : uint8_t {PA00 = 0, PA01 = 1, PA16 = 16, PA17 = 17, PA18 = 18, PA19 = 19, PA30 = 30, PA31 = 31}; // Pins connected to a PAD of SERCOM1. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom1SPISlave();
@@ -70,24 +1474,31 @@ class Sercom1SPISlave {
    * 
    * This function initializes an SPI slave using SERCOM1. It defines the pins used and sets the SERCOM registries.
    * A combination of pins highlighted in the readme is: PA16, PA17, PA18, PA19
+   * Any pin of SERCOM1 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
    * 
-   * @param[in] MOSI_Pin PA00, PA16
-   * @param[in] SCK_Pin PA01, PA17
-   * @param[in] SS_Pin PA18, PA30
-   * @param[in] MISO_Pin PA19, PA31
+   * @param[in] MOSI_Pin PA00, PA01, PA16, PA17, PA18, PA19, PA30, PA31
+   * @param[in] SCK_Pin PA00, PA01, PA16, PA17, PA18, PA19, PA30, PA31
+   * @param[in] SS_Pin PA00, PA01, PA16, PA17, PA18, PA19, PA30, PA31
+   * @param[in] MISO_Pin PA00, PA01, PA16, PA17, PA18, PA19, PA30, PA31
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
+   * 
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class Sercom2SPISlave {
+class Sercom2SPISlave : public SercomSPISlave {
  public:
-
   // Types //
-  enum MOSI_Pins {PA08, PA12};
-  enum SCK_Pins {PA09, PA13};
-  enum SS_Pins {PA10, PA14};
-  enum MISO_Pins {PA11, PA15};
+  enum Pins : uint8_t {PA08 = 8, PA09 = 9, PA10 = 10, PA11 = 11, PA12 = 12, PA13 = 13, PA14 = 14, PA15 = 15}; // Pins connected to a PAD of SERCOM2. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom2SPISlave();
@@ -97,24 +1508,31 @@ class Sercom2SPISlave {
    * @brief SPI slave initialization using SERCOM2
    * 
    * This function initializes an SPI slave using SERCOM2. It defines the pins used and sets the SERCOM registries.
+   * Any pin of SERCOM2 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
    * 
-   * @param[in] MOSI_Pin PA08, PA12
-   * @param[in] SCK_Pin PA09, PA13
-   * @param[in] SS_Pin PA10, PA14
-   * @param[in] MISO_Pin PA11, PA15
+   * @param[in] MOSI_Pin PA08, PA09, PA10, PA11, PA12, PA13, PA14, PA15
+   * @param[in] SCK_Pin PA08, PA09, PA10, PA11, PA12, PA13, PA14, PA15
+   * @param[in] SS_Pin PA08, PA09, PA10, PA11, PA12, PA13, PA14, PA15
+   * @param[in] MISO_Pin PA08, PA09, PA10, PA11, PA12, PA13, PA14, PA15
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
+   * 
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class Sercom3SPISlave {
+class Sercom3SPISlave : public SercomSPISlave {
  public:
-
   // Types //
-  enum MOSI_Pins {PA16, PA22};
-  enum SCK_Pins {PA17, PA23};
-  enum SS_Pins {PA18, PA20, PA24};
-  enum MISO_Pins {PA19, PA21, PA25};
+  enum Pins : uint8_t {PA16 = 16, PA17 = 17, PA18 = 18, PA19 = 19, PA20 = 20, PA21 = 21, PA22 = 22, PA23 = 23, PA24 = 24, PA25 = 25}; // Pins connected to a PAD of SERCOM3. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom3SPISlave();
@@ -124,23 +1542,31 @@ class Sercom3SPISlave {
    * @brief SPI slave initialization using SERCOM3
    * 
    * This function initializes an SPI slave using SERCOM3. It defines the pins used and sets the SERCOM registries.
+   * Any pin of SERCOM3 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
+   * 
+   * @param[in] MOSI_Pin PA16, PA17, PA18, PA19, PA20, PA21, PA22, PA23, PA24, PA25
+   * @param[in] SCK_Pin PA16, PA17, PA18, PA19, PA20, PA21, PA22, PA23, PA24, PA25
+   * @param[in] SS_Pin PA16, PA17, PA18, PA19, PA20, PA21, PA22, PA23, PA24, PA25
+   * @param[in] MISO_Pin PA16, PA17, PA18, PA19, PA20, PA21, PA22, PA23, PA24, PA25
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
+   * 
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
-   * @param[in] MOSI_Pin PA16, PA22
-   * @param[in] SCK_Pin PA17, PA23
-   * @param[in] SS_Pin PA18, PA20, PA24
-   * @param[in] MISO_Pin PA19, PA21, PA25
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class Sercom4SPISlave {
+class Sercom4SPISlave : public SercomSPISlave {
  public:
-
   // Types //
-  enum MOSI_Pins {PA12, PB08, PB12};
-  enum SCK_Pins {PA13, PB09, PB13};
-  enum SS_Pins {PA14, PB10, PB14};
-  enum MISO_Pins {PA15, PB11, PB15};
+  enum Pins : uint8_t {PA12 = 12, PA13 = 13, PA14 = 14, PA15 = 15, PB08 = 40, PB09 = 41, PB10 = 42, PB11 = 43, PB12 = 44, PB13 = 45, PB14 = 46, PB15 = 47}; // Pins connected to a PAD of SERCOM4. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom4SPISlave();
@@ -151,24 +1577,31 @@ class Sercom4SPISlave {
    * 
    * This function initializes an SPI slave using SERCOM4. It defines the pins used and sets the SERCOM registries.
    * A combination of pins highlighted in the readme is: PA12, PB09, PB10, PB11
+   * Any pin of SERCOM4 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
+   * 
+   * @param[in] MOSI_Pin PA12, PA13, PA14, PA15, PB08, PB09, PB10, PB11, PB12, PB13, PB14, PB15
+   * @param[in] SCK_Pin PA12, PA13, PA14, PA15, PB08, PB09, PB10, PB11, PB12, PB13, PB14, PB15
+   * @param[in] SS_Pin PA12, PA13, PA14, PA15, PB08, PB09, PB10, PB11, PB12, PB13, PB14, PB15
+   * @param[in] MISO_Pin PA12, PA13, PA14, PA15, PB08, PB09, PB10, PB11, PB12, PB13, PB14, PB15
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
    * 
-   * @param[in] MOSI_Pin PA12, PB08, PB12
-   * @param[in] SCK_Pin PA13, PB09, PB13
-   * @param[in] SS_Pin PA14, PB10, PB14
-   * @param[in] MISO_Pin PA15, PB11, PB15
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class Sercom5SPISlave {
+class Sercom5SPISlave : public SercomSPISlave {
  public:
-
   // Types //
-  enum MOSI_Pins {PB02, PB16, PB30};
-  enum SCK_Pins {PB03, PB17, PB31};
-  enum SS_Pins {PA20, PA24, PB00, PB22};
-  enum MISO_Pins {PA21, PA25, PB01, PB23};
+  enum Pins : uint8_t {PA20 = 20, PA21 = 21, PA22 = 22, PA23 = 23, PA24 = 24, PA25 = 25, PB00 = 32, PB01 = 33, PB02 = 34, PB03 = 35, PB16 = 48, PB17 = 49, PB22 = 54, PB23 = 55, PB30 = 62, PB31 = 63}; // Pins connected to a PAD of SERCOM5. The value is the number of the pin in PORTA (0 to 31) or PORTB (32 to 63).
+  typedef Pins MOSI_Pins;
+  typedef Pins SCK_Pins;
+  typedef Pins SS_Pins;
+  typedef Pins MISO_Pins;
 
   // Constructors //
   Sercom5SPISlave();
@@ -178,41 +1611,104 @@ class Sercom5SPISlave {
    * @brief SPI slave initialization using SERCOM5
    * 
    * This function initializes an SPI slave using SERCOM5. It defines the pins used and sets the SERCOM registries.
+   * Any pin of SERCOM5 can be used for any SPI function, as long as the PADs of the pins form a combination the SERCOM can route, see SercomPadInit().
+   * 
+   * @param[in] MOSI_Pin PA20, PA21, PA22, PA23, PA24, PA25, PB00, PB01, PB02, PB03, PB16, PB17, PB22, PB23, PB30, PB31
+   * @param[in] SCK_Pin PA20, PA21, PA22, PA23, PA24, PA25, PB00, PB01, PB02, PB03, PB16, PB17, PB22, PB23, PB30, PB31
+   * @param[in] SS_Pin PA20, PA21, PA22, PA23, PA24, PA25, PB00, PB01, PB02, PB03, PB16, PB17, PB22, PB23, PB30, PB31
+   * @param[in] MISO_Pin PA20, PA21, PA22, PA23, PA24, PA25, PB00, PB01, PB02, PB03, PB16, PB17, PB22, PB23, PB30, PB31
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
    * 
-   * @param[in] MOSI_Pin PB02, PB16, PB30
-   * @param[in] SCK_Pin PB03, PB17, PB31
-   * @param[in] SS_Pin PA20, PA24, PB00, PB22
-   * @param[in] MISO_Pin PA21, PA25, PB01, PB23
+   * @return true if the SPI slave is initialized, false if the SERCOM cannot route the combination of pins, or irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin);
+  bool SercomInit(MOSI_Pins MOSI_Pin, SCK_Pins SCK_Pin, SS_Pins SS_Pin, MISO_Pins MISO_Pin, CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0);
 };
 
-class SercomSPISlave {
- private:
-  // Types //
-  friend class Sercom0SPISlave; // Sercom0SPISlave has full access to SercomSPISlave
-  friend class Sercom1SPISlave;
-  friend class Sercom2SPISlave;
-  friend class Sercom3SPISlave;
-  friend class Sercom4SPISlave;
-  friend class Sercom5SPISlave;
+/**
+ * @brief SPI slave with the SERCOM and the pins selected at compile time.
+ * 
+ * The pins are checked with static_assert, such that a pin not connected to the SERCOM or a combination of PADs the SERCOM cannot route does not compile.
+ * The PADs, the PMUX values and the DIPO and DOPO are resolved during compilation, so the pins are connected with constant register writes. The SERCOM, its clock and its interrupt are set up by the same code as for SercomSPISlave.
+ * Example: SercomSPISlaveT<1, SercomPin::PA16, SercomPin::PA17, SercomPin::PA18, SercomPin::PA19> SPISlave;
+ * 
+ * To skip the dispatch through the instance table, define SERCOM_SPI_SLAVE_NO_SERCOMn_HANDLER in the build flags and call IrqHandler() of the slave from SERCOMn_Handler() in the sketch.
+ * 
+ * @tparam kSercomNo Number of the SERCOM: 0 to 5
+ * @tparam kMosi, kSck, kSs, kMiso Pins connected to a PAD of the SERCOM
+ */
+template <uint8_t kSercomNo, SercomPin kMosi, SercomPin kSck, SercomPin kSs, SercomPin kMiso>
+class SercomSPISlaveT : public SercomSPISlave {
+ public:
+  // Constants //
+  static constexpr int kMosiPad = SercomSPISlavePinMux::Pad(kSercomNo, (uint8_t)kMosi);
+  static constexpr int kSckPad = SercomSPISlavePinMux::Pad(kSercomNo, (uint8_t)kSck);
+  static constexpr int kSsPad = SercomSPISlavePinMux::Pad(kSercomNo, (uint8_t)kSs);
+  static constexpr int kMisoPad = SercomSPISlavePinMux::Pad(kSercomNo, (uint8_t)kMiso);
+  static constexpr int kDipo = SercomSPISlavePinMux::Dipo(kMosiPad, kSckPad, kSsPad, kMisoPad);
+  static constexpr int kDopo = SercomSPISlavePinMux::Dopo(kMisoPad, kSckPad, kSsPad);
 
-  // Constructors //
-  SercomSPISlave();
+  static_assert(kSercomNo < SERCOM_INST_NUM, "This SERCOM is not available on this device.");
+  static_assert(kMosiPad >= 0, "The MOSI pin is not connected to a PAD of this SERCOM.");
+  static_assert(kSckPad >= 0, "The SCK pin is not connected to a PAD of this SERCOM.");
+  static_assert(kSsPad >= 0, "The SS pin is not connected to a PAD of this SERCOM.");
+  static_assert(kMisoPad >= 0, "The MISO pin is not connected to a PAD of this SERCOM.");
+  static_assert(kDopo >= 0, "The SERCOM cannot route MISO, SCK and SS to these PADs, see the DOPO table in the readme.");
+  static_assert(kDipo >= 0, "MOSI must use the PAD that is not used by MISO, SCK and SS.");
 
-  // Private methods //
+  // Public methods //
   /**
-   * @brief SERCOM registry initialization.
+   * @brief SPI slave initialization using the SERCOM and the pins of the template parameters
    * 
-   * This function initializes the SERCOM registries of an SPI slave.
-   * 
-   * @param[in] sercom_x The following are supported: SERCOM0, SERCOM1, SERCOM2, SERCOM3, SERCOM4, SERCOM5
+   * @param[in] char_size kCharSize8 (default) or kCharSize9
+   * @param[in] profile kFullDuplex (default), kReceiveOnly or kDmaAssisted, see InterruptProfile
+   * @param[in] irq_priority Priority of the SERCOM interrupt in the NVIC: 0 (highest) to 3. Default 2. The USB interrupt of the Arduino core has priority 0.
+   * @param[in] gclk_generator Generic Clock Generator clocking the SERCOM: 0 to 8. Default 0, which runs at the CPU clock in the Arduino core.
    * 
-   * @return void
+   * @return true if the SPI slave is initialized, false if irq_priority or gclk_generator is out of range.
    * 
    */
-  void SercomRegistryInit(Sercom* sercom_x);
+  bool SercomInit(CharSize char_size = kCharSize8, InterruptProfile profile = kFullDuplex, uint8_t irq_priority = 2, uint8_t gclk_generator = 0) {
+    if ((irq_priority > 3) || (gclk_generator >= GCLK_GEN_NUM)) {
+      return false;
+    }
+    PinInit<kMosi>();
+    PinInit<kSck>();
+    PinInit<kSs>();
+    PinInit<kMiso>();
+    pins_[0] = (uint8_t)kMosi;
+    pins_[1] = (uint8_t)kSck;
+    pins_[2] = (uint8_t)kSs;
+    pins_[3] = (uint8_t)kMiso;
+    SercomRegistryInit(SercomX(), kSercomNo, char_size, profile, irq_priority, gclk_generator, kDipo, kDopo);
+    return true;
+  }
+
+ private:
+  // Private methods //
+  template <SercomPin kPin>
+  static void PinInit() { // Connect a pin to its PAD, see the explanation of SercomPinMux
+    PORT->Group[(uint8_t)kPin / 32].PINCFG[(uint8_t)kPin % 32].bit.PMUXEN = 0x1; // Enable Peripheral Multiplexing
+    if ((uint8_t)kPin % 2 == 0) {
+      PORT->Group[(uint8_t)kPin / 32].PMUX[((uint8_t)kPin % 32) / 2].bit.PMUXE = SercomSPISlavePinMux::Function(kSercomNo, (uint8_t)kPin); // even pin
+    } else {
+      PORT->Group[(uint8_t)kPin / 32].PMUX[((uint8_t)kPin % 32) / 2].bit.PMUXO = SercomSPISlavePinMux::Function(kSercomNo, (uint8_t)kPin); // odd pin
+    }
+  }
+
+  static Sercom* SercomX() { // Folded to a constant, as kSercomNo is known at compile time
+    switch (kSercomNo) {
+      case 0: return SERCOM0;
+      case 1: return SERCOM1;
+      case 2: return SERCOM2;
+      case 3: return SERCOM3;
+      case 4: return SERCOM4;
+      default: return SERCOM5;
+    }
+  }
 };
 
 #endif